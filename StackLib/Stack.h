@@ -21,15 +21,17 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <time.h>
+#include <atomic>
 #include <new>
-
-#ifdef HASH_PROTECT
+#include <type_traits>
+#include <utility>
 #include "hash.h"
-#endif // HASH_PROTECT
 
 
-#define STACK_CHECK if (Check ())                                                                                      \
+#define STACK_CHECK if constexpr (POLICY::CHECK)                                                                       \
+                    if (Check ())                                                                                      \
                     {                                                                                                  \
                       FILE* log = fopen(STACK_LOGNAME, "a");                                                           \
                       assert (log != nullptr);                                                                         \
@@ -41,6 +43,9 @@
                     } //
 
 
+#define DUMP_PRINT if constexpr (POLICY::DUMP)
+
+
 #define STACK_ASSERTOK(cond, err) if (cond)                                                              \
                                   {                                                                      \
                                     printError (STACK_LOGNAME , __FILE__, __LINE__, __FUNC_NAME__, err); \
@@ -48,7 +53,7 @@
                                   } //
 
 const size_t DEFAULT_STACK_CAPACITY = 8;
-static int   stack_id   = 0;
+static std::atomic<int> stack_id (0);
 
 #define newStack_size(NAME, capacity, STK_TYPE) \
         Stack<STK_TYPE> NAME ((char*)#NAME, capacity);
@@ -57,24 +62,65 @@ static int   stack_id   = 0;
         Stack<STK_TYPE> NAME ((char*)#NAME);
 
 
+//------------------------------------------------------------------------------
+/*! @brief   Place for the first values of the stack inside the stack object.
+ */
+
+template <typename TYPE, size_t INLINE>
+struct StackBuffer
+{
+    uint64_t front_ = STACK_CANARY;
+    TYPE     data_[INLINE];
+    uint64_t back_  = STACK_CANARY;
+
+    TYPE*       getData ()                 { return data_; }
+    const TYPE* getData () const           { return data_; }
+    bool        isAlive () const           { return (front_ == STACK_CANARY) && (back_ == STACK_CANARY); }
+    void        Swap    (StackBuffer& obj) { std::swap(data_, obj.data_); }
+};
+
 template <typename TYPE>
+struct StackBuffer<TYPE, 0>
+{
+    TYPE*       getData ()                 { return nullptr; }
+    const TYPE* getData () const           { return nullptr; }
+    bool        isAlive () const           { return 1; }
+    void        Swap    (StackBuffer& obj) { }
+};
+
+//------------------------------------------------------------------------------
+/*! @brief   Stack of values, the first INLINE values are kept inside the
+ *           object, the heap is used only for deeper stacks. POLICY decides
+ *           which checks the stack runs (see StackConfig.h).
+ */
+
+template <typename TYPE, size_t INLINE = 0, typename POLICY = StackHashed>
 class Stack
 {
 private:
 
+    uint64_t canary1_ = STACK_CANARY;
+
     char*   name_     = nullptr;
     size_t  capacity_ = 0;
     size_t  size_cur_ = 0;
+    size_t  top_      = 0;
 
     TYPE* data_ = nullptr;
 
     int id_ = 0;
     int errCode_;
 
-#ifdef HASH_PROTECT
     hash_t stackhash_ = 0;
     hash_t datahash_  = 0;
-#endif // HASH_PROTECT
+    size_t unchecked_ = 0;
+
+    StackBuffer<TYPE, INLINE> inline_;
+
+    uint64_t canary2_ = STACK_CANARY;
+
+    // heap data of trivially copyable types starts after the front canary
+    static constexpr size_t CANARY_SPACE = (alignof(TYPE) > sizeof(STACK_CANARY)) ? alignof(TYPE) : sizeof(STACK_CANARY);
 
 public:
 
@@ -88,7 +134,7 @@ public:
 /*! @brief   Stack constructor.
  *
  *  @param   stack_name  Stack variable name
- *  @param   capacity    Capacity of the stack
+ *  @param   capacity    Capacity of the stack (at least INLINE)
  */
 
     Stack (char* stack_name, size_t capacity = DEFAULT_STACK_CAPACITY);
@@ -103,6 +149,24 @@ public:
 
     Stack& operator = (const Stack& obj);
 
+//------------------------------------------------------------------------------
+/*! @brief   Stack move constructor, the data is taken without copying.
+ *
+ *  @param   obj         Source stack, left not constructed
+ */
+
+    Stack (Stack&& obj) noexcept;
+
+    Stack& operator = (Stack&& obj) noexcept;
+
+//------------------------------------------------------------------------------
+/*! @brief   Exchange contents of two stacks.
+ *
+ *  @param   obj         Other stack
+ */
+
+    void Swap (Stack& obj) noexcept;
+
 //------------------------------------------------------------------------------
 /*! @brief   Stack destructor.
  */
@@ -127,6 +191,47 @@ public:
 
     TYPE Pop ();
 
+//------------------------------------------------------------------------------
+/*! @brief   Pushing several values onto the stack, the memory is taken once.
+ *
+ *  @param   values      Values to push, values[n - 1] ends up on the top
+ *  @param   n           Number of values
+ *
+ *  @return  error code
+ */
+
+    int PushN (const TYPE* values, size_t n);
+
+//------------------------------------------------------------------------------
+/*! @brief   Popping several values from the stack.
+ *
+ *  @param   values      Place for the values in the order they were pushed
+ *                       (the top is values[n - 1]), may be nullptr
+ *  @param   n           Number of values
+ *
+ *  @return  error code, nothing is popped if the stack has less values
+ */
+
+    int PopN (TYPE* values, size_t n);
+
+//------------------------------------------------------------------------------
+/*! @brief   Take memory for the size of the stack data in advance.
+ *
+ *  @param   size        Number of values the stack takes without reallocation
+ *
+ *  @return  error code
+ */
+
+    int Reserve (size_t size);
+
+//------------------------------------------------------------------------------
+/*! @brief   Give back the memory not used by the stack data.
+ *
+ *  @return  error code
+ */
+
+    int ShrinkToFit ();
+
 //------------------------------------------------------------------------------
 /*! @brief   Get size of the stack data.
  *
@@ -135,6 +240,26 @@ public:
 
     size_t getSize () const;
 
+//------------------------------------------------------------------------------
+/*! @brief   Get capacity of the stack.
+ *
+ *  @return  number of values the stack holds without reallocation
+ */
+
+    size_t getCapacity () const;
+
+//------------------------------------------------------------------------------
+/*! @brief   Get the stack data, the bottom value goes first.
+ *
+ *  @return  pointer to getSize() values, valid until the stack grows
+ *
+ *  @note    With StackHashed writes through the pointer break the hash.
+ */
+
+    TYPE* getData ();
+
+    const TYPE* getData () const;
+
 //------------------------------------------------------------------------------
 /*! @brief   Get name of the stack.
  *
@@ -151,12 +276,22 @@ public:
 
     void setName (char* name);
 
+//------------------------------------------------------------------------------
+/*! @brief   Put the value to the place of the stack, unlike writes through
+ *           operator [] the hashes are kept.
+ *
+ *  @param   n           Index of the value, less than the stack size
+ *  @param   value       Value
+ */
+
+    void Set (size_t n, const TYPE& value);
+
     TYPE& operator [] (size_t n);
 
     const TYPE& operator [] (size_t n) const;
 
 //------------------------------------------------------------------------------
-/*! @brief   Clean stack.
+/*! @brief   Clean stack, the memory is kept (see ShrinkToFit).
  */
 
     void Clean ();
@@ -185,15 +320,106 @@ private:
     void fillPoison ();
 
 //------------------------------------------------------------------------------
-/*! @brief   Increase the stack by 2 times.
+/*! @brief   Put the value to the slot of the stack, the slots above the last
+ *           one filled are not initialized (poisoned lazily).
+ *
+ *  @param   n           Index of the slot, at most one above the filled ones
+ *  @param   value       Value
+ */
+
+    void Place (size_t n, const TYPE& value);
+
+//------------------------------------------------------------------------------
+/*! @brief   Increase the stack at least by 2 times.
+ *
+ *  @param   capacity    Least new capacity
  *
  *  @return  error code
  */
 
-    int Expand ();
+    int Expand (size_t capacity);
 
 //------------------------------------------------------------------------------
-/*! @brief   Check stack for problems and hash (if enabled).
+/*! @brief   Change capacity of the stack, the data is kept (realloc'ed for
+ *           trivially copyable types, moved for others).
+ *
+ *  @param   capacity    New capacity, bigger than the stack size
+ *
+ *  @return  error code
+ */
+
+    int Reallocate (size_t capacity);
+
+//------------------------------------------------------------------------------
+/*! @brief   Get memory for the stack data, the inline buffer if it is enough.
+ *
+ *  @param   capacity    Number of values, INLINE is used if it is less
+ *
+ *  @return  pointer to the memory, nullptr if no memory
+ */
+
+    TYPE* Take (size_t capacity);
+
+//------------------------------------------------------------------------------
+/*! @brief   Give back memory of the stack data if it is not inline.
+ */
+
+    void Drop ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Allocate memory for the stack data.
+ *
+ *  @param   capacity    Number of values
+ *
+ *  @return  pointer to the memory, nullptr if no memory
+ */
+
+    static TYPE* Allocate (size_t capacity);
+
+//------------------------------------------------------------------------------
+/*! @brief   Release memory of the stack data.
+ *
+ *  @param   data        Pointer to the memory from Allocate
+ */
+
+    static void Release (TYPE* data);
+
+//------------------------------------------------------------------------------
+/*! @brief   Change size of memory from Allocate, the data is kept.
+ *
+ *  @param   data        Pointer to the memory from Allocate
+ *  @param   capacity    New number of values
+ *
+ *  @return  pointer to the memory, nullptr if no memory (data is kept)
+ */
+
+    static TYPE* Resize (TYPE* data, size_t capacity);
+
+//------------------------------------------------------------------------------
+/*! @brief   Get the largest capacity of the stack.
+ *
+ *  @return  MAX_CAPACITY or less if the data would not fit in memory
+ */
+
+    static constexpr size_t maxCapacity ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Put canaries around the heap data (trivially copyable types with
+ *           StackCanary and stronger policies).
+ */
+
+    void SetCanaries ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Check canaries of the stack fields and the data.
+ *
+ *  @return  1 if all canaries are alive, else 0
+ */
+
+    bool CanariesAlive () const;
+
+//------------------------------------------------------------------------------
+/*! @brief   Check stack for problems, canaries and hashes (if the policy has them).
  *
  *  @return  error code
  */
@@ -210,17 +436,45 @@ private:
 
     void ErrorPrint (FILE * fp);
 
+//------------------------------------------------------------------------------
+/*! @brief   Update the hash of the stack fields (if the policy has it).
+ */
+
+    void Rehash ();
+
 //------------------------------------------------------------------------------
 /*! @brief   Calculates the size of the structure stack without hash and second canary.
  *
  *  @return  stack size for hash
  */
 
-#ifdef HASH_PROTECT
-
     size_t SizeForHash ();
 
-#endif // HASH_PROTECT
+//------------------------------------------------------------------------------
+/*! @brief   Hash of the stack element.
+ *
+ *  @param   n           Index of the element
+ *
+ *  @return  hash of the element at its position
+ */
+
+    hash_t SlotHash (size_t n) const;
+
+//------------------------------------------------------------------------------
+/*! @brief   Compute the data hash from all elements of the stack.
+ *
+ *  @return  data hash
+ */
+
+    hash_t DataHash () const;
+
+//------------------------------------------------------------------------------
+/*! @brief   Decide if the data hash is checked now.
+ *
+ *  @return  1 once per capacity calls (every call with POLICY::STRICT), else 0
+ */
+
+    bool DataCheckDue ();
 
 //------------------------------------------------------------------------------
 };
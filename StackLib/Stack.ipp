@@ -8,13 +8,13 @@
     * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
     *///------------------------------------------------------------------------
 
-template <typename TYPE>
-Stack<TYPE>::Stack () : errCode_ (STACK_NOT_CONSTRUCTED) { }
+template <typename TYPE, size_t INLINE, typename POLICY>
+Stack<TYPE, INLINE, POLICY>::Stack () : errCode_ (STACK_NOT_CONSTRUCTED) { }
 
 //------------------------------------------------------------------------------
 
-template <typename TYPE>
-Stack<TYPE>::Stack (char* stack_name, size_t capacity) :
+template <typename TYPE, size_t INLINE, typename POLICY>
+Stack<TYPE, INLINE, POLICY>::Stack (char* stack_name, size_t capacity) :
     data_     (),
     size_cur_ (0),
     capacity_ (capacity),
@@ -22,18 +22,22 @@ Stack<TYPE>::Stack (char* stack_name, size_t capacity) :
     id_       (stack_id++),
     errCode_  (STACK_OK)
 {
-    STACK_ASSERTOK((capacity > MAX_CAPACITY),   STACK_WRONG_INPUT_CAPACITY_VALUE_BIG);
+    STACK_ASSERTOK((capacity > maxCapacity()),  STACK_WRONG_INPUT_CAPACITY_VALUE_BIG);
     STACK_ASSERTOK((capacity == 0),             STACK_WRONG_INPUT_CAPACITY_VALUE_NIL);
     STACK_ASSERTOK((stack_name == nullptr),     STACK_WRONG_INPUT_STACK_NAME);
     
-    data_ = new TYPE[capacity_];
+    if (capacity_ < INLINE) capacity_ = INLINE;
 
-    fillPoison();
+    data_ = Take(capacity_);
+    STACK_ASSERTOK((data_ == nullptr),          STACK_NO_MEMORY);
 
-#ifdef HASH_PROTECT
-    datahash_  = hash(data_, capacity_ * sizeof(TYPE));
-    stackhash_ = hash(this, SizeForHash());
-#endif // HASH_PROTECT
+    top_ = 1;
+    data_[0] = POISON<TYPE>;
+
+    SetCanaries();
+
+    if constexpr (POLICY::HASH) datahash_ = DataHash();
+    Rehash();
 
     STACK_CHECK;
 
@@ -42,24 +46,26 @@ Stack<TYPE>::Stack (char* stack_name, size_t capacity) :
 
 //------------------------------------------------------------------------------
 
-template <typename TYPE>
-Stack<TYPE>::Stack (const Stack& obj) :
+template <typename TYPE, size_t INLINE, typename POLICY>
+Stack<TYPE, INLINE, POLICY>::Stack (const Stack& obj) :
     size_cur_ (obj.size_cur_),
     capacity_ (obj.capacity_),
+    top_      (obj.top_),
     id_       (stack_id++),
     errCode_  (STACK_OK)
 {
-    STACK_ASSERTOK((capacity_ > MAX_CAPACITY),  STACK_WRONG_INPUT_CAPACITY_VALUE_BIG);
+    STACK_ASSERTOK((capacity_ > maxCapacity()), STACK_WRONG_INPUT_CAPACITY_VALUE_BIG);
     STACK_ASSERTOK((capacity_ == 0),            STACK_WRONG_INPUT_CAPACITY_VALUE_NIL);
 
-    data_ = new TYPE[capacity_];
+    data_ = Take(capacity_);
+    STACK_ASSERTOK((data_ == nullptr),          STACK_NO_MEMORY);
 
-    for (int i = 0; i < capacity_; ++i) data_[i] = obj.data_[i];
+    for (size_t i = 0; i < top_; ++i) data_[i] = obj.data_[i];
 
-#ifdef HASH_PROTECT
-    datahash_  = hash(data_, capacity_ * sizeof(TYPE));
-    stackhash_ = hash(this, SizeForHash());
-#endif // HASH_PROTECT
+    SetCanaries();
+
+    if constexpr (POLICY::HASH) datahash_ = DataHash();
+    Rehash();
 
     STACK_CHECK;
 
@@ -68,25 +74,29 @@ Stack<TYPE>::Stack (const Stack& obj) :
 
 //------------------------------------------------------------------------------
 
-template <typename TYPE>
-Stack<TYPE>& Stack<TYPE>::operator = (const Stack& obj)
+template <typename TYPE, size_t INLINE, typename POLICY>
+Stack<TYPE, INLINE, POLICY>& Stack<TYPE, INLINE, POLICY>::operator = (const Stack& obj)
 {
-    STACK_ASSERTOK((obj.capacity_ > MAX_CAPACITY), STACK_WRONG_INPUT_CAPACITY_VALUE_BIG);
-    STACK_ASSERTOK((obj.capacity_ == 0),           STACK_WRONG_INPUT_CAPACITY_VALUE_NIL);
+    if (this == &obj) return *this;
+
+    STACK_ASSERTOK((obj.capacity_ > maxCapacity()), STACK_WRONG_INPUT_CAPACITY_VALUE_BIG);
+    STACK_ASSERTOK((obj.capacity_ == 0),            STACK_WRONG_INPUT_CAPACITY_VALUE_NIL);
 
     size_cur_ = obj.size_cur_;
     capacity_ = obj.capacity_;
+    top_      = obj.top_;
     errCode_  = STACK_OK;
 
-    delete[] data_;
-    data_ = new TYPE[capacity_];
+    Drop();
+    data_ = Take(capacity_);
+    STACK_ASSERTOK((data_ == nullptr),              STACK_NO_MEMORY);
 
-    for (int i = 0; i < capacity_; ++i) copyType(data_[i], obj.data_[i]);
+    for (size_t i = 0; i < top_; ++i) data_[i] = obj.data_[i];
 
-#ifdef HASH_PROTECT
-    datahash_  = hash(data_, capacity_ * sizeof(TYPE));
-    stackhash_ = hash(this, SizeForHash());
-#endif // HASH_PROTECT
+    SetCanaries();
+
+    if constexpr (POLICY::HASH) datahash_ = DataHash();
+    Rehash();
 
     STACK_CHECK;
 
@@ -97,8 +107,67 @@ Stack<TYPE>& Stack<TYPE>::operator = (const Stack& obj)
 
 //------------------------------------------------------------------------------
 
-template <typename TYPE>
-Stack<TYPE>::~Stack ()
+template <typename TYPE, size_t INLINE, typename POLICY>
+Stack<TYPE, INLINE, POLICY>::Stack (Stack&& obj) noexcept : errCode_ (STACK_NOT_CONSTRUCTED)
+{
+    Swap(obj);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE, size_t INLINE, typename POLICY>
+Stack<TYPE, INLINE, POLICY>& Stack<TYPE, INLINE, POLICY>::operator = (Stack&& obj) noexcept
+{
+    if (this != &obj)
+    {
+        Stack<TYPE, INLINE, POLICY> temp(std::move(obj));
+        Swap(temp);
+    }
+
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE, size_t INLINE, typename POLICY>
+void Stack<TYPE, INLINE, POLICY>::Swap (Stack& obj) noexcept
+{
+    std::swap(name_,     obj.name_);
+    std::swap(capacity_, obj.capacity_);
+    std::swap(size_cur_, obj.size_cur_);
+    std::swap(top_,      obj.top_);
+    std::swap(data_,     obj.data_);
+    std::swap(id_,       obj.id_);
+    std::swap(errCode_,  obj.errCode_);
+
+    std::swap(stackhash_, obj.stackhash_);
+    std::swap(datahash_,  obj.datahash_);
+    std::swap(unchecked_, obj.unchecked_);
+
+    if (INLINE == 0) return;
+
+    TYPE* own   = inline_.getData();
+    TYPE* other = obj.inline_.getData();
+
+    inline_.Swap(obj.inline_);
+
+    if (data_     == other) data_     = own;
+    if (obj.data_ == own)   obj.data_ = other;
+
+    if constexpr (POLICY::HASH && !std::is_trivially_copyable<TYPE>::value)
+    {
+        if (data_     == own)   datahash_     = DataHash();
+        if (obj.data_ == other) obj.datahash_ = obj.DataHash();
+    }
+
+    Rehash();
+    obj.Rehash();
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE, size_t INLINE, typename POLICY>
+Stack<TYPE, INLINE, POLICY>::~Stack ()
 {
     if (errCode_ == STACK_NOT_CONSTRUCTED) return;
 
@@ -108,17 +177,17 @@ Stack<TYPE>::~Stack ()
     {
         size_cur_ = 0;
 
-        fillPoison();
+        if constexpr (POLICY::CHECK) fillPoison();
 
-        delete [] data_;
+        Drop();
         data_  = nullptr;
 
         capacity_ = 0;
+        top_      = 0;
 
-        #ifdef HASH_PROTECT
-            datahash_  = 0;
-            stackhash_ = 0;
-        #endif // HASH_PROTECT
+        datahash_  = 0;
+        stackhash_ = 0;
+        unchecked_ = 0;
 
         errCode_ = STACK_DESTRUCTED;
     }
@@ -130,19 +199,22 @@ Stack<TYPE>::~Stack ()
 
 //------------------------------------------------------------------------------
 
-template <typename TYPE>
-int Stack<TYPE>::Push (TYPE value)
+template <typename TYPE, size_t INLINE, typename POLICY>
+int Stack<TYPE, INLINE, POLICY>::Push (TYPE value)
 {
     STACK_CHECK;
 
-    if (size_cur_ == capacity_ - 1) Expand();
+    if ((size_cur_ == capacity_ - 1) && Expand(size_cur_ + 2))
+    {
+        errCode_ = STACK_NO_MEMORY;
+        return STACK_NO_MEMORY;
+    }
+
+    Place(size_cur_++, value);
 
-    data_[size_cur_++] = value;
+    if (size_cur_ == top_) Place(size_cur_, POISON<TYPE>);
 
-#ifdef HASH_PROTECT
-    datahash_  = hash(data_, capacity_ * sizeof(TYPE));
-    stackhash_ = hash(this, SizeForHash());
-#endif // HASH_PROTECT
+    Rehash();
 
     STACK_CHECK;
 
@@ -153,33 +225,55 @@ int Stack<TYPE>::Push (TYPE value)
 
 //------------------------------------------------------------------------------
 
-template <typename TYPE>
-TYPE Stack<TYPE>::Pop ()
+template <typename TYPE, size_t INLINE, typename POLICY>
+int Stack<TYPE, INLINE, POLICY>::PushN (const TYPE* values, size_t n)
 {
+    assert((values != nullptr) || (n == 0));
+
+    STACK_CHECK;
+
+    if ((n > maxCapacity() - size_cur_ - 1) || Expand(size_cur_ + n + 1))
+    {
+        errCode_ = STACK_NO_MEMORY;
+        return STACK_NO_MEMORY;
+    }
+
+    for (size_t i = 0; i < n; ++i) Place(size_cur_++, values[i]);
+
+    if (size_cur_ == top_) Place(size_cur_, POISON<TYPE>);
+
+    Rehash();
+
     STACK_CHECK;
 
-    if (size_cur_ == 0) errCode_ = STACK_EMPTY_STACK;
+    DUMP_PRINT{ Dump (__FUNC_NAME__); }
 
-    if (errCode_ == STACK_EMPTY_STACK)
+    return STACK_OK;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE, size_t INLINE, typename POLICY>
+TYPE Stack<TYPE, INLINE, POLICY>::Pop ()
+{
+    STACK_CHECK;
+
+    if (size_cur_ == 0)
     {
+        errCode_ = STACK_EMPTY_STACK;
+
         DUMP_PRINT{ Dump (__FUNC_NAME__); }
 
-        #ifdef HASH_PROTECT
-            datahash_  = hash(data_, capacity_ * sizeof(TYPE));
-            stackhash_ = hash(this, SizeForHash());
-        #endif // HASH_PROTECT
+        Rehash();
 
         return POISON<TYPE>;
     }
 
     TYPE value = data_[--size_cur_];
 
-    data_[size_cur_] = POISON<TYPE>;
+    if constexpr (POLICY::CHECK) Place(size_cur_, POISON<TYPE>);
 
-#ifdef HASH_PROTECT
-    datahash_  = hash(data_, capacity_ * sizeof(TYPE));
-    stackhash_ = hash(this, SizeForHash());
-#endif // HASH_PROTECT
+    Rehash();
 
     STACK_CHECK;
 
@@ -190,25 +284,84 @@ TYPE Stack<TYPE>::Pop ()
 
 //------------------------------------------------------------------------------
 
-template <typename TYPE>
-void Stack<TYPE>::Clean ()
+template <typename TYPE, size_t INLINE, typename POLICY>
+int Stack<TYPE, INLINE, POLICY>::PopN (TYPE* values, size_t n)
 {
     STACK_CHECK;
 
-    size_cur_ = 0;
-    fillPoison();
-    delete [] data_;
+    if (n > size_cur_)
+    {
+        errCode_ = STACK_EMPTY_STACK;
 
-    capacity_ = DEFAULT_STACK_CAPACITY;
+        DUMP_PRINT{ Dump (__FUNC_NAME__); }
 
-    data_ = new TYPE[capacity_];
+        return STACK_EMPTY_STACK;
+    }
 
-    fillPoison();
+    size_cur_ -= n;
 
-#ifdef HASH_PROTECT
-    datahash_  = hash(data_, capacity_ * sizeof(TYPE));
-    stackhash_ = hash(this, SizeForHash());
-#endif // HASH_PROTECT
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (values != nullptr) values[i] = data_[size_cur_ + i];
+
+        if constexpr (POLICY::CHECK) Place(size_cur_ + i, POISON<TYPE>);
+    }
+
+    Rehash();
+
+    STACK_CHECK;
+
+    DUMP_PRINT{ Dump (__FUNC_NAME__); }
+
+    return STACK_OK;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE, size_t INLINE, typename POLICY>
+int Stack<TYPE, INLINE, POLICY>::Reserve (size_t size)
+{
+    STACK_CHECK;
+
+    if ((size >= maxCapacity()) || ((size + 1 > capacity_) && Reallocate(size + 1)))
+        return STACK_NO_MEMORY;
+
+    Rehash();
+
+    STACK_CHECK;
+
+    return STACK_OK;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE, size_t INLINE, typename POLICY>
+int Stack<TYPE, INLINE, POLICY>::ShrinkToFit ()
+{
+    STACK_CHECK;
+
+    if ((size_cur_ + 1 < capacity_) && Reallocate(size_cur_ + 1)) return STACK_NO_MEMORY;
+
+    Rehash();
+
+    STACK_CHECK;
+
+    return STACK_OK;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE, size_t INLINE, typename POLICY>
+void Stack<TYPE, INLINE, POLICY>::Clean ()
+{
+    STACK_CHECK;
+
+    if constexpr (POLICY::CHECK)
+        while (size_cur_ > 0) Place(--size_cur_, POISON<TYPE>);
+    else
+        size_cur_ = 0;
+
+    Rehash();
 
     STACK_CHECK;
 
@@ -217,58 +370,98 @@ void Stack<TYPE>::Clean ()
 
 //------------------------------------------------------------------------------
 
-template <typename TYPE>
-size_t Stack<TYPE>::getSize () const
+template <typename TYPE, size_t INLINE, typename POLICY>
+size_t Stack<TYPE, INLINE, POLICY>::getSize () const
 {
     return size_cur_;
 }
 
 //------------------------------------------------------------------------------
 
-template <typename TYPE>
-const char* Stack<TYPE>::getName () const
+template <typename TYPE, size_t INLINE, typename POLICY>
+size_t Stack<TYPE, INLINE, POLICY>::getCapacity () const
+{
+    return capacity_;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE, size_t INLINE, typename POLICY>
+TYPE* Stack<TYPE, INLINE, POLICY>::getData ()
+{
+    return data_;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE, size_t INLINE, typename POLICY>
+const TYPE* Stack<TYPE, INLINE, POLICY>::getData () const
+{
+    return data_;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE, size_t INLINE, typename POLICY>
+const char* Stack<TYPE, INLINE, POLICY>::getName () const
 {
     return name_;
 }
 
 //------------------------------------------------------------------------------
 
-template <typename TYPE>
-void Stack<TYPE>::setName (char* name)
+template <typename TYPE, size_t INLINE, typename POLICY>
+void Stack<TYPE, INLINE, POLICY>::setName (char* name)
 {
     name_ = name;
 }
 
 //------------------------------------------------------------------------------
 
-template <typename TYPE>
-TYPE& Stack<TYPE>::operator [] (size_t n)
+template <typename TYPE, size_t INLINE, typename POLICY>
+void Stack<TYPE, INLINE, POLICY>::Set (size_t n, const TYPE& value)
+{
+    STACK_CHECK;
+
+    if constexpr (POLICY::CHECK) STACK_ASSERTOK((n >= size_cur_), STACK_MEM_ACCESS_VIOLATION);
+
+    Place(n, value);
+
+    STACK_CHECK;
+
+    DUMP_PRINT{ Dump (__FUNC_NAME__); }
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE, size_t INLINE, typename POLICY>
+TYPE& Stack<TYPE, INLINE, POLICY>::operator [] (size_t n)
 {
-    STACK_ASSERTOK((n >= capacity_), STACK_MEM_ACCESS_VIOLATION);
+    if constexpr (POLICY::CHECK) STACK_ASSERTOK((n >= top_), STACK_MEM_ACCESS_VIOLATION);
 
     return data_[n];
 }
 
 //------------------------------------------------------------------------------
 
-template <typename TYPE>
-const TYPE& Stack<TYPE>::operator [] (size_t n) const
+template <typename TYPE, size_t INLINE, typename POLICY>
+const TYPE& Stack<TYPE, INLINE, POLICY>::operator [] (size_t n) const
 {
-    STACK_ASSERTOK((n >= capacity_), STACK_MEM_ACCESS_VIOLATION);
-    
+    if constexpr (POLICY::CHECK) STACK_ASSERTOK((n >= top_), STACK_MEM_ACCESS_VIOLATION);
+
     return data_[n];
 }
 
 //------------------------------------------------------------------------------
 
-template <typename TYPE>
-void Stack<TYPE>::fillPoison ()
+template <typename TYPE, size_t INLINE, typename POLICY>
+void Stack<TYPE, INLINE, POLICY>::fillPoison ()
 {
     assert(this     != nullptr);
     assert(data_    != nullptr);
     assert(size_cur_ < capacity_);
 
-    for (int i = size_cur_; i < capacity_; ++i)
+    for (size_t i = size_cur_; i < top_; ++i)
     {
         data_[i] = POISON<TYPE>;
     }
@@ -276,29 +469,197 @@ void Stack<TYPE>::fillPoison ()
 
 //------------------------------------------------------------------------------
 
-template <typename TYPE>
-int Stack<TYPE>::Expand ()
+template <typename TYPE, size_t INLINE, typename POLICY>
+void Stack<TYPE, INLINE, POLICY>::Place (size_t n, const TYPE& value)
+{
+    assert(n <= top_);
+    assert(n < capacity_);
+
+    if constexpr (POLICY::HASH)
+        if (n < top_) datahash_ ^= SlotHash(n);
+
+    data_[n] = value;
+
+    if constexpr (POLICY::HASH) datahash_ ^= SlotHash(n);
+
+    if (n == top_) ++top_;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE, size_t INLINE, typename POLICY>
+TYPE* Stack<TYPE, INLINE, POLICY>::Take (size_t capacity)
+{
+    if (capacity <= INLINE) return inline_.getData();
+
+    return Allocate(capacity);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE, size_t INLINE, typename POLICY>
+void Stack<TYPE, INLINE, POLICY>::Drop ()
+{
+    if (data_ != inline_.getData()) Release(data_);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE, size_t INLINE, typename POLICY>
+TYPE* Stack<TYPE, INLINE, POLICY>::Allocate (size_t capacity)
+{
+    if constexpr (std::is_trivially_copyable<TYPE>::value && POLICY::CANARY)
+    {
+        char* block = (char*)malloc(CANARY_SPACE + capacity * sizeof(TYPE) + sizeof(STACK_CANARY));
+        return (block == nullptr) ? nullptr : (TYPE*)(block + CANARY_SPACE);
+    }
+    else if constexpr (std::is_trivially_copyable<TYPE>::value)
+        return (TYPE*)malloc(capacity * sizeof(TYPE));
+    else
+        return new (std::nothrow) TYPE[capacity];
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE, size_t INLINE, typename POLICY>
+void Stack<TYPE, INLINE, POLICY>::Release (TYPE* data)
+{
+    if constexpr (std::is_trivially_copyable<TYPE>::value && POLICY::CANARY)
+        free((data == nullptr) ? nullptr : (char*)data - CANARY_SPACE);
+    else if constexpr (std::is_trivially_copyable<TYPE>::value)
+        free(data);
+    else
+        delete [] data;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE, size_t INLINE, typename POLICY>
+TYPE* Stack<TYPE, INLINE, POLICY>::Resize (TYPE* data, size_t capacity)
+{
+    static_assert(std::is_trivially_copyable<TYPE>::value, "only trivially copyable data is realloc'ed");
+
+    if constexpr (POLICY::CANARY)
+    {
+        char* block = (char*)realloc((char*)data - CANARY_SPACE, CANARY_SPACE + capacity * sizeof(TYPE) + sizeof(STACK_CANARY));
+        return (block == nullptr) ? nullptr : (TYPE*)(block + CANARY_SPACE);
+    }
+    else
+        return (TYPE*)realloc(data, capacity * sizeof(TYPE));
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE, size_t INLINE, typename POLICY>
+constexpr size_t Stack<TYPE, INLINE, POLICY>::maxCapacity ()
+{
+    const size_t most = (PTRDIFF_MAX - CANARY_SPACE - sizeof(STACK_CANARY)) / sizeof(TYPE);
+
+    return (MAX_CAPACITY < most) ? MAX_CAPACITY : most;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE, size_t INLINE, typename POLICY>
+void Stack<TYPE, INLINE, POLICY>::SetCanaries ()
+{
+    if constexpr (std::is_trivially_copyable<TYPE>::value && POLICY::CANARY)
+    {
+        if (data_ == inline_.getData()) return;
+
+        memcpy((char*)data_ - sizeof(STACK_CANARY), &STACK_CANARY, sizeof(STACK_CANARY));
+        memcpy((char*)(data_ + capacity_),          &STACK_CANARY, sizeof(STACK_CANARY));
+    }
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE, size_t INLINE, typename POLICY>
+bool Stack<TYPE, INLINE, POLICY>::CanariesAlive () const
+{
+    if ((canary1_ != STACK_CANARY) || (canary2_ != STACK_CANARY) || !inline_.isAlive()) return 0;
+
+    if constexpr (std::is_trivially_copyable<TYPE>::value)
+    {
+        if (data_ == inline_.getData()) return 1;
+
+        if (memcmp((const char*)data_ - sizeof(STACK_CANARY), &STACK_CANARY, sizeof(STACK_CANARY)) ||
+            memcmp((const char*)(data_ + capacity_),          &STACK_CANARY, sizeof(STACK_CANARY))   )
+            return 0;
+    }
+
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE, size_t INLINE, typename POLICY>
+int Stack<TYPE, INLINE, POLICY>::Expand (size_t capacity)
 {
     assert(this != nullptr);
 
-    capacity_ *= 2;
+    if (capacity <= capacity_) return STACK_OK;
+    if (capacity > maxCapacity()) return STACK_NO_MEMORY;
+
+    size_t twice = (capacity_ > maxCapacity() / 2) ? maxCapacity() : capacity_ * 2;
+
+    return Reallocate((twice > capacity) ? twice : capacity);
+}
 
-    TYPE* temp = temp = new TYPE[capacity_];
+//------------------------------------------------------------------------------
 
-    memcpy(temp, (char*)data_, capacity_ * sizeof(TYPE) / 2);
+template <typename TYPE, size_t INLINE, typename POLICY>
+int Stack<TYPE, INLINE, POLICY>::Reallocate (size_t capacity)
+{
+    assert(this != nullptr);
+    assert(capacity > size_cur_);
 
-    delete [] data_;
-    data_ = temp;
+    if (capacity < INLINE) capacity = INLINE;
 
-    fillPoison();
+    hash_t cut = 0;
+    if constexpr (POLICY::HASH && std::is_trivially_copyable<TYPE>::value)
+        for (size_t i = capacity; i < top_; ++i) cut ^= SlotHash(i);
+
+    TYPE* own  = inline_.getData();
+    TYPE* temp = (capacity == INLINE) ? own : nullptr;
+
+    bool heap = (temp == nullptr) && (data_ != own);
+
+    if constexpr (std::is_trivially_copyable<TYPE>::value)
+    {
+        if (heap) temp = Resize(data_, capacity);
+        if (heap && (temp == nullptr)) return STACK_NO_MEMORY;
+    }
+
+    if ((temp != data_) && !(std::is_trivially_copyable<TYPE>::value && heap))
+    {
+        if (temp == nullptr) temp = Allocate(capacity);
+        if (temp == nullptr) return STACK_NO_MEMORY;
+
+        for (size_t i = 0; (i < top_) && (i < capacity); ++i) temp[i] = std::move(data_[i]);
+
+        Drop();
+    }
+
+    data_     = temp;
+    capacity_ = capacity;
+
+    if (top_ > capacity_) top_ = capacity_;
+
+    SetCanaries();
+
+    if constexpr (POLICY::HASH && std::is_trivially_copyable<TYPE>::value)
+        datahash_ ^= cut;
+    else if constexpr (POLICY::HASH)
+        datahash_ = DataHash();
 
     return STACK_OK;
 }
 
 //------------------------------------------------------------------------------
 
-template <typename TYPE>
-int Stack<TYPE>::Dump (const char* funcname, const char* logfile)
+template <typename TYPE, size_t INLINE, typename POLICY>
+int Stack<TYPE, INLINE, POLICY>::Dump (const char* funcname, const char* logfile)
 {
     const size_t linelen = 80;
     char divline[linelen + 1] = "********************************************************************************";
@@ -352,30 +713,36 @@ int Stack<TYPE>::Dump (const char* funcname, const char* logfile)
     fprintf(fp, "\tCapacity           = %lu\n",   capacity_);
     fprintf(fp, "\tCurrent size       = %lu\n\n", size_cur_);
 
-#ifdef HASH_PROTECT
-    fprintf(fp, "\tStack hash         = " HASH_PRINT_FORMAT "\n",   stackhash_);
-    fprintf(fp, "\tData hash          = " HASH_PRINT_FORMAT "\n\n", datahash_);
+    if constexpr (POLICY::CANARY)
+        fprintf(fp, "\tCanaries           = %s\n\n", CanariesAlive() ? "alive" : "DEAD");
 
-    if ((errCode_ != STACK_OK) && (errCode_ != STACK_EMPTY_STACK) && (errCode_ != STACK_NO_MEMORY))
+    if constexpr (POLICY::HASH)
     {
-        fprintf(fp, "\tTrue stack hash    = " HASH_PRINT_FORMAT "\n",   hash(this, SizeForHash()));
-        fprintf(fp, "\tTrue data hash     = " HASH_PRINT_FORMAT "\n\n", hash(data_, capacity_ * sizeof(TYPE)));
+        fprintf(fp, "\tStack hash         = " HASH_PRINT_FORMAT "\n",   stackhash_);
+        fprintf(fp, "\tData hash          = " HASH_PRINT_FORMAT "\n\n", datahash_);
+
+        if ((errCode_ != STACK_OK) && (errCode_ != STACK_EMPTY_STACK) && (errCode_ != STACK_NO_MEMORY))
+        {
+            fprintf(fp, "\tTrue stack hash    = " HASH_PRINT_FORMAT "\n",   hash(this, SizeForHash()));
+            fprintf(fp, "\tTrue data hash     = " HASH_PRINT_FORMAT "\n\n", DataHash());
+        }
     }
-#endif // HASH_PROTECT
 
     fprintf(fp, "\tData [" PRINT_PTR "]\n", data_);
 
     fprintf(fp, "\t\t{\n");
 
-    for (int i = 0; i < capacity_; i++)
+    for (size_t i = 0; i < top_; i++)
     {
         char ispois = isPOISON(data_[i]);
 
-        fprintf(fp, "\t\t%s[%d]: [", (ispois) ? " ": "*", i);
+        fprintf(fp, "\t\t%s[%zu]: [", (ispois) ? " ": "*", i);
         TypePrint(fp, data_[i]);
         fprintf(fp, "]%s\n", (ispois) ? " (POISON)": "");
     }
 
+    if (top_ < capacity_) fprintf(fp, "\t\t [%zu - %zu]: not used yet\n", top_, capacity_ - 1);
+
     fprintf(fp, "\t\t}\n");
 
     fprintf(fp, "\t}\n");
@@ -388,8 +755,8 @@ int Stack<TYPE>::Dump (const char* funcname, const char* logfile)
 
 //------------------------------------------------------------------------------
 
-template <typename TYPE>
-int Stack<TYPE>::Check ()
+template <typename TYPE, size_t INLINE, typename POLICY>
+int Stack<TYPE, INLINE, POLICY>::Check ()
 {
     if (this == nullptr)
     {
@@ -406,12 +773,15 @@ int Stack<TYPE>::Check ()
         return STACK_DESTRUCTED;
     }
 
-#ifdef HASH_PROTECT
-    else if (stackhash_ != hash(this, SizeForHash()))
+    else if (POLICY::CANARY && !CanariesAlive())
+    {
+        errCode_ = STACK_CANARY_DIED;
+    }
+
+    else if (POLICY::HASH && (stackhash_ != hash(this, SizeForHash())))
     {
         errCode_ = STACK_INCORRECT_HASH;
     }
-#endif // HASH_PROTECT
 
     else if (data_ == nullptr)
     {
@@ -423,22 +793,25 @@ int Stack<TYPE>::Check ()
         errCode_ = STACK_SIZE_BIGGER_CAPACITY;
     }
 
-    else if ((capacity_ == 0) || (capacity_ > MAX_CAPACITY))
+    else if ((capacity_ == 0) || (capacity_ > maxCapacity()))
     {
         errCode_ = STACK_CAPACITY_WRONG_VALUE;
     }
 
+    else if ((size_cur_ >= top_) || (top_ > capacity_))
+    {
+        errCode_ = STACK_WRONG_CUR_SIZE;
+    }
+
     else if (! isPOISON(data_[size_cur_]))
     {
         errCode_ = STACK_WRONG_CUR_SIZE;
     }
 
-#ifdef HASH_PROTECT
-    else if (datahash_ != hash(data_, capacity_ * sizeof(TYPE)))
+    else if (POLICY::HASH && DataCheckDue() && (datahash_ != DataHash()))
     {
         errCode_ = STACK_INCORRECT_HASH;
     }
-#endif // HASH_PROTECT
 
     else
     {
@@ -450,8 +823,8 @@ int Stack<TYPE>::Check ()
 
 //------------------------------------------------------------------------------
 
-template <typename TYPE>
-void Stack<TYPE>::ErrorPrint (FILE* fp)
+template <typename TYPE, size_t INLINE, typename POLICY>
+void Stack<TYPE, INLINE, POLICY>::ErrorPrint (FILE* fp)
 {
     assert(fp != nullptr);
 
@@ -502,24 +875,66 @@ static void printError (const char* logname, const char* file, int line, const c
 
 //------------------------------------------------------------------------------
 
-#ifdef HASH_PROTECT
+template <typename TYPE, size_t INLINE, typename POLICY>
+void Stack<TYPE, INLINE, POLICY>::Rehash ()
+{
+    if constexpr (POLICY::HASH) stackhash_ = hash(this, SizeForHash());
+}
+
+//------------------------------------------------------------------------------
 
-template <typename TYPE>
-size_t Stack<TYPE>::SizeForHash ()
+template <typename TYPE, size_t INLINE, typename POLICY>
+size_t Stack<TYPE, INLINE, POLICY>::SizeForHash ()
 {
     assert(this != nullptr);
 
     size_t size = 0;
 
+    size += sizeof(canary1_);
     size += sizeof(name_);
     size += sizeof(capacity_);
     size += sizeof(size_cur_);
+    size += sizeof(top_);
     size += sizeof(data_);
     size += sizeof(id_);
 
     return size;
 }
 
-#endif // HASH_PROTECT
+//------------------------------------------------------------------------------
+
+template <typename TYPE, size_t INLINE, typename POLICY>
+hash_t Stack<TYPE, INLINE, POLICY>::SlotHash (size_t n) const
+{
+    assert(n < capacity_);
+
+    return hash_at(n, data_ + n, sizeof(TYPE));
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE, size_t INLINE, typename POLICY>
+hash_t Stack<TYPE, INLINE, POLICY>::DataHash () const
+{
+    hash_t datahash = 0;
+
+    for (size_t i = 0; i < top_; ++i) datahash ^= SlotHash(i);
+
+    return datahash;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE, size_t INLINE, typename POLICY>
+bool Stack<TYPE, INLINE, POLICY>::DataCheckDue ()
+{
+    if constexpr (POLICY::STRICT) return 1;
+
+    if (++unchecked_ < capacity_) return 0;
+
+    unchecked_ = 0;
+
+    return 1;
+}
 
 //------------------------------------------------------------------------------
@@ -14,6 +14,7 @@
 
 
 #include "../Types.h"
+#include <stdint.h>
 #include <stdlib.h>
 #include <time.h>
 
@@ -34,26 +35,46 @@
 
 #define CONSOLE_PRINT  if(1)
 
-#ifdef  NO_DUMP
-
-    #define DUMP_PRINT if(0)
-
-#else
-
-    #define DUMP_PRINT if(1)
-
-#endif // NO_DUMP
-
-#ifndef NO_HASH
+/*------------------------------------------------------------------------------
+    Stack policies, the last template parameter of Stack. Stacks of different
+    policies live in one program, the policy of a stack is its type.
+
+    StackUnchecked      no checks, Push and Pop are plain array operations
+    StackBoundsChecked  the stack is checked on every operation, the free
+                        slots are poisoned, operator [] checks the index
+    StackCanary         and canaries around the stack fields and the data
+    StackHashed         and hashes of the stack fields and the data. The data
+                        hash is updated by the changed elements only and is
+                        checked against the data once per capacity checks,
+                        so a check costs O(1) in average
+    StackDebug          and the data hash checked on every operation, the
+                        stack is dumped to the log after every operation
+*///----------------------------------------------------------------------------
+
+struct StackUnchecked
+{
+    static constexpr bool CHECK  = false;
+    static constexpr bool CANARY = false;
+    static constexpr bool HASH   = false;
+    static constexpr bool STRICT = false;
+    static constexpr bool DUMP   = false;
+};
 
-    #define HASH_PROTECT
+struct StackBoundsChecked : StackUnchecked     { static constexpr bool CHECK  = true; };
+struct StackCanary        : StackBoundsChecked { static constexpr bool CANARY = true; };
+struct StackHashed        : StackCanary        { static constexpr bool HASH   = true; };
 
-#endif // NO_HASH
+struct StackDebug : StackHashed
+{
+    static constexpr bool STRICT = true;
+    static constexpr bool DUMP   = true;
+};
 
 
 char const * const STACK_LOGNAME = "stack.log";
 
-constexpr size_t MAX_CAPACITY  = 100000;
+constexpr size_t MAX_CAPACITY  = SIZE_MAX;   // the data is never bigger than PTRDIFF_MAX bytes either
+constexpr uint64_t STACK_CANARY = 0xBADC0FFEE0DDF00DULL;
 
 
 enum StackErrors
@@ -77,6 +98,7 @@ enum StackErrors
     STACK_WRONG_INPUT_CAPACITY_VALUE_BIG                            ,
     STACK_WRONG_INPUT_CAPACITY_VALUE_NIL                            ,
     STACK_WRONG_INPUT_STACK_NAME                                    ,
+    STACK_CANARY_DIED                                               ,
 };
 
 char const * const stk_errstr[] =
@@ -100,6 +122,7 @@ char const * const stk_errstr[] =
     "Wrong capacity value: - is too big"                            ,
     "Wrong capacity value: - is nil"                                ,
     "Wrong input stack name"                                        ,
+    "Stack canary died, memory around the stack was overwritten"    ,
 };
 
 
@@ -0,0 +1,156 @@
+/*------------------------------------------------------------------------------
+    * File:        TaskPool.h                                                  *
+    * Description: Pool of threads running tasks from work-stealing deques.    *
+    * Created:     1 dec 2020                                                  *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+#ifndef TASKPOOL_H_INCLUDED
+#define TASKPOOL_H_INCLUDED
+
+#define _CRT_SECURE_NO_WARNINGS
+
+
+#include "WorkDeque.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+
+//------------------------------------------------------------------------------
+/*! @brief   Pool of threads for recursive jobs. Every thread has its own
+ *           deque, a task spawns subtasks to it and idle threads steal them.
+ *           The thread calling Run works as the thread 0.
+ */
+
+template <typename TASK>
+class TaskPool
+{
+    typedef std::function<void (TASK task, size_t thread)> Job;
+
+    size_t            threads_ = 0;
+    std::thread*      workers_ = nullptr;
+    WorkDeque<TASK>*  deques_  = nullptr;
+
+    Job               job_;
+    std::atomic<size_t> idle_;
+
+    std::mutex              mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+
+    size_t generation_ = 0;
+    size_t running_    = 0;
+    bool   stop_       = false;
+
+public:
+
+//------------------------------------------------------------------------------
+/*! @brief   Pool constructor, the threads wait for jobs.
+ *
+ *  @param   threads     Number of threads with the calling one, 0 for the
+ *                       number of hardware threads
+ */
+
+    TaskPool (size_t threads = 0);
+
+//------------------------------------------------------------------------------
+/*! @brief   Pool copy constructor (deleted).
+ *
+ *  @param   obj         Source pool
+ */
+
+    TaskPool (const TaskPool& obj) = delete;
+
+    TaskPool& operator = (const TaskPool& obj) = delete;
+
+//------------------------------------------------------------------------------
+/*! @brief   Pool destructor, the threads are stopped.
+ */
+
+   ~TaskPool ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Run the job from the first task until no tasks are left.
+ *
+ *  @param   task        First task
+ *  @param   job         Function taking a task and the number of the thread
+ *                       running it, it may Spawn more tasks
+ */
+
+    void Run (TASK task, Job job);
+
+//------------------------------------------------------------------------------
+/*! @brief   Add a task, called from the job.
+ *
+ *  @param   thread      Number of the thread running the job
+ *  @param   task        Task
+ */
+
+    void Spawn (size_t thread, TASK task);
+
+//------------------------------------------------------------------------------
+/*! @brief   Check if the thread should give work away (its deque is empty).
+ *
+ *  @param   thread      Number of the thread running the job
+ *
+ *  @return  1 if the deque of the thread is empty and there are other
+ *           threads to take the work, else 0
+ */
+
+    bool isHungry (size_t thread) const;
+
+//------------------------------------------------------------------------------
+/*! @brief   Get number of threads.
+ *
+ *  @return  number of threads with the one calling Run
+ */
+
+    size_t getThreads () const;
+
+/*------------------------------------------------------------------------------
+                   Private functions                                           *
+*///----------------------------------------------------------------------------
+
+private:
+
+//------------------------------------------------------------------------------
+/*! @brief   Wait for jobs and work on them, the loop of a pool thread.
+ *
+ *  @param   thread      Number of the thread
+ */
+
+    void Serve (size_t thread);
+
+//------------------------------------------------------------------------------
+/*! @brief   Run tasks of the current job until all threads are idle.
+ *
+ *  @param   thread      Number of the thread
+ */
+
+    void Work (size_t thread);
+
+//------------------------------------------------------------------------------
+/*! @brief   Take a task from the deque of another thread.
+ *
+ *  @param   thread      Number of the thread
+ *  @param   task        Place for the task
+ *
+ *  @return  1 if a task is taken, else 0
+ */
+
+    bool Steal (size_t thread, TASK& task);
+
+//------------------------------------------------------------------------------
+};
+
+#include "TaskPool.ipp"
+
+#endif // TASKPOOL_H_INCLUDED
@@ -0,0 +1,183 @@
+/*------------------------------------------------------------------------------
+    * File:        TaskPool.ipp                                                *
+    * Description: Implementations of task pool functions.                     *
+    * Created:     1 dec 2020                                                  *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+/*------------------------------------------------------------------------------
+    A job ends when all threads are idle. A thread counts itself idle when its
+    deque is empty, and stops being idle before it steals. So while idle_ is
+    below the number of threads, some thread holds a task or has a non-empty
+    deque. When it reaches the number of threads, nobody can spawn a task
+    anymore.
+*///----------------------------------------------------------------------------
+
+template <typename TASK>
+TaskPool<TASK>::TaskPool (size_t threads) :
+    idle_ (0)
+{
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+
+    threads_ = threads;
+    deques_  = new WorkDeque<TASK>[threads_];
+    workers_ = new std::thread[threads_ - 1];
+
+    for (size_t i = 1; i < threads_; ++i) workers_[i - 1] = std::thread(&TaskPool::Serve, this, i);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TASK>
+TaskPool<TASK>::~TaskPool ()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+
+    wake_.notify_all();
+
+    for (size_t i = 1; i < threads_; ++i) workers_[i - 1].join();
+
+    delete [] workers_;
+    delete [] deques_;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TASK>
+void TaskPool<TASK>::Run (TASK task, Job job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        job_ = job;
+        idle_.store(0);
+
+        running_ = threads_ - 1;
+        ++generation_;
+    }
+
+    deques_[0].Push(task);
+
+    wake_.notify_all();
+
+    Work(0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return running_ == 0; });
+
+    job_ = nullptr;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TASK>
+void TaskPool<TASK>::Spawn (size_t thread, TASK task)
+{
+    assert(thread < threads_);
+
+    deques_[thread].Push(task);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TASK>
+bool TaskPool<TASK>::isHungry (size_t thread) const
+{
+    assert(thread < threads_);
+
+    return (threads_ > 1) && deques_[thread].isEmpty();
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TASK>
+size_t TaskPool<TASK>::getThreads () const
+{
+    return threads_;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TASK>
+void TaskPool<TASK>::Serve (size_t thread)
+{
+    size_t seen = 0;
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this, seen] { return stop_ || (generation_ != seen); });
+
+            if (stop_) return;
+
+            seen = generation_;
+        }
+
+        Work(thread);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--running_ == 0) done_.notify_all();
+    }
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TASK>
+void TaskPool<TASK>::Work (size_t thread)
+{
+    bool idle = false;
+    TASK task;
+
+    for (;;)
+    {
+        if (deques_[thread].Pop(task))
+        {
+            job_(task, thread);
+            continue;
+        }
+
+        if (!idle) idle_.fetch_add(1);
+        idle = true;
+
+        if (idle_.load() == threads_) return;
+
+        if (Steal(thread, task))
+        {
+            idle = false;
+            job_(task, thread);
+        }
+        else
+            std::this_thread::yield();
+    }
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TASK>
+bool TaskPool<TASK>::Steal (size_t thread, TASK& task)
+{
+    for (size_t i = 1; i < threads_; ++i)
+    {
+        WorkDeque<TASK>& victim = deques_[(thread + i) % threads_];
+
+        if (victim.isEmpty()) continue;
+
+        idle_.fetch_sub(1);
+
+        if (victim.Steal(task)) return 1;
+
+        idle_.fetch_add(1);
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
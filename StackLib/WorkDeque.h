@@ -0,0 +1,156 @@
+/*------------------------------------------------------------------------------
+    * File:        WorkDeque.h                                                 *
+    * Description: Work-stealing deque library.                                *
+    * Created:     1 dec 2020                                                  *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+#ifndef WORKDEQUE_H_INCLUDED
+#define WORKDEQUE_H_INCLUDED
+
+#define _CRT_SECURE_NO_WARNINGS
+
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <atomic>
+#include <type_traits>
+
+
+const size_t DEFAULT_DEQUE_CAPACITY = 64;
+
+
+//------------------------------------------------------------------------------
+/*! @brief   Lock-free work-stealing deque (Chase-Lev). The owner thread pushes
+ *           and pops at the bottom, other threads steal from the top.
+ *
+ *  @note    The memory of the deque grows and is given back only by the
+ *           destructor, thieves may still read the old arrays.
+ */
+
+template <typename TYPE>
+class WorkDeque
+{
+    static_assert(std::is_trivially_copyable<TYPE>::value, "deque values are copied by atomic loads");
+
+    struct Array
+    {
+        size_t             mask_ = 0;
+        Array*             prev_ = nullptr;
+        std::atomic<TYPE>* data_ = nullptr;
+    };
+
+    alignas(64) std::atomic<int64_t> top_;
+    alignas(64) std::atomic<int64_t> bottom_;
+    alignas(64) std::atomic<Array*>  array_;
+
+public:
+
+//------------------------------------------------------------------------------
+/*! @brief   Deque constructor.
+ *
+ *  @param   capacity    Capacity of the deque, rounded up to a power of 2
+ */
+
+    WorkDeque (size_t capacity = DEFAULT_DEQUE_CAPACITY);
+
+//------------------------------------------------------------------------------
+/*! @brief   Deque copy constructor (deleted).
+ *
+ *  @param   obj         Source deque
+ */
+
+    WorkDeque (const WorkDeque& obj) = delete;
+
+    WorkDeque& operator = (const WorkDeque& obj) = delete;
+
+//------------------------------------------------------------------------------
+/*! @brief   Deque destructor.
+ */
+
+   ~WorkDeque ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Push a value to the bottom, only the owner thread calls it.
+ *
+ *  @param   value       Value to push
+ */
+
+    void Push (TYPE value);
+
+//------------------------------------------------------------------------------
+/*! @brief   Pop a value from the bottom, only the owner thread calls it.
+ *
+ *  @param   value       Place for the value
+ *
+ *  @return  1 if the value is taken, 0 if the deque is empty
+ */
+
+    bool Pop (TYPE& value);
+
+//------------------------------------------------------------------------------
+/*! @brief   Steal a value from the top, any thread calls it.
+ *
+ *  @param   value       Place for the value
+ *
+ *  @return  1 if the value is taken, 0 if the deque is empty or another
+ *           thread took the value first
+ */
+
+    bool Steal (TYPE& value);
+
+//------------------------------------------------------------------------------
+/*! @brief   Get size of the deque, exact only for the owner thread.
+ *
+ *  @return  number of values
+ */
+
+    size_t getSize () const;
+
+//------------------------------------------------------------------------------
+/*! @brief   Check if the deque looks empty, exact only for the owner thread.
+ *
+ *  @return  1 if empty, else 0
+ */
+
+    bool isEmpty () const;
+
+/*------------------------------------------------------------------------------
+                   Private functions                                           *
+*///----------------------------------------------------------------------------
+
+private:
+
+//------------------------------------------------------------------------------
+/*! @brief   Make a new array for the deque values.
+ *
+ *  @param   capacity    Capacity, a power of 2
+ *  @param   prev        Previous array of the deque
+ *
+ *  @return  pointer to the array
+ */
+
+    static Array* newArray (size_t capacity, Array* prev);
+
+//------------------------------------------------------------------------------
+/*! @brief   Double the array, the values from top to bottom are copied.
+ *
+ *  @param   array       Current array
+ *  @param   top         Top index
+ *  @param   bottom      Bottom index
+ *
+ *  @return  pointer to the new array
+ */
+
+    Array* Grow (Array* array, int64_t top, int64_t bottom);
+
+//------------------------------------------------------------------------------
+};
+
+#include "WorkDeque.ipp"
+
+#endif // WORKDEQUE_H_INCLUDED
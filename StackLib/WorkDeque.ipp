@@ -0,0 +1,164 @@
+/*------------------------------------------------------------------------------
+    * File:        WorkDeque.ipp                                               *
+    * Description: Implementations of work-stealing deque functions.           *
+    * Created:     1 dec 2020                                                  *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+/*------------------------------------------------------------------------------
+    The orders follow "Correct and Efficient Work-Stealing for Weak Memory
+    Models" (Le, Pop, Cohen, Zappa Nardelli), the fences of Pop and Steal are
+    folded into seq_cst loads and stores of top_ and bottom_.
+*///----------------------------------------------------------------------------
+
+template <typename TYPE>
+WorkDeque<TYPE>::WorkDeque (size_t capacity) :
+    top_    (0),
+    bottom_ (0),
+    array_  (nullptr)
+{
+    size_t size = 2;
+    while (size < capacity) size *= 2;
+
+    array_.store(newArray(size, nullptr), std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+WorkDeque<TYPE>::~WorkDeque ()
+{
+    Array* array = array_.load(std::memory_order_relaxed);
+
+    while (array != nullptr)
+    {
+        Array* prev = array->prev_;
+
+        delete [] array->data_;
+        delete array;
+
+        array = prev;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void WorkDeque<TYPE>::Push (TYPE value)
+{
+    int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    int64_t top    = top_.load(std::memory_order_acquire);
+    Array*  array  = array_.load(std::memory_order_relaxed);
+
+    if ((size_t)(bottom - top) > array->mask_) array = Grow(array, top, bottom);
+
+    array->data_[bottom & array->mask_].store(value, std::memory_order_relaxed);
+
+    bottom_.store(bottom + 1, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+bool WorkDeque<TYPE>::Pop (TYPE& value)
+{
+    int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    Array*  array  = array_.load(std::memory_order_relaxed);
+
+    bottom_.store(bottom, std::memory_order_seq_cst);
+
+    int64_t top = top_.load(std::memory_order_seq_cst);
+
+    if (top > bottom)
+    {
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+        return 0;
+    }
+
+    value = array->data_[bottom & array->mask_].load(std::memory_order_relaxed);
+    if (top < bottom) return 1;
+
+    bool taken = top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+
+    return taken;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+bool WorkDeque<TYPE>::Steal (TYPE& value)
+{
+    int64_t top    = top_.load(std::memory_order_seq_cst);
+    int64_t bottom = bottom_.load(std::memory_order_seq_cst);
+
+    if (top >= bottom) return 0;
+
+    Array* array = array_.load(std::memory_order_acquire);
+
+    TYPE taken = array->data_[top & array->mask_].load(std::memory_order_relaxed);
+
+    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return 0;
+
+    value = taken;
+
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+size_t WorkDeque<TYPE>::getSize () const
+{
+    int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    int64_t top    = top_.load(std::memory_order_relaxed);
+
+    return (bottom > top) ? (size_t)(bottom - top) : 0;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+bool WorkDeque<TYPE>::isEmpty () const
+{
+    return getSize() == 0;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+typename WorkDeque<TYPE>::Array* WorkDeque<TYPE>::newArray (size_t capacity, Array* prev)
+{
+    Array* array = new Array;
+
+    array->mask_ = capacity - 1;
+    array->prev_ = prev;
+    array->data_ = new std::atomic<TYPE>[capacity];
+
+    return array;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+typename WorkDeque<TYPE>::Array* WorkDeque<TYPE>::Grow (Array* array, int64_t top, int64_t bottom)
+{
+    Array* bigger = newArray(2 * (array->mask_ + 1), array);
+
+    for (int64_t i = top; i < bottom; ++i)
+    {
+        TYPE value = array->data_[i & array->mask_].load(std::memory_order_relaxed);
+        bigger->data_[i & bigger->mask_].store(value, std::memory_order_relaxed);
+    }
+
+    array_.store(bigger, std::memory_order_release);
+
+    return bigger;
+}
+
+//------------------------------------------------------------------------------
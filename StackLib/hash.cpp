@@ -10,6 +10,192 @@
     *///------------------------------------------------------------------------
 
 #include "hash.h"
+#include <stdint.h>
+#include <algorithm>
+
+#if defined (__SSE2__) && !defined (HASH_NO_SIMD)
+#include <emmintrin.h>
+#define HASH_SSE2
+#endif // __SSE2__
+
+//------------------------------------------------------------------------------
+
+static const hash_t PRIME64_1 = 0x9E3779B185EBCA87ULL;
+static const hash_t PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+static const hash_t PRIME64_3 = 0x165667B19E3779F9ULL;
+static const hash_t PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+static const hash_t PRIME64_5 = 0x27D4EB2F165667C5ULL;
+static const hash_t PRIME32_1 = 0x9E3779B1ULL;
+
+static const size_t LANES_NUM        = BLOCK_SIZE / HASH_SIZE;
+static const size_t STRIPES_PER_ROUND = 16;
+
+static const hash_t StripeKeys[LANES_NUM + STRIPES_PER_ROUND] =
+{
+    0xC0E16B163A85A4DCULL, 0x890ACD8DD443C47CULL, 0xB3889D8A6DC47761ULL, 0x6A0398E528F0AE6AULL,
+    0x048344ECE48A855EULL, 0xF175CFEA21871330ULL, 0x391CEEF02702C2FDULL, 0x4BAF8CAC4784CB12ULL,
+    0x3547744583A3F88EULL, 0xD9CF2B15C6B6C90EULL, 0x961FACC76D5FE21CULL, 0x0094AB49D50F11F9ULL,
+    0xE3211E37BDBEB6DCULL, 0x62FE6C274FF3511AULL, 0x5AC30B329FDF0574ULL, 0x1450582C6B65B406ULL,
+    0x7A30FCC7888EB791ULL, 0x5540F5BA6A15576EULL, 0x16CEF0559096D3E9ULL, 0x2CF8F14B06874899ULL,
+    0xC9C9263B6E2CE103ULL, 0xD6FF920B0A9FAA6DULL, 0x53192697DB998DC1ULL, 0x73EA9B9BC7CD18D7ULL,
+};
+
+//------------------------------------------------------------------------------
+
+static inline hash_t hash_rotl (hash_t value, int shift)
+{
+    return (value << shift) | (value >> (64 - shift));
+}
+
+//------------------------------------------------------------------------------
+
+static inline hash_t hash_read (const unsigned char* bytes)
+{
+    hash_t word = 0;
+    memcpy(&word, bytes, HASH_SIZE);
+
+    return word;
+}
+
+//------------------------------------------------------------------------------
+
+static inline hash_t hash_mix (hash_t hsh)
+{
+    hsh ^= hsh >> 30;
+    hsh *= 0xBF58476D1CE4E5B9ULL;
+    hsh ^= hsh >> 27;
+    hsh *= 0x94D049BB133111EBULL;
+    hsh ^= hsh >> 31;
+
+    return hsh;
+}
+
+//------------------------------------------------------------------------------
+
+static inline hash_t hash_round (hash_t hsh, hash_t word)
+{
+    word *= PRIME64_2;
+    word  = hash_rotl(word, 31);
+    word *= PRIME64_1;
+
+    return hash_rotl(hsh ^ word, 27) * PRIME64_1 + PRIME64_4;
+}
+
+//------------------------------------------------------------------------------
+
+static inline void hash_stripe (hash_t* acc, const unsigned char* stripe, const hash_t* keys)
+{
+#ifdef HASH_SSE2
+    for (size_t lane = 0; lane < LANES_NUM; lane += 2)
+    {
+        __m128i data  = _mm_loadu_si128((const __m128i*)(stripe + lane * HASH_SIZE));
+        __m128i key   = _mm_loadu_si128((const __m128i*)(keys + lane));
+        __m128i mixed = _mm_xor_si128(data, key);
+
+        __m128i product = _mm_mul_epu32(mixed, _mm_shuffle_epi32(mixed, _MM_SHUFFLE(2, 3, 0, 1)));
+        __m128i swapped = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+
+        __m128i* place = (__m128i*)(acc + lane);
+        _mm_storeu_si128(place, _mm_add_epi64(_mm_loadu_si128(place), _mm_add_epi64(product, swapped)));
+    }
+#else
+    for (size_t lane = 0; lane < LANES_NUM; ++lane)
+    {
+        hash_t data  = hash_read(stripe + lane * HASH_SIZE);
+        hash_t mixed = data ^ keys[lane];
+
+        acc[lane ^ 1] += data;
+        acc[lane]     += (mixed & 0xFFFFFFFFULL) * (mixed >> 32);
+    }
+#endif // HASH_SSE2
+}
+
+//------------------------------------------------------------------------------
+
+static inline void hash_scramble (hash_t* acc)
+{
+#ifdef HASH_SSE2
+    __m128i prime = _mm_set1_epi32((int)PRIME32_1);
+
+    for (size_t lane = 0; lane < LANES_NUM; lane += 2)
+    {
+        __m128i* place = (__m128i*)(acc + lane);
+
+        __m128i value = _mm_loadu_si128(place);
+        value = _mm_xor_si128(value, _mm_srli_epi64(value, 47));
+        value = _mm_xor_si128(value, _mm_loadu_si128((const __m128i*)(StripeKeys + STRIPES_PER_ROUND + lane)));
+
+        __m128i low  = _mm_mul_epu32(value, prime);
+        __m128i high = _mm_mul_epu32(_mm_srli_epi64(value, 32), prime);
+
+        _mm_storeu_si128(place, _mm_add_epi64(low, _mm_slli_epi64(high, 32)));
+    }
+#else
+    for (size_t lane = 0; lane < LANES_NUM; ++lane)
+    {
+        hash_t value = acc[lane];
+        value ^= value >> 47;
+        value ^= StripeKeys[STRIPES_PER_ROUND + lane];
+
+        acc[lane] = value * PRIME32_1;
+    }
+#endif // HASH_SSE2
+}
+
+//------------------------------------------------------------------------------
+
+static inline hash_t hash_tail (hash_t hsh, const unsigned char* bytes, size_t size)
+{
+    for (; size >= HASH_SIZE; size -= HASH_SIZE, bytes += HASH_SIZE)
+        hsh = hash_round(hsh, hash_read(bytes));
+
+    if (size >= 4)
+    {
+        uint32_t first = 0;
+        uint32_t last  = 0;
+        memcpy(&first, bytes,            sizeof(first));
+        memcpy(&last,  bytes + size - 4, sizeof(last));
+
+        hsh = hash_round(hsh, (first | ((hash_t)last << 32)) ^ ((hash_t)size << 61));
+    }
+    else if (size > 0)
+    {
+        hash_t word = bytes[0] | ((hash_t)bytes[size / 2] << 8) | ((hash_t)bytes[size - 1] << 16);
+
+        hsh = hash_round(hsh, word ^ ((hash_t)size << 61));
+    }
+
+    return hsh;
+}
+
+//------------------------------------------------------------------------------
+
+static inline hash_t hash_long (const unsigned char* bytes, size_t size)
+{
+    hash_t acc[LANES_NUM] =
+    {
+        PRIME32_1, PRIME64_1, PRIME64_2, PRIME64_3,
+        PRIME64_4, PRIME64_5, 0x85EBCA77ULL, 0xC2B2AE3DULL,
+    };
+
+    size_t stripes = (size - 1) / BLOCK_SIZE;
+
+    for (size_t stripe = 0; stripe < stripes; ++stripe)
+    {
+        hash_stripe(acc, bytes + stripe * BLOCK_SIZE, StripeKeys + stripe % STRIPES_PER_ROUND);
+
+        if (stripe % STRIPES_PER_ROUND == STRIPES_PER_ROUND - 1) hash_scramble(acc);
+    }
+
+    hash_stripe(acc, bytes + size - BLOCK_SIZE, StripeKeys + STRIPES_PER_ROUND - 1);
+
+    hash_t hsh = size * PRIME64_1;
+
+    for (size_t lane = 0; lane < LANES_NUM; ++lane)
+        hsh = hash_round(hsh, hash_mix(acc[lane] ^ StripeKeys[lane]));
+
+    return hsh;
+}
 
 //------------------------------------------------------------------------------
 
@@ -20,107 +206,92 @@ int bit_rotate (void* buf, size_t size, int dir)
     if ((size == 0) || (dir == 0))
         return 0;
 
-    char* carry_bits = (char*)calloc(size, 1);
-    if (carry_bits == nullptr)
-        return 0;
+    size_t bits  = size * 8;
+    size_t shift = (dir > 0) ? (size_t)dir % bits : bits - (size_t)(-(long long)dir) % bits;
 
-    if (dir > 0)
-    {
-        dir = dir % (size * 8);
-        for (int i = 0; i < dir; ++i)
-        {
-            for (int byte_i = 0; byte_i < size; ++byte_i)
-            {
-                carry_bits[byte_i] = *((char*)buf + byte_i) & 1;
-            }
-
-            for (int byte_i = 0; byte_i < size - 1; ++byte_i)
-            {
-                char byte = *((char*)buf + byte_i);
-                byte = byte >> 1;
-                byte = (byte & 127) | (128 * carry_bits[byte_i + 1]);
-
-                ((char*)buf)[byte_i] = byte;
-            }
-
-            char byte = *((char*)buf + size - 1);
-            byte = byte >> 1;
-            byte = (byte & 127) | (128 * carry_bits[0]);
-
-            ((char*)buf)[size - 1] = byte;
-        }
-    }
-    else
+    shift %= bits;
+    if (shift == 0)
+        return 1;
+
+    unsigned char* bytes = (unsigned char*)buf;
+
+#if defined (__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    if (size == HASH_SIZE)
     {
-        dir = -dir % (size * 8);
-
-        for (int i = 0; i < dir; ++i)
-        {
-            for (int byte_i = 0; byte_i < size; ++byte_i)
-            {
-                carry_bits[byte_i] = *((char*)buf + byte_i) & 128;
-            }
-
-            for (int byte_i = size - 1; byte_i > 0; --byte_i)
-            {
-                char byte = *((char*)buf + byte_i);
-                byte = byte << 1;
-                byte = (byte & 254) | (carry_bits[byte_i - 1] / 128);
-
-                ((char*)buf)[byte_i] = byte;
-            }
-
-            char byte = *((char*)buf);
-            byte = byte << 1;
-            byte = (byte & 254) | (carry_bits[size - 1] / 128);
-
-            ((char*)buf)[0] = byte;
-        }
+        hash_t word = hash_read(bytes);
+        word = (word >> shift) | (word << (64 - shift));
+
+        memcpy(bytes, &word, HASH_SIZE);
+
+        return 1;
     }
+#endif // __BYTE_ORDER__
+
+    std::rotate(bytes, bytes + shift / 8, bytes + size);
+
+    int bit_shift = (int)(shift % 8);
+    if (bit_shift == 0)
+        return 1;
+
+    unsigned char first = bytes[0];
+
+    for (size_t byte_i = 0; byte_i < size - 1; ++byte_i)
+        bytes[byte_i] = (unsigned char)((bytes[byte_i] >> bit_shift) | (bytes[byte_i + 1] << (8 - bit_shift)));
 
-    free(carry_bits);
+    bytes[size - 1] = (unsigned char)((bytes[size - 1] >> bit_shift) | (first << (8 - bit_shift)));
 
     return 1;
 }
 
 //------------------------------------------------------------------------------
 
-hash_t hash (void* buf, size_t size)
+hash_t hash (const void* buf, size_t size)
 {
     assert(buf != nullptr);
 
-    size_t main_size = (size / BLOCK_SIZE) * BLOCK_SIZE + BLOCK_SIZE;
-    size_t half_size = main_size / 2;
+    const unsigned char* bytes = (const unsigned char*)buf;
 
-    char* buf_main = (char*)calloc(main_size, 1);
-    if (buf_main == nullptr)
-        return 0;
+    hash_t hsh = 0;
+
+    if (size <= BLOCK_SIZE)
+        hsh = hash_tail(size * PRIME64_1 ^ StripeKeys[size % LANES_NUM], bytes, size);
+    else
+        hsh = hash_long(bytes, size);
 
-    memcpy(buf_main, buf, size);
-    hash_t hsh = (hash_t)(Keys[size % KEYS_NUM]);
+    hsh ^= hsh >> 33;
+    hsh *= PRIME64_2;
+    hsh ^= hsh >> 29;
+    hsh *= PRIME64_3;
+    hsh ^= hsh >> 32;
 
-    for (size_t byte_i = 0; byte_i < half_size; ++byte_i)
-    {
-        char b1 = *((char*)buf_main + byte_i);
-        char b2 = *((char*)buf_main + byte_i + half_size);
+    return hsh;
+}
+
+//------------------------------------------------------------------------------
 
-        char p1 = b1;
-        char p2 = b2;
+hash_t hash_at (size_t pos, const void* buf, size_t size)
+{
+    assert(buf != nullptr);
 
-        bit_rotate(&p1, 1, 1 + byte_i);
-        bit_rotate(&p2, 1, 1 - byte_i);
+    const char* bytes = (const char*)buf;
 
-        int q1 = b2 ^ p1 ^ Keys[ byte_i      % KEYS_NUM] + b1;
-        int q2 = b1 ^ p2 ^ Keys[(byte_i + 1) % KEYS_NUM] + b2;
+    hash_t hsh = hash_mix((hash_t)pos * 0x9E3779B97F4A7C15ULL + Keys[pos % KEYS_NUM] + size);
 
-        char d1 = *((char*)buf_main - 1 - byte_i + main_size);
-        char d2 = *((char*)buf_main - 1 - byte_i + half_size);
+    for (; size >= HASH_SIZE; size -= HASH_SIZE, bytes += HASH_SIZE)
+    {
+        hash_t word = 0;
+        memcpy(&word, bytes, HASH_SIZE);
 
-        hsh = hsh * (q1*d2 + q2*d1) + hsh ^ (q1*d1 + q2*d2) + q1 + q2 + b1 + b2;
+        hsh = hash_mix(hsh ^ word);
+    }
+
+    if (size > 0)
+    {
+        hash_t word = 0;
+        memcpy(&word, bytes, size);
 
-        bit_rotate(&hsh, sizeof(hsh), 3);
+        hsh = hash_mix(hsh ^ word ^ ((hash_t)size << 56));
     }
-    free(buf_main);
 
     return hsh;
 }
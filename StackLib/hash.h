@@ -48,21 +48,38 @@ static const size_t Keys[KEYS_NUM] =
  *  @param   size Size of memory for turning round
  *  @param   dir  Direction of turning, if >0 - right, if <0 - left
  * 
- *  @return 0 if error, 1 if ok
+ *  @return 0 if size or dir is 0, else 1
+ *
+ *  @note    The memory is turned as a number in little endian byte order.
  */
 
 int bit_rotate (void* buf, size_t size, int dir);
 
 //------------------------------------------------------------------------------
-/*! @brief   Hash counting.
+/*! @brief   Hash counting. The memory is read by 8 bytes words, big blocks
+ *           by 64 bytes stripes (with SSE2 if it is there and HASH_NO_SIMD is
+ *           not defined, the hash is the same).
  *
  *  @param   buf  Start of memory to be hashable
  *  @param   size Size of memory to be hashable
  *
- *  @return  0 if error, else hash
+ *  @return  hash
+ */
+
+hash_t hash (const void* buf, size_t size);
+
+//------------------------------------------------------------------------------
+/*! @brief   Hash of a value at a position. Hashes of different positions are
+ *           combined by xor, so a changed value updates the sum in O(1).
+ *
+ *  @param   pos  Position of the value
+ *  @param   buf  Start of the value
+ *  @param   size Size of the value
+ *
+ *  @return  hash
  */
 
-hash_t hash (void* buf, size_t size);
+hash_t hash_at (size_t pos, const void* buf, size_t size);
 
 //------------------------------------------------------------------------------
 
@@ -9,6 +9,40 @@
     *///------------------------------------------------------------------------
 
 #include "StringLib.h"
+#include <thread>
+
+//------------------------------------------------------------------------------
+/*! @brief   Skip leading spaces of the line (but not the newline).
+ *
+ *  @param   text        Start of the line
+ *  @param   end         End of the text
+ *
+ *  @return  pointer to the first non-space character or end
+ */
+
+static char* SkipSpaces (char* text, char* end)
+{
+#if defined (__SSE2__)
+    const __m128i space = _mm_set1_epi8(' ');
+
+    while (end - text >= 16)
+    {
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)text), space));
+        if (mask != 0xFFFF)
+        {
+            text += __builtin_ctz(~mask);
+            break;
+        }
+
+        text += 16;
+    }
+#endif // __SSE2__
+
+    while ((text < end) && isspace(*text) && (*text != '\n'))
+        ++text;
+
+    return text;
+}
 
 //------------------------------------------------------------------------------
 
@@ -16,7 +50,11 @@ Text::Text () : state_ (STR_TEXT_NOT_CONSTRUCTED) {}
 
 //------------------------------------------------------------------------------
 
-Text::Text (const char* filename) :
+Text::Text (const char* filename) : Text (filename, 1) {}
+
+//------------------------------------------------------------------------------
+
+Text::Text (const char* filename, size_t threads) :
     state_ (STR_OK)
 {
     STR_ASSERTOK((filename == nullptr), STR_NULL_INPUT_TEXT_FILE_NAME);
@@ -32,14 +70,12 @@ Text::Text (const char* filename) :
     size_ = CountSize(fp);
     STR_ASSERTOK((size_ == 0), STR_NO_SYMB);
 
-    text_ = GetText(fp, size_);
+    text_ = MapFile(fp, size_, mapped_, true);
     STR_ASSERTOK((text_ == nullptr), STR_NO_MEMORY);
 
-    num_ = GetLineNum(text_, size_);
-    STR_ASSERTOK((num_ == 0), STR_NO_LINES);
-
-    lines_ = GetLine(text_, num_);
+    lines_ = SplitLines(text_, size_, num_, threads);
     STR_ASSERTOK((lines_ == nullptr), STR_NO_MEMORY);
+    STR_ASSERTOK((num_ == 0), STR_NO_LINES);
 
     fclose(fp);
 }
@@ -83,7 +119,7 @@ Text::~Text ()
         if (size_ != 0)
         {
             assert(text_ != nullptr);
-            free(text_);
+            UnmapFile(text_, size_, mapped_);
             text_ = nullptr;
             size_ = 0;
         }
@@ -124,6 +160,22 @@ int Text::Expand (size_t line_len)
 
 //------------------------------------------------------------------------------
 
+Line Text::getLine (size_t n)
+{
+    if (n >= num_) return {};
+
+    return lines_[n];
+}
+
+//------------------------------------------------------------------------------
+
+size_t Text::getLinesNum ()
+{
+    return num_;
+}
+
+//------------------------------------------------------------------------------
+
 BinCode::BinCode () : state_ (STR_BINCODE_NOT_CONSTRUCTED) {}
 
 //------------------------------------------------------------------------------
@@ -211,6 +263,613 @@ int BinCode::Expand ()
 
 //------------------------------------------------------------------------------
 
+MappedFile::MappedFile () : state_ (STR_MAPPED_NOT_CONSTRUCTED) {}
+
+//------------------------------------------------------------------------------
+
+MappedFile::MappedFile (const char* filename) :
+    state_ (STR_OK)
+{
+    STR_ASSERTOK((filename == nullptr), STR_NULL_INPUT_MAPPED_FILENAME);
+
+    FILE* fp = nullptr;
+    if ((fp = fopen(filename, "rb")) == NULL)
+    {
+        printf("\n ERROR. Input file \"%s\" is not found\n", filename);
+
+        return;
+    }
+
+    size_ = CountSize(fp);
+    if (size_ == 0)
+    {
+        fclose(fp);
+        return;
+    }
+
+    data_ = MapFile(fp, size_, mapped_, false);
+    STR_ASSERTOK((data_ == nullptr), STR_NO_MEMORY);
+
+    fclose(fp);
+}
+
+//------------------------------------------------------------------------------
+
+MappedFile::~MappedFile ()
+{
+    if ((state_ != STR_MAPPED_DESTRUCTED) && (state_ != STR_MAPPED_NOT_CONSTRUCTED))
+    {
+        if (data_ != nullptr) UnmapFile(data_, size_, mapped_);
+
+        data_   = nullptr;
+        size_   = 0;
+        mapped_ = false;
+
+        state_ = STR_MAPPED_DESTRUCTED;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+LineReader::LineReader () : state_ (STR_READER_NOT_CONSTRUCTED) {}
+
+//------------------------------------------------------------------------------
+
+LineReader::LineReader (const char* filename) :
+    state_ (STR_OK)
+{
+    STR_ASSERTOK((filename == nullptr), STR_NULL_INPUT_READER_FILENAME);
+
+    if ((fp_ = fopen(filename, "r")) == NULL)
+    {
+        printf("\n ERROR. Input file \"%s\" is not found\n", filename);
+
+        eof_  = true;
+        done_ = true;
+        return;
+    }
+
+    own_ = true;
+
+    capacity_ = LINE_READER_CHUNK;
+    buffer_ = (char*)malloc(capacity_);
+    STR_ASSERTOK((buffer_ == nullptr), STR_NO_MEMORY);
+}
+
+//------------------------------------------------------------------------------
+
+LineReader::LineReader (FILE* fp) :
+    state_ (STR_OK),
+    fp_    (fp)
+{
+    STR_ASSERTOK((fp == nullptr), STR_NULL_INPUT_READER_FILE);
+
+    capacity_ = LINE_READER_CHUNK;
+    buffer_ = (char*)malloc(capacity_);
+    STR_ASSERTOK((buffer_ == nullptr), STR_NO_MEMORY);
+}
+
+//------------------------------------------------------------------------------
+
+LineReader::LineReader (int fd) :
+    state_ (STR_OK),
+    fd_    (fd)
+{
+    STR_ASSERTOK((fd < 0), STR_NULL_INPUT_READER_FILE);
+
+    capacity_ = LINE_READER_CHUNK;
+    buffer_ = (char*)malloc(capacity_);
+    STR_ASSERTOK((buffer_ == nullptr), STR_NO_MEMORY);
+}
+
+//------------------------------------------------------------------------------
+
+LineReader::~LineReader ()
+{
+    if ((state_ != STR_READER_DESTRUCTED) && (state_ != STR_READER_NOT_CONSTRUCTED))
+    {
+        if (own_ && (fp_ != nullptr)) fclose(fp_);
+        free(buffer_);
+
+        fp_     = nullptr;
+        fd_     = -1;
+        buffer_ = nullptr;
+
+        state_ = STR_READER_DESTRUCTED;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+Line LineReader::getLine (size_t n)
+{
+    while ((n >= num_) && (ReadLine() == 0));
+
+    if ((n >= num_) || (n < first_) || (n + LINE_READER_HISTORY < num_)) return {};
+
+    size_t slot = n % LINE_READER_HISTORY;
+
+    return { buffer_ + starts_[slot], lens_[slot] };
+}
+
+//------------------------------------------------------------------------------
+
+size_t LineReader::getLinesNum ()
+{
+    while (ReadLine() == 0);
+
+    return num_;
+}
+
+//------------------------------------------------------------------------------
+
+int LineReader::ReadLine ()
+{
+    if (done_) return 1;
+
+    while (true)
+    {
+        pos_ = SkipSpaces(buffer_ + pos_, buffer_ + end_) - buffer_;
+        if ((pos_ < end_) || eof_) break;
+
+        Fill();
+    }
+
+    size_t scan = pos_;
+    char*  nl   = nullptr;
+
+    while ((nl = (char*)memchr(buffer_ + scan, '\n', end_ - scan)) == nullptr)
+    {
+        if (eof_) break;
+
+        scan = end_ - pos_;
+        Fill();
+        scan += pos_;
+    }
+
+    size_t slot = num_ % LINE_READER_HISTORY;
+    starts_[slot] = pos_;
+
+    if (nl == nullptr)
+    {
+        buffer_[end_] = '\0';
+        lens_[slot] = end_ - pos_;
+
+        pos_  = end_;
+        done_ = true;
+    }
+    else
+    {
+        *nl = '\0';
+        lens_[slot] = nl - (buffer_ + pos_);
+
+        pos_ = nl - buffer_ + 1;
+    }
+
+    ++num_;
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+void LineReader::Fill ()
+{
+    size_t keep = pos_;
+    size_t line = (num_ + 1 > LINE_READER_HISTORY) ? num_ + 1 - LINE_READER_HISTORY : 0;
+
+    if (line < first_) line = first_;
+    if (line < num_) keep = starts_[line % LINE_READER_HISTORY];
+
+    if ((keep > 0) && (end_ + 1 + LINE_READER_CHUNK / 2 > capacity_))
+    {
+        memmove(buffer_, buffer_ + keep, end_ - keep);
+
+        for (size_t i = 0; i < LINE_READER_HISTORY; ++i)
+            starts_[i] = (starts_[i] >= keep) ? starts_[i] - keep : 0;
+
+        pos_  -= keep;
+        end_  -= keep;
+        first_ = line;
+    }
+
+    if (end_ + 1 == capacity_)
+    {
+        capacity_ *= 2;
+
+        char* temp = (char*)realloc(buffer_, capacity_);
+        STR_ASSERTOK((temp == nullptr), STR_NO_MEMORY);
+
+        buffer_ = temp;
+    }
+
+    size_t room = capacity_ - 1 - end_;
+    if (room > LINE_READER_CHUNK) room = LINE_READER_CHUNK;
+
+    long got = 0;
+    if (fp_ != nullptr)
+        got = fread(buffer_ + end_, 1, room, fp_);
+    else
+#if !defined (_WIN32)
+        got = read(fd_, buffer_ + end_, room);
+#else
+        got = _read(fd_, buffer_ + end_, (unsigned)room);
+#endif // _WIN32
+
+    if (got <= 0)
+        eof_ = true;
+    else
+        end_ += got;
+}
+
+//------------------------------------------------------------------------------
+
+TextWriter::TextWriter () : state_ (STR_WRITER_NOT_CONSTRUCTED) {}
+
+//------------------------------------------------------------------------------
+
+TextWriter::TextWriter (const char* filename) :
+    state_ (STR_OK)
+{
+    STR_ASSERTOK((filename == nullptr), STR_NULL_INPUT_WRITER_FILENAME);
+
+    buffer_ = (char*)malloc(TEXT_WRITER_BUFFER);
+    STR_ASSERTOK((buffer_ == nullptr), STR_NO_MEMORY);
+
+    if ((fp_ = fopen(filename, "w")) == NULL)
+    {
+        printf("\n ERROR. Output file \"%s\" can not be opened\n", filename);
+
+        failed_ = true;
+        return;
+    }
+
+    own_ = true;
+
+#if !defined (_WIN32)
+    fd_ = fileno(fp_);
+#endif // _WIN32
+}
+
+//------------------------------------------------------------------------------
+
+TextWriter::TextWriter (FILE* fp) :
+    state_ (STR_OK),
+    fp_    (fp)
+{
+    STR_ASSERTOK((fp == nullptr), STR_NULL_INPUT_WRITER_FILE);
+
+    buffer_ = (char*)malloc(TEXT_WRITER_BUFFER);
+    STR_ASSERTOK((buffer_ == nullptr), STR_NO_MEMORY);
+}
+
+//------------------------------------------------------------------------------
+
+TextWriter::TextWriter (int fd) :
+    state_ (STR_OK),
+    fd_    (fd)
+{
+    STR_ASSERTOK((fd < 0), STR_NULL_INPUT_WRITER_FILE);
+
+    buffer_ = (char*)malloc(TEXT_WRITER_BUFFER);
+    STR_ASSERTOK((buffer_ == nullptr), STR_NO_MEMORY);
+}
+
+//------------------------------------------------------------------------------
+
+TextWriter::~TextWriter ()
+{
+    if ((state_ != STR_WRITER_DESTRUCTED) && (state_ != STR_WRITER_NOT_CONSTRUCTED))
+    {
+        Flush();
+
+        if (own_ && (fp_ != nullptr)) fclose(fp_);
+        free(buffer_);
+
+        fp_     = nullptr;
+        fd_     = -1;
+        buffer_ = nullptr;
+
+        state_ = STR_WRITER_DESTRUCTED;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void TextWriter::Put (const char* str, size_t len)
+{
+    if (used_ + len <= TEXT_WRITER_BUFFER)
+    {
+        memcpy(buffer_ + used_, str, len);
+        used_ += len;
+    }
+    else if (len >= TEXT_WRITER_BUFFER / 2)
+        Send(str, len);
+    else
+    {
+        Send(nullptr, 0);
+
+        memcpy(buffer_, str, len);
+        used_ = len;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void TextWriter::Put (const char* str)
+{
+    if (str == nullptr) str = "(null)";
+
+    Put(str, strlen(str));
+}
+
+//------------------------------------------------------------------------------
+
+void TextWriter::Put (char c)
+{
+    if (used_ == TEXT_WRITER_BUFFER) Send(nullptr, 0);
+
+    buffer_[used_++] = c;
+}
+
+//------------------------------------------------------------------------------
+
+void TextWriter::Fill (char c, size_t n)
+{
+    while (used_ + n > TEXT_WRITER_BUFFER)
+    {
+        size_t part = TEXT_WRITER_BUFFER - used_;
+
+        memset(buffer_ + used_, c, part);
+        used_ += part;
+        n     -= part;
+
+        Send(nullptr, 0);
+    }
+
+    memset(buffer_ + used_, c, n);
+    used_ += n;
+}
+
+//------------------------------------------------------------------------------
+
+void TextWriter::PutInt (long long value)
+{
+    if (value < 0)
+    {
+        Put('-');
+        PutUInt(0ULL - (unsigned long long)value);
+    }
+    else PutUInt(value);
+}
+
+//------------------------------------------------------------------------------
+
+void TextWriter::PutUInt (unsigned long long value)
+{
+    char  digits[24];
+    char* cur = digits + sizeof(digits);
+
+    do
+    {
+        *--cur = '0' + value % 10;
+        value /= 10;
+    }
+    while (value != 0);
+
+    Put(cur, digits + sizeof(digits) - cur);
+}
+
+//------------------------------------------------------------------------------
+
+void TextWriter::PutPtr (const void* ptr)
+{
+    char  digits[2 + 2 * sizeof(void*)];
+    char* cur = digits + sizeof(digits);
+
+    uintptr_t value = (uintptr_t)ptr;
+
+    do
+    {
+        *--cur = "0123456789abcdef"[value & 0xF];
+        value >>= 4;
+    }
+    while (value != 0);
+
+    *--cur = 'x';
+    *--cur = '0';
+
+    Put(cur, digits + sizeof(digits) - cur);
+}
+
+//------------------------------------------------------------------------------
+
+void TextWriter::PutCp1251 (const char* str, size_t len)
+{
+    static const uint16_t high[64] =
+    {
+        0x0402, 0x0403, 0x201A, 0x0453, 0x201E, 0x2026, 0x2020, 0x2021,
+        0x20AC, 0x2030, 0x0409, 0x2039, 0x040A, 0x040C, 0x040B, 0x040F,
+        0x0452, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+        0xFFFD, 0x2122, 0x0459, 0x203A, 0x045A, 0x045C, 0x045B, 0x045F,
+        0x00A0, 0x040E, 0x045E, 0x0408, 0x00A4, 0x0490, 0x00A6, 0x00A7,
+        0x0401, 0x00A9, 0x0404, 0x00AB, 0x00AC, 0x00AD, 0x00AE, 0x0407,
+        0x00B0, 0x00B1, 0x0406, 0x0456, 0x0491, 0x00B5, 0x00B6, 0x00B7,
+        0x0451, 0x2116, 0x0454, 0x00BB, 0x0458, 0x0405, 0x0455, 0x0457,
+    };
+
+    const size_t max_part = TEXT_WRITER_BUFFER / 3;
+
+    while (len > 0)
+    {
+        size_t part = (len < max_part) ? len : max_part;
+        if (used_ + part * 3 > TEXT_WRITER_BUFFER) Send(nullptr, 0);
+
+        char* out = buffer_ + used_;
+
+        for (size_t i = 0; i < part; ++i)
+        {
+            unsigned char c = str[i];
+
+            if (c < 0x80)
+            {
+                *out++ = c;
+                continue;
+            }
+
+            unsigned code = (c >= 0xC0) ? c + 0x350 : high[c - 0x80];
+
+            if (code < 0x800)
+            {
+                *out++ = (char)(0xC0 | (code >> 6));
+            }
+            else
+            {
+                *out++ = (char)(0xE0 | (code >> 12));
+                *out++ = (char)(0x80 | ((code >> 6) & 0x3F));
+            }
+
+            *out++ = (char)(0x80 | (code & 0x3F));
+        }
+
+        used_ = out - buffer_;
+        str  += part;
+        len  -= part;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void TextWriter::PutCp1251 (const char* str)
+{
+    if (str == nullptr) str = "(null)";
+
+    PutCp1251(str, strlen(str));
+}
+
+//------------------------------------------------------------------------------
+
+void TextWriter::Print (const char* format, ...)
+{
+    assert(format != nullptr);
+
+    va_list args;
+
+    for (int attempt = 0; attempt < 2; ++attempt)
+    {
+        size_t room = TEXT_WRITER_BUFFER - used_;
+
+        va_start(args, format);
+        int len = vsnprintf(buffer_ + used_, room, format, args);
+        va_end(args);
+
+        if (len < 0) return;
+
+        if ((size_t)len < room)
+        {
+            used_ += len;
+            return;
+        }
+
+        Send(nullptr, 0);
+
+        if ((size_t)len >= TEXT_WRITER_BUFFER)
+        {
+            char* temp = (char*)malloc(len + 1);
+            STR_ASSERTOK((temp == nullptr), STR_NO_MEMORY);
+
+            va_start(args, format);
+            vsnprintf(temp, len + 1, format, args);
+            va_end(args);
+
+            Send(temp, len);
+            free(temp);
+            return;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+
+int TextWriter::Flush ()
+{
+    if ((state_ == STR_WRITER_DESTRUCTED) || (state_ == STR_WRITER_NOT_CONSTRUCTED)) return state_;
+
+    Send(nullptr, 0);
+
+    if ((fd_ < 0) && (fp_ != nullptr) && (fflush(fp_) != 0)) failed_ = true;
+
+    return failed_ ? STR_WRITE_FAILED : STR_OK;
+}
+
+//------------------------------------------------------------------------------
+
+void TextWriter::Send (const char* data, size_t len)
+{
+    size_t buffered = used_;
+    used_ = 0;
+
+    if (failed_ || (buffered + len == 0)) return;
+
+    if (fd_ < 0)
+    {
+        if ((buffered > 0) && (fwrite(buffer_, 1, buffered, fp_) != buffered)) failed_ = true;
+        if ((len > 0) && !failed_ && (fwrite(data, 1, len, fp_) != len))      failed_ = true;
+
+        return;
+    }
+
+#if !defined (_WIN32)
+    struct iovec parts[2] = { { buffer_, buffered }, { (void*)data, len } };
+
+    struct iovec* part = (buffered > 0) ? parts : parts + 1;
+    int           num  = (len > 0) ? (int)(parts + 2 - part) : 1;
+
+    while (num > 0)
+    {
+        ssize_t done = writev(fd_, part, num);
+        if ((done < 0) && (errno == EINTR)) continue;
+        if (done < 0)
+        {
+            failed_ = true;
+            return;
+        }
+
+        while ((num > 0) && ((size_t)done >= part->iov_len))
+        {
+            done -= part->iov_len;
+            ++part;
+            --num;
+        }
+
+        if (num > 0)
+        {
+            part->iov_base = (char*)part->iov_base + done;
+            part->iov_len -= done;
+        }
+    }
+#else
+    const char* chunks[2] = { buffer_, data };
+    size_t      sizes [2] = { buffered, len };
+
+    for (int i = 0; i < 2; ++i)
+        while (sizes[i] > 0)
+        {
+            int done = _write(fd_, chunks[i], (unsigned)sizes[i]);
+            if (done <= 0)
+            {
+                failed_ = true;
+                return;
+            }
+
+            chunks[i] += done;
+            sizes[i]  -= done;
+        }
+#endif // _WIN32
+}
+
+//------------------------------------------------------------------------------
+
 char* GetFileName (int argc, char** argv)
 {
     assert(argc);
@@ -279,6 +938,50 @@ char* GetText (FILE* fp, size_t len)
 
 //------------------------------------------------------------------------------
 
+char* MapFile (FILE* fp, size_t len, bool& mapped, bool terminated)
+{
+    assert(fp != nullptr);
+    assert(len);
+
+    mapped = false;
+
+#if !defined (_WIN32)
+    size_t page = sysconf(_SC_PAGESIZE);
+
+    if ((not terminated) || (len % page != 0))
+    {
+        void* map = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno(fp), 0);
+
+        if (map != MAP_FAILED)
+        {
+            madvise(map, len, MADV_SEQUENTIAL | MADV_WILLNEED);
+
+            mapped = true;
+            return (char*)map;
+        }
+    }
+#endif // _WIN32
+
+    return GetText(fp, len);
+}
+
+//------------------------------------------------------------------------------
+
+void UnmapFile (char* data, size_t len, bool mapped)
+{
+#if !defined (_WIN32)
+    if (mapped)
+    {
+        munmap(data, len);
+        return;
+    }
+#endif // _WIN32
+
+    free(data);
+}
+
+//------------------------------------------------------------------------------
+
 size_t GetLineNum (char* text, size_t len)
 {
     assert(text != nullptr);
@@ -335,6 +1038,158 @@ Line* GetLine (char* text, size_t num)
 
 //------------------------------------------------------------------------------
 
+//------------------------------------------------------------------------------
+/*! @brief   Split a part of the text to lines.
+ *
+ *  @param   text        Start of the part
+ *  @param   end         End of the part
+ *  @param   last        The part is the end of the text, otherwise it ends
+ *                       with a newline and no empty line is added after it
+ *  @param   num         Number of lines
+ *
+ *  @return  array of lines (two empty lines more than num)
+ */
+
+static Line* SplitRange (char* text, char* end, bool last, size_t& num)
+{
+    assert(text != nullptr);
+    assert(end >= text);
+
+    size_t capacity = (end - text) / 32 + 16;
+
+    Line* lines = (Line*)malloc(capacity * sizeof(Line));
+    if (lines == nullptr)
+        return nullptr;
+
+    num = 0;
+
+    while (last || (text < end))
+    {
+        text = SkipSpaces(text, end);
+
+        char* nl = (char*)memchr(text, '\n', end - text);
+
+        if (num + 2 >= capacity)
+        {
+            capacity *= 2;
+
+            Line* temp = (Line*)realloc(lines, capacity * sizeof(Line));
+            if (temp == nullptr)
+            {
+                free(lines);
+                return nullptr;
+            }
+
+            lines = temp;
+        }
+
+        lines[num].str = text;
+
+        if (nl == nullptr)
+        {
+            lines[num++].len = end - text;
+            break;
+        }
+
+        *nl = '\0';
+        lines[num++].len = nl - text;
+
+        text = nl + 1;
+    }
+
+    lines[num]     = {};
+    lines[num + 1] = {};
+
+    return lines;
+}
+
+//------------------------------------------------------------------------------
+
+Line* SplitLines (char* text, size_t len, size_t& num)
+{
+    assert(text != nullptr);
+    assert(len);
+
+    return SplitRange(text, text + len, true, num);
+}
+
+//------------------------------------------------------------------------------
+
+Line* SplitLines (char* text, size_t len, size_t& num, size_t threads)
+{
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+
+    if ((threads < 2) || (len < TEXT_PARALLEL_MIN_SIZE))
+        return SplitLines(text, len, num);
+
+    char*   end     = text + len;
+    char**  bounds  = new char*  [threads + 1];
+    Line**  parts   = new Line*  [threads];
+    size_t* nums    = new size_t [threads];
+    size_t* offsets = new size_t [threads];
+
+    bounds[0]       = text;
+    bounds[threads] = end;
+
+    for (size_t i = 1; i < threads; ++i)
+    {
+        char* pos = text + len / threads * i;
+        if (pos < bounds[i - 1]) pos = bounds[i - 1];
+
+        char* nl = (char*)memchr(pos, '\n', end - pos);
+        bounds[i] = (nl == nullptr) ? end : nl + 1;
+    }
+
+    std::thread* workers = new std::thread[threads];
+
+    for (size_t i = 0; i < threads; ++i)
+    {
+        bool last = (bounds[i + 1] == end) && ((i == 0) || (bounds[i] != end));
+
+        workers[i] = std::thread([=] { parts[i] = SplitRange(bounds[i], bounds[i + 1], last, nums[i]); });
+    }
+
+    for (size_t i = 0; i < threads; ++i) workers[i].join();
+
+    Line* lines  = nullptr;
+    bool  failed = false;
+
+    num = 0;
+    for (size_t i = 0; i < threads; ++i)
+    {
+        if (parts[i] == nullptr) failed = true;
+
+        offsets[i] = num;
+        num += (parts[i] == nullptr) ? 0 : nums[i];
+    }
+
+    if (!failed)
+        lines = (Line*)malloc((num + 2) * sizeof(Line));
+
+    if (lines != nullptr)
+    {
+        for (size_t i = 0; i < threads; ++i)
+            workers[i] = std::thread([=] { memcpy(lines + offsets[i], parts[i], nums[i] * sizeof(Line)); });
+
+        for (size_t i = 0; i < threads; ++i) workers[i].join();
+
+        lines[num]     = {};
+        lines[num + 1] = {};
+    }
+
+    for (size_t i = 0; i < threads; ++i) free(parts[i]);
+
+    delete [] workers;
+    delete [] offsets;
+    delete [] nums;
+    delete [] parts;
+    delete [] bounds;
+
+    return lines;
+}
+
+//------------------------------------------------------------------------------
+
 size_t GetWordsNum (Line line)
 {
     assert(line.str != nullptr);
@@ -19,9 +19,24 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <time.h>
 
+#if !defined (_WIN32)
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#else
+#include <io.h>
+#endif // _WIN32
+
+#if defined (__SSE2__)
+#include <emmintrin.h>
+#endif // __SSE2__
+
 
 #if defined (__GNUC__) || defined (__clang__) || defined (__clang_major__)
     #define __FUNC_NAME__   __PRETTY_FUNCTION__
@@ -64,6 +79,18 @@ enum StringErrors
     STR_BINCODE_NOT_CONSTRUCTED                                        ,
     STR_TEXT_DESTRUCTED                                                ,
     STR_TEXT_NOT_CONSTRUCTED                                           ,
+    STR_MAPPED_DESTRUCTED                                              ,
+    STR_MAPPED_NOT_CONSTRUCTED                                         ,
+    STR_NULL_INPUT_MAPPED_FILENAME                                     ,
+    STR_READER_DESTRUCTED                                              ,
+    STR_READER_NOT_CONSTRUCTED                                         ,
+    STR_NULL_INPUT_READER_FILENAME                                     ,
+    STR_NULL_INPUT_READER_FILE                                         ,
+    STR_WRITER_DESTRUCTED                                              ,
+    STR_WRITER_NOT_CONSTRUCTED                                         ,
+    STR_NULL_INPUT_WRITER_FILENAME                                     ,
+    STR_NULL_INPUT_WRITER_FILE                                         ,
+    STR_WRITE_FAILED                                                   ,
 };
 
 char const * const str_errstr[] =
@@ -85,10 +112,29 @@ char const * const str_errstr[] =
     "BinCode did not constructed, operation is impossible"             ,
     "Text has already destructed"                                      ,
     "Text did not constructed, operation is impossible"                ,
+    "MappedFile has already destructed"                                ,
+    "MappedFile did not constructed, operation is impossible"          ,
+    "The input value of the MappedFile filename turned out to be zero" ,
+    "LineReader has already destructed"                                ,
+    "LineReader did not constructed, operation is impossible"          ,
+    "The input value of the LineReader filename turned out to be zero" ,
+    "The input value of the LineReader file turned out to be wrong"    ,
+    "TextWriter has already destructed"                                ,
+    "TextWriter did not constructed, operation is impossible"          ,
+    "The input value of the TextWriter filename turned out to be zero" ,
+    "The input value of the TextWriter file turned out to be wrong"    ,
+    "Failed to write the file"                                         ,
 };
 
 char const * const STRING_LOGNAME = "string.log";
 
+const size_t TEXT_PARALLEL_MIN_SIZE = 1 << 22;
+
+const size_t LINE_READER_CHUNK   = 65536;
+const size_t LINE_READER_HISTORY = 8;
+
+const size_t TEXT_WRITER_BUFFER  = 1 << 20;
+
 #define STR_ASSERTOK(cond, err)  if (cond)                                                                \
                                  {                                                                        \
                                    StrPrintError(STRING_LOGNAME, __FILE__, __LINE__, __FUNC_NAME__, err); \
@@ -121,6 +167,8 @@ public:
    size_t num_   = 0;
    Line*  lines_ = nullptr;
 
+   bool mapped_ = false;
+
 //------------------------------------------------------------------------------
 /*! @brief   Text constructor.
  */
@@ -131,10 +179,22 @@ public:
 /*! @brief   Text constructor from file.
  *
  *  @param   filename    Name of the text file
+ *
+ *  @note    The file is mapped to memory privately where possible, lines are
+ *           terminated in place, only the touched pages are copied.
  */
 
     Text (const char* filename);
 
+//------------------------------------------------------------------------------
+/*! @brief   Text constructor from file, lines are split by several threads.
+ *
+ *  @param   filename    Name of the text file
+ *  @param   threads     Number of threads (0 to use all cores)
+ */
+
+    Text (const char* filename, size_t threads);
+
 //------------------------------------------------------------------------------
 /*! @brief   Text constructor with number of lines and their lengths.
  *
@@ -170,6 +230,24 @@ public:
 
     int Expand (size_t line_len);
 
+//------------------------------------------------------------------------------
+/*! @brief   Get line of the text.
+ *
+ *  @param   n           Number of the line
+ *
+ *  @return  line, empty line structure if there is no such line
+ */
+
+    Line getLine (size_t n);
+
+//------------------------------------------------------------------------------
+/*! @brief   Get number of lines in the text.
+ *
+ *  @return  number of lines
+ */
+
+    size_t getLinesNum ();
+
 //------------------------------------------------------------------------------
 };
 
@@ -234,6 +312,335 @@ int Expand ();
 };
 
 
+class MappedFile
+{
+    int state_;
+
+public:
+
+    char*  data_   = nullptr;
+    size_t size_   = 0;
+    bool   mapped_ = false;
+
+//------------------------------------------------------------------------------
+/*! @brief   MappedFile constructor.
+ */
+
+    MappedFile ();
+
+//------------------------------------------------------------------------------
+/*! @brief   MappedFile constructor from file.
+ *
+ *  @param   filename    Name of the input file
+ *
+ *  @note    The file is mapped to memory privately (changes of the data are
+ *           not written to the file). Where mapping is not available the
+ *           file is read to a buffer. data_ stays nullptr if the file is
+ *           not found or empty.
+ */
+
+    MappedFile (const char* filename);
+
+//------------------------------------------------------------------------------
+/*! @brief   MappedFile copy constructor (deleted).
+ *
+ *  @param   obj         Source MappedFile
+ */
+
+    MappedFile (const MappedFile& obj) = delete;
+
+    MappedFile& operator = (const MappedFile& obj) = delete;
+
+//------------------------------------------------------------------------------
+/*! @brief   MappedFile destructor.
+ */
+
+   ~MappedFile ();
+
+//------------------------------------------------------------------------------
+};
+
+
+class LineReader
+{
+    int state_;
+
+    FILE*  fp_       = nullptr;
+    int    fd_       = -1;
+    bool   own_      = false;
+    bool   eof_      = false;
+    bool   done_     = false;
+
+    char*  buffer_   = nullptr;
+    size_t capacity_ = 0;
+    size_t pos_      = 0;
+    size_t end_      = 0;
+
+    size_t num_      = 0;
+    size_t first_    = 0;
+    size_t starts_ [LINE_READER_HISTORY] = {};
+    size_t lens_   [LINE_READER_HISTORY] = {};
+
+public:
+
+//------------------------------------------------------------------------------
+/*! @brief   LineReader constructor.
+ */
+
+    LineReader ();
+
+//------------------------------------------------------------------------------
+/*! @brief   LineReader constructor from file.
+ *
+ *  @param   filename    Name of the text file
+ */
+
+    LineReader (const char* filename);
+
+//------------------------------------------------------------------------------
+/*! @brief   LineReader constructor from opened file, the file is not closed.
+ *
+ *  @param   fp          Pointer to the file
+ */
+
+    LineReader (FILE* fp);
+
+//------------------------------------------------------------------------------
+/*! @brief   LineReader constructor from file descriptor, it is not closed.
+ *
+ *  @param   fd          File descriptor
+ */
+
+    LineReader (int fd);
+
+//------------------------------------------------------------------------------
+/*! @brief   LineReader copy constructor (deleted).
+ *
+ *  @param   obj         Source LineReader
+ */
+
+    LineReader (const LineReader& obj) = delete;
+
+    LineReader& operator = (const LineReader& obj) = delete;
+
+//------------------------------------------------------------------------------
+/*! @brief   LineReader destructor.
+ */
+
+   ~LineReader ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Get line of the text, the file is read up to it. Lines are split
+ *           the same way as in Text.
+ *
+ *  @param   n           Number of the line
+ *
+ *  @return  line, empty line structure if there is no such line or it is
+ *           older than the last LINE_READER_HISTORY lines
+ *
+ *  @note    The line stays valid until a next line is read.
+ */
+
+    Line getLine (size_t n);
+
+//------------------------------------------------------------------------------
+/*! @brief   Get number of lines in the text, the file is read up to the end.
+ *
+ *  @return  number of lines
+ */
+
+    size_t getLinesNum ();
+
+/*------------------------------------------------------------------------------
+                   Private functions                                           *
+*///----------------------------------------------------------------------------
+
+private:
+
+//------------------------------------------------------------------------------
+/*! @brief   Read the next line.
+ *
+ *  @return  1 if the text is over, else 0
+ */
+
+    int ReadLine ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Read the next chunk of the file. The current line and the last
+ *           lines are moved to the start of the buffer before that.
+ */
+
+    void Fill ();
+
+//------------------------------------------------------------------------------
+};
+
+
+class TextWriter
+{
+    int state_;
+
+    FILE*  fp_     = nullptr;
+    int    fd_     = -1;
+    bool   own_    = false;
+    bool   failed_ = false;
+
+    char*  buffer_ = nullptr;
+    size_t used_   = 0;
+
+public:
+
+//------------------------------------------------------------------------------
+/*! @brief   TextWriter constructor.
+ */
+
+    TextWriter ();
+
+//------------------------------------------------------------------------------
+/*! @brief   TextWriter constructor to file, the file is truncated.
+ *
+ *  @param   filename    Name of the output file
+ */
+
+    TextWriter (const char* filename);
+
+//------------------------------------------------------------------------------
+/*! @brief   TextWriter constructor to opened file, the file is not closed.
+ *
+ *  @param   fp          Pointer to the file
+ */
+
+    TextWriter (FILE* fp);
+
+//------------------------------------------------------------------------------
+/*! @brief   TextWriter constructor to file descriptor, it is not closed.
+ *
+ *  @param   fd          File descriptor
+ */
+
+    TextWriter (int fd);
+
+//------------------------------------------------------------------------------
+/*! @brief   TextWriter copy constructor (deleted).
+ *
+ *  @param   obj         Source TextWriter
+ */
+
+    TextWriter (const TextWriter& obj) = delete;
+
+    TextWriter& operator = (const TextWriter& obj) = delete;
+
+//------------------------------------------------------------------------------
+/*! @brief   TextWriter destructor, the buffer is flushed.
+ */
+
+   ~TextWriter ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Put the string to the output.
+ *
+ *  @param   str         String
+ *  @param   len         Length of the string
+ */
+
+    void Put (const char* str, size_t len);
+
+//------------------------------------------------------------------------------
+/*! @brief   Put the C string to the output, "(null)" for nullptr.
+ *
+ *  @param   str         C string
+ */
+
+    void Put (const char* str);
+
+//------------------------------------------------------------------------------
+/*! @brief   Put the symbol to the output.
+ *
+ *  @param   c           Symbol
+ */
+
+    void Put (char c);
+
+//------------------------------------------------------------------------------
+/*! @brief   Put the symbol to the output several times.
+ *
+ *  @param   c           Symbol
+ *  @param   n           Number of symbols
+ */
+
+    void Fill (char c, size_t n);
+
+//------------------------------------------------------------------------------
+/*! @brief   Put the number to the output in decimal.
+ *
+ *  @param   value       Number
+ */
+
+    void PutInt  (long long value);
+    void PutUInt (unsigned long long value);
+
+//------------------------------------------------------------------------------
+/*! @brief   Put the pointer to the output in hexadecimal.
+ *
+ *  @param   ptr         Pointer
+ */
+
+    void PutPtr (const void* ptr);
+
+//------------------------------------------------------------------------------
+/*! @brief   Put the CP1251 string to the output in UTF-8.
+ *
+ *  @param   str         String
+ *  @param   len         Length of the string
+ */
+
+    void PutCp1251 (const char* str, size_t len);
+
+//------------------------------------------------------------------------------
+/*! @brief   Put the CP1251 C string to the output in UTF-8, "(null)" for
+ *           nullptr.
+ *
+ *  @param   str         C string
+ */
+
+    void PutCp1251 (const char* str);
+
+//------------------------------------------------------------------------------
+/*! @brief   Put the formatted string to the output like printf does.
+ *
+ *  @param   format      Format string
+ */
+
+    void Print (const char* format, ...);
+
+//------------------------------------------------------------------------------
+/*! @brief   Write the buffer to the file.
+ *
+ *  @return  error code
+ */
+
+    int Flush ();
+
+/*------------------------------------------------------------------------------
+                   Private functions                                           *
+*///----------------------------------------------------------------------------
+
+private:
+
+//------------------------------------------------------------------------------
+/*! @brief   Write the buffer and then the data to the file by one call where
+ *           it is possible, the buffer is left empty.
+ *
+ *  @param   data        Data written after the buffer (may be nullptr)
+ *  @param   len         Length of the data
+ */
+
+    void Send (const char* data, size_t len);
+
+//------------------------------------------------------------------------------
+};
+
+
 
 //------------------------------------------------------------------------------
 /*! @brief   Get name of a file from command line.
@@ -277,6 +684,29 @@ size_t CountSize (FILE* fp);
 
 char* GetText (FILE* fp, size_t len);
 
+//------------------------------------------------------------------------------
+/*! @brief   Map the file to memory privately, read it if mapping is not possible.
+ *
+ *  @param   fp          Pointer to the file
+ *  @param   len         Length of the file
+ *  @param   mapped      Set to 1 if the file was mapped, else 0
+ *  @param   terminated  The data has to be followed by '\0'
+ *
+ *  @return  pointer to the data
+ */
+
+char* MapFile (FILE* fp, size_t len, bool& mapped, bool terminated);
+
+//------------------------------------------------------------------------------
+/*! @brief   Release data got from MapFile.
+ *
+ *  @param   data        Pointer to the data
+ *  @param   len         Length of the file
+ *  @param   mapped      The data was mapped
+ */
+
+void UnmapFile (char* data, size_t len, bool mapped);
+
 //------------------------------------------------------------------------------
 /*! @brief   Get number of lines in the text.
  *
@@ -299,6 +729,34 @@ size_t GetLineNum (char* text, size_t len);
 
 Line* GetLine (char* text, size_t num);
 
+//------------------------------------------------------------------------------
+/*! @brief   Count lines and get them in one pass, the same as GetLineNum and
+ *           GetLine together. Leading spaces are skipped and newlines are
+ *           replaced by '\0' in place.
+ *
+ *  @param   text        C string contains text
+ *  @param   len         Length of the text
+ *  @param   num         Number of lines
+ *
+ *  @return  array of lines (two empty lines more than num)
+ */
+
+Line* SplitLines (char* text, size_t len, size_t& num);
+
+//------------------------------------------------------------------------------
+/*! @brief   SplitLines by several threads: the text is cut into parts at
+ *           newlines, the parts are split at the same time and joined.
+ *
+ *  @param   text        C string contains text
+ *  @param   len         Length of the text
+ *  @param   num         Number of lines
+ *  @param   threads     Number of threads (0 to use all cores)
+ *
+ *  @return  array of lines (two empty lines more than num)
+ */
+
+Line* SplitLines (char* text, size_t len, size_t& num, size_t threads);
+
 //------------------------------------------------------------------------------
 /*! @brief   Get number of words in string.
  *
@@ -0,0 +1,175 @@
+/*------------------------------------------------------------------------------
+    * File:        CompactTree.h                                               *
+    * Description: Declaration of the compact index-based tree storage.        *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+#ifndef COMPACTTREE_H_INCLUDED
+#define COMPACTTREE_H_INCLUDED
+
+#define _CRT_SECURE_NO_WARNINGS
+
+
+#include "Tree.h"
+#include <stdint.h>
+
+
+typedef uint32_t link_t;
+
+const link_t NIL_LINK = UINT32_MAX;
+
+#define newCompactTree(NAME, tree, TREE_TYPE) \
+        CompactTree<TREE_TYPE> NAME ((char*)#NAME, tree);
+
+
+template <typename TYPE>
+struct CompactNode
+{
+    TYPE   data_  = POISON<TYPE>;
+
+    link_t left_  = NIL_LINK;
+    link_t right_ = NIL_LINK;
+    link_t prev_  = NIL_LINK;
+    link_t depth_ = 0;
+};
+
+
+template <typename TYPE>
+class CompactTree
+{
+    int errCode_ = 0;
+
+    CompactNode<TYPE>* nodes_ = nullptr;
+    size_t size_     = 0;
+    size_t capacity_ = 0;
+
+    char*  strings_      = nullptr;
+    size_t strings_size_ = 0;
+
+    link_t badnode_ = NIL_LINK;
+
+public:
+
+    char* name_ = nullptr;
+
+//------------------------------------------------------------------------------
+/*! @brief   Compact tree constructor from a linked tree.
+ *
+ *  @param   tree_name   Tree variable name
+ *  @param   tree        Source tree
+ *
+ *  @note    Nodes are stored in pre-order (right child first), the same order
+ *           the base file uses. Strings are copied to one shared buffer.
+ */
+
+    CompactTree (char* tree_name, const Tree<TYPE>& tree);
+
+//------------------------------------------------------------------------------
+/*! @brief   Compact tree destructor.
+ */
+
+   ~CompactTree ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Compact tree copy constructor (deleted).
+ */
+
+    CompactTree (const CompactTree& obj) = delete;
+
+    CompactTree& operator = (const CompactTree& obj) = delete;
+
+//------------------------------------------------------------------------------
+/*! @brief   Get node by index.
+ *
+ *  @param   n           Node index
+ *
+ *  @return  node
+ */
+
+    const CompactNode<TYPE>& operator [] (link_t n) const;
+
+//------------------------------------------------------------------------------
+/*! @brief   Get number of nodes.
+ *
+ *  @return  number of nodes
+ */
+
+    size_t getSize () const;
+
+//------------------------------------------------------------------------------
+/*! @brief   Build a linked tree from the compact one.
+ *
+ *  @param   tree        Destination tree, its nodes are replaced
+ */
+
+    void toTree (Tree<TYPE>& tree);
+
+//------------------------------------------------------------------------------
+/*! @brief   Write the tree data to the base file.
+ *
+ *  @param   basename    Base file name
+ *  @param   compact     Write lines without indentation
+ */
+
+    void Write (const char* basename = DEFAULT_BASE_NAME, bool compact = false);
+
+//------------------------------------------------------------------------------
+/*! @brief   Find path in the tree to the element.
+ *
+ *  @param   path        Path to the element (node indices from the root)
+ *  @param   elem        Data of node
+ *
+ *  @return  1 if found, 0 if not
+ */
+
+    template <size_t INLINE, typename POLICY>
+    bool findPath (Stack<size_t, INLINE, POLICY>& path, TYPE elem);
+
+//------------------------------------------------------------------------------
+/*! @brief   Check tree for problems with one linear pass over the nodes.
+ *
+ *  @return  error code
+ */
+
+    int Check ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Print error explanations to log file and to console.
+ *
+ *  @param   logname     Name of the log file
+ *  @param   file        Name of the file from which this function was called
+ *  @param   line        Line of the code from which this function was called
+ *  @param   function    Name of the function from which this function was called
+ *  @param   err         Error code
+ *  @param   errline     Number of base line with error
+ */
+
+    void PrintError (const char* logname, const char* file, int line, const char* function, int err, int errline);
+
+/*------------------------------------------------------------------------------
+                   Private functions                                           *
+*///----------------------------------------------------------------------------
+
+private:
+
+//------------------------------------------------------------------------------
+/*! @brief   Append node to the array.
+ *
+ *  @param   data        Node data
+ *  @param   prev        Index of the previous node
+ *
+ *  @return  index of the new node
+ */
+
+    link_t Append (const TYPE& data, link_t prev);
+
+//------------------------------------------------------------------------------
+};
+
+#include "CompactTree.ipp"
+
+#endif // COMPACTTREE_H_INCLUDED
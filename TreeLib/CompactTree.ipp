@@ -0,0 +1,361 @@
+/*------------------------------------------------------------------------------
+    * File:        CompactTree.ipp                                             *
+    * Description: Functions of the compact index-based tree storage.          *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+template <typename TYPE>
+CompactTree<TYPE>::CompactTree (char* tree_name, const Tree<TYPE>& tree) :
+    name_    (tree_name),
+    errCode_ (TREE_OK)
+{
+    TREE_ASSERTOK((tree_name == nullptr), TREE_WRONG_INPUT_TREE_NAME, -1);
+
+    if (tree.root_ == nullptr) return;
+
+    struct Frame
+    {
+        Node<TYPE>* node;
+        link_t      prev;
+        bool        right;
+    };
+
+    size_t frames_cap = 64;
+    Frame* frames = (Frame*)calloc(frames_cap, sizeof(Frame));
+    TREE_ASSERTOK((frames == nullptr), TREE_NO_MEMORY, -1);
+
+    size_t nodes_num = 0;
+    frames[0] = { tree.root_, NIL_LINK, false };
+
+    for (size_t top = 1; top > 0; )
+    {
+        Node<TYPE>* node = frames[--top].node;
+        ++nodes_num;
+
+        if constexpr (std::is_same<TYPE, char*>::value)
+            if (node->data_ != nullptr) strings_size_ += strlen(node->data_) + 1;
+
+        if (top + 2 > frames_cap)
+        {
+            frames_cap *= 2;
+            frames = (Frame*)realloc(frames, frames_cap * sizeof(Frame));
+            TREE_ASSERTOK((frames == nullptr), TREE_NO_MEMORY, -1);
+        }
+
+        if (node->left_  != nullptr) frames[top++].node = node->left_;
+        if (node->right_ != nullptr) frames[top++].node = node->right_;
+    }
+
+    TREE_ASSERTOK((nodes_num >= NIL_LINK), TREE_NO_MEMORY, -1);
+
+    capacity_ = nodes_num;
+    nodes_ = (CompactNode<TYPE>*)calloc(capacity_, sizeof(CompactNode<TYPE>));
+    TREE_ASSERTOK((nodes_ == nullptr), TREE_NO_MEMORY, -1);
+
+    if (strings_size_ != 0)
+    {
+        strings_ = (char*)calloc(strings_size_, 1);
+        TREE_ASSERTOK((strings_ == nullptr), TREE_NO_MEMORY, -1);
+    }
+
+    size_t strings_cur = 0;
+    frames[0] = { tree.root_, NIL_LINK, false };
+
+    for (size_t top = 1; top > 0; )
+    {
+        Frame frame = frames[--top];
+        Node<TYPE>* node = frame.node;
+
+        TYPE data = node->data_;
+        if constexpr (std::is_same<TYPE, char*>::value)
+            if (data != nullptr)
+            {
+                size_t len = strlen(data) + 1;
+                memcpy(strings_ + strings_cur, data, len);
+
+                data = strings_ + strings_cur;
+                strings_cur += len;
+            }
+
+        link_t cur = Append(data, frame.prev);
+
+        if (frame.prev != NIL_LINK)
+        {
+            if (frame.right) nodes_[frame.prev].right_ = cur;
+            else             nodes_[frame.prev].left_  = cur;
+        }
+
+        if (top + 2 > frames_cap)
+        {
+            frames_cap *= 2;
+            frames = (Frame*)realloc(frames, frames_cap * sizeof(Frame));
+            TREE_ASSERTOK((frames == nullptr), TREE_NO_MEMORY, -1);
+        }
+
+        if (node->left_  != nullptr) frames[top++] = { node->left_,  cur, false };
+        if (node->right_ != nullptr) frames[top++] = { node->right_, cur, true  };
+    }
+
+    free(frames);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+CompactTree<TYPE>::~CompactTree ()
+{
+    free(nodes_);
+    nodes_ = nullptr;
+
+    free(strings_);
+    strings_ = nullptr;
+
+    size_     = 0;
+    capacity_ = 0;
+
+    errCode_ = TREE_DESTRUCTED;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+link_t CompactTree<TYPE>::Append (const TYPE& data, link_t prev)
+{
+    assert(size_ < capacity_);
+
+    CompactNode<TYPE>& node = nodes_[size_];
+
+    node.data_  = data;
+    node.left_  = NIL_LINK;
+    node.right_ = NIL_LINK;
+    node.prev_  = prev;
+    node.depth_ = (prev == NIL_LINK) ? 0 : nodes_[prev].depth_ + 1;
+
+    return size_++;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+const CompactNode<TYPE>& CompactTree<TYPE>::operator [] (link_t n) const
+{
+    assert(n < size_);
+
+    return nodes_[n];
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+size_t CompactTree<TYPE>::getSize () const
+{
+    return size_;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void CompactTree<TYPE>::toTree (Tree<TYPE>& tree)
+{
+    tree.Clean();
+    if (size_ == 0) return;
+
+    Node<TYPE>** made = (Node<TYPE>**)calloc(size_, sizeof(Node<TYPE>*));
+    TREE_ASSERTOK((made == nullptr), TREE_NO_MEMORY, -1);
+
+    for (size_t i = 0; i < size_; ++i)
+    {
+        const CompactNode<TYPE>& cnode = nodes_[i];
+        Node<TYPE>* node = tree.newNode();
+
+        if constexpr (std::is_same<TYPE, char*>::value)
+        {
+            if (cnode.data_ != nullptr)
+            {
+                node->data_     = tree.strings_.Copy(cnode.data_);
+                node->in_store_ = true;
+            }
+        }
+        else node->data_ = cnode.data_;
+
+        node->depth_ = cnode.depth_;
+
+        if (cnode.prev_ != NIL_LINK)
+        {
+            node->prev_ = made[cnode.prev_];
+
+            if (nodes_[cnode.prev_].right_ == i) node->prev_->right_ = node;
+            else                                 node->prev_->left_  = node;
+        }
+
+        made[i] = node;
+    }
+
+    tree.root_ = made[0];
+
+    free(made);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void CompactTree<TYPE>::Write (const char* basename, bool compact)
+{
+    TREE_ASSERTOK(Check(), errCode_, -1);
+
+    const size_t indent = compact ? 0 : 4;
+
+    TextWriter base(basename);
+
+    base.Put(OPEN_BRACKET);
+    base.Put('\n');
+
+    size_t opened = 0;
+    for (size_t i = 0; i < size_; ++i)
+    {
+        size_t depth = nodes_[i].depth_;
+
+        for (; opened >= depth && opened > 0; --opened)
+        {
+            base.Fill(' ', indent * opened);
+            base.Put("]\n", 2);
+        }
+
+        if (depth > 0)
+        {
+            base.Fill(' ', indent * depth);
+            base.Put("[\n", 2);
+            opened = depth;
+        }
+
+        base.Fill(' ', indent * (depth + 1));
+        TypePrint(base, nodes_[i].data_);
+        base.Put('\n');
+    }
+
+    for (; opened > 0; --opened)
+    {
+        base.Fill(' ', indent * opened);
+        base.Put("]\n", 2);
+    }
+
+    base.Put(CLOSE_BRACKET);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+template <size_t INLINE, typename POLICY>
+bool CompactTree<TYPE>::findPath (Stack<size_t, INLINE, POLICY>& path, TYPE elem)
+{
+    TREE_ASSERTOK(Check(), errCode_, -1);
+
+    TREE_ASSERTOK((isPOISON(elem)), TREE_INPUT_DATA_POISON, -1);
+
+    for (size_t i = 0; i < size_; ++i)
+    {
+        const CompactNode<TYPE>& node = nodes_[i];
+
+        if ((node.left_ != NIL_LINK) || (node.right_ != NIL_LINK)) continue;
+
+        bool found = false;
+        if constexpr (std::is_same<TYPE, char*>::value)
+            found = (strcmp(elem, node.data_) == 0);
+        else
+            found = (elem == node.data_);
+
+        if (not found) continue;
+
+        size_t base = path.getSize();
+        path.Reserve(base + node.depth_ + 1);
+
+        for (size_t k = 0; k <= node.depth_; ++k) path.Push(0);
+
+        for (link_t cur = i; cur != NIL_LINK; cur = nodes_[cur].prev_)
+            path.Set(base + nodes_[cur].depth_, cur);
+
+        return true;
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+int CompactTree<TYPE>::Check ()
+{
+    int err = TREE_OK;
+
+    for (size_t i = 0; (i < size_) && (err == TREE_OK); ++i)
+    {
+        const CompactNode<TYPE>& node = nodes_[i];
+
+        if (((node.prev_ != NIL_LINK) && (node.prev_  >= size_)) ||
+            ((node.left_ != NIL_LINK) && (node.left_  >= size_)) ||
+            ((node.right_!= NIL_LINK) && (node.right_ >= size_)))
+        {
+            err = TREE_MEM_ACCESS_VIOLATION;
+        }
+
+        else if (((node.prev_ == NIL_LINK) && ((i != 0) || (node.depth_ != 0))) ||
+                 ((node.prev_ != NIL_LINK) && (node.depth_ != nodes_[node.prev_].depth_ + 1)))
+        {
+            err = TREE_WRONG_DEPTH;
+        }
+
+        else if (((node.prev_  != NIL_LINK) && (nodes_[node.prev_].right_ != i) && (nodes_[node.prev_].left_ != i)) ||
+                 ((node.right_ != NIL_LINK) && (nodes_[node.right_].prev_ != i)) ||
+                 ((node.left_  != NIL_LINK) && (nodes_[node.left_].prev_  != i)))
+        {
+            err = TREE_WRONG_PREV_NODE;
+        }
+
+        if (err) badnode_ = i;
+    }
+
+    errCode_ = err;
+
+    return err;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void CompactTree<TYPE>::PrintError (const char* logname, const char* file, int line, const char* function, int err, int errline)
+{
+    assert(function != nullptr);
+    assert(logname  != nullptr);
+    assert(file     != nullptr);
+
+    FILE* log = fopen(logname, "a");
+    assert(log != nullptr);
+
+    fprintf(log, "********************************************************************************\n");
+    fprintf(log, "ERROR: file %s  line %d  function %s\n\n", file, line, function);
+    fprintf(log, "%s\n", tree_errstr[err + 1]);
+    if (errline != -1) fprintf(log, "line %d\n", errline + 1);
+
+    printf("ERROR: file %s  line %d  function %s\n", file, line, function);
+    printf("%s\n\n", tree_errstr[err + 1]);
+    if (errline != -1) printf("line %d\n", errline + 1);
+
+    if (badnode_ != NIL_LINK)
+    {
+        fprintf(log, "problem node %u [", badnode_);
+        TypePrint(log, nodes_[badnode_].data_);
+        fprintf(log, "]\n");
+
+        printf("problem node %u [", badnode_);
+        TypePrint(stdout, nodes_[badnode_].data_);
+        printf("]\n");
+    }
+
+    fclose(log);
+}
+
+//------------------------------------------------------------------------------
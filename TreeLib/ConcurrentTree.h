@@ -0,0 +1,358 @@
+/*------------------------------------------------------------------------------
+    * File:        ConcurrentTree.h                                            *
+    * Description: Declaration of the tree with lock-free readers and one      *
+                   writer publishing immutable versions.                       *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+#ifndef CONCURRENTTREE_H_INCLUDED
+#define CONCURRENTTREE_H_INCLUDED
+
+#define _CRT_SECURE_NO_WARNINGS
+
+
+#include "Tree.h"
+#include "Epoch.h"
+#include <atomic>
+#include <mutex>
+
+
+#define newConcurrentTree(NAME, TREE_TYPE) \
+        ConcurrentTree<TREE_TYPE> NAME ((char*)#NAME);
+
+#define newConcurrentTree_tree(NAME, tree, TREE_TYPE) \
+        ConcurrentTree<TREE_TYPE> NAME ((char*)#NAME, tree);
+
+
+//------------------------------------------------------------------------------
+/*! @brief   Node of a published tree version, never changed after it is
+ *           published. It has no previous node and depth, they differ between
+ *           versions sharing the node.
+ */
+
+template <typename TYPE>
+struct SharedNode
+{
+    TYPE data_ = POISON<TYPE>;
+
+    const SharedNode* left_  = nullptr;
+    const SharedNode* right_ = nullptr;
+};
+
+//------------------------------------------------------------------------------
+/*! @brief   Tree for many reader threads and one writer. The writer copies the
+ *           nodes from the root to the changed one and publishes the new root
+ *           with one atomic store, the replaced nodes are freed by the epoch
+ *           reclamation when no reader sees them. Readers take no locks and
+ *           never wait for the writer.
+ *
+ *  @note    Strings of char* trees are freed with the nodes that replace or
+ *           delete them. Writers are serialized by a mutex.
+ */
+
+template <typename TYPE>
+class ConcurrentTree
+{
+    int errCode_ = 0;
+
+    alignas(64) std::atomic<const SharedNode<TYPE>*> root_;
+    std::atomic<size_t> size_;
+
+    mutable EpochDomain epoch_;
+
+    std::mutex writer_;
+
+public:
+
+    char* name_ = nullptr;
+
+//------------------------------------------------------------------------------
+/*! @brief   Reader of the tree version published at its construction, it
+ *           keeps the nodes of the version alive until destructed.
+ */
+
+    class Reader
+    {
+        EpochGuard guard_;
+
+        const SharedNode<TYPE>* root_ = nullptr;
+
+    public:
+
+//------------------------------------------------------------------------------
+/*! @brief   Reader constructor, enters the epoch of the tree.
+ *
+ *  @param   tree        Tree to read
+ */
+
+        Reader (const ConcurrentTree& tree);
+
+        Reader (const Reader& obj) = delete;
+
+        Reader& operator = (const Reader& obj) = delete;
+
+//------------------------------------------------------------------------------
+/*! @brief   Get root of the version.
+ *
+ *  @return  root node, nullptr if the tree is empty
+ */
+
+        const SharedNode<TYPE>* getRoot () const;
+
+//------------------------------------------------------------------------------
+/*! @brief   Find path in the version to the leaf with the element.
+ *
+ *  @param   path        Path to the element (node addresses from the root)
+ *  @param   elem        Data of node
+ *
+ *  @return  1 if found, 0 if not
+ */
+
+        template <size_t INLINE, typename POLICY>
+        bool findPath (Stack<size_t, INLINE, POLICY>& path, TYPE elem) const;
+
+//------------------------------------------------------------------------------
+/*! @brief   Visit the nodes of the version in pre-order, right child first.
+ *
+ *  @param   func        Function taking a node and its depth
+ */
+
+        template <typename FUNC>
+        void Walk (FUNC func) const;
+    };
+
+//------------------------------------------------------------------------------
+/*! @brief   Empty tree constructor.
+ *
+ *  @param   tree_name   Tree variable name
+ */
+
+    ConcurrentTree (char* tree_name);
+
+//------------------------------------------------------------------------------
+/*! @brief   Tree constructor from a linked tree.
+ *
+ *  @param   tree_name   Tree variable name
+ *  @param   tree        Source tree
+ */
+
+    ConcurrentTree (char* tree_name, const Tree<TYPE>& tree);
+
+//------------------------------------------------------------------------------
+/*! @brief   Tree destructor. No reader may be left.
+ */
+
+   ~ConcurrentTree ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Tree copy constructor (deleted).
+ */
+
+    ConcurrentTree (const ConcurrentTree& obj) = delete;
+
+    ConcurrentTree& operator = (const ConcurrentTree& obj) = delete;
+
+//------------------------------------------------------------------------------
+/*! @brief   Get number of nodes in the last version.
+ *
+ *  @return  number of nodes
+ */
+
+    size_t getSize () const;
+
+//------------------------------------------------------------------------------
+/*! @brief   Publish a version with the new data in the node.
+ *
+ *  @param   path        Path from the root to the node in the last version
+ *  @param   data        New data
+ *
+ *  @return  error code, TREE_WRONG_PATH if the path is stale
+ */
+
+    template <size_t INLINE, typename POLICY>
+    int setData (Stack<size_t, INLINE, POLICY>& path, TYPE data);
+
+//------------------------------------------------------------------------------
+/*! @brief   Publish a version with the new right child of the node.
+ *
+ *  @param   path        Path from the root to the node in the last version,
+ *                       empty to add the root to an empty tree
+ *  @param   data        Data of the child
+ *
+ *  @return  error code, TREE_WRONG_PATH if the path is stale or the child
+ *           exists
+ */
+
+    template <size_t INLINE, typename POLICY>
+    int addRight (Stack<size_t, INLINE, POLICY>& path, TYPE data);
+
+//------------------------------------------------------------------------------
+/*! @brief   Publish a version with the new left child of the node.
+ *
+ *  @param   path        Path from the root to the node in the last version,
+ *                       empty to add the root to an empty tree
+ *  @param   data        Data of the child
+ *
+ *  @return  error code, TREE_WRONG_PATH if the path is stale or the child
+ *           exists
+ */
+
+    template <size_t INLINE, typename POLICY>
+    int addLeft (Stack<size_t, INLINE, POLICY>& path, TYPE data);
+
+//------------------------------------------------------------------------------
+/*! @brief   Publish a version where the leaf becomes a node with the data and
+ *           two children: the old leaf and the new one. Readers see either
+ *           the old leaf or the whole new subtree.
+ *
+ *  @param   path        Path from the root to the leaf in the last version
+ *  @param   data        Data of the node replacing the leaf
+ *  @param   leaf        Data of the new leaf
+ *  @param   right       Put the new leaf to the right, the old one to the left
+ *
+ *  @return  error code, TREE_WRONG_PATH if the path is stale or does not end
+ *           with a leaf
+ */
+
+    template <size_t INLINE, typename POLICY>
+    int splitLeaf (Stack<size_t, INLINE, POLICY>& path, TYPE data, TYPE leaf, bool right = true);
+
+//------------------------------------------------------------------------------
+/*! @brief   Publish a version without the node and its subtree.
+ *
+ *  @param   path        Path from the root to the node in the last version
+ *
+ *  @return  error code, TREE_WRONG_PATH if the path is stale
+ */
+
+    template <size_t INLINE, typename POLICY>
+    int deleteNode (Stack<size_t, INLINE, POLICY>& path);
+
+//------------------------------------------------------------------------------
+/*! @brief   Build a linked tree from the last version.
+ *
+ *  @param   tree        Destination tree, its nodes are replaced
+ */
+
+    void toTree (Tree<TYPE>& tree);
+
+//------------------------------------------------------------------------------
+/*! @brief   Free the replaced nodes no reader sees anymore.
+ *
+ *  @return  number of replaced nodes still waiting
+ */
+
+    size_t Collect ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Print error explanations to log file and to console.
+ *
+ *  @param   logname     Name of the log file
+ *  @param   file        Name of the file from which this function was called
+ *  @param   line        Line of the code from which this function was called
+ *  @param   function    Name of the function from which this function was called
+ *  @param   err         Error code
+ *  @param   errline     Number of base line with error
+ */
+
+    void PrintError (const char* logname, const char* file, int line, const char* function, int err, int errline);
+
+/*------------------------------------------------------------------------------
+                   Private functions                                           *
+*///----------------------------------------------------------------------------
+
+private:
+
+//------------------------------------------------------------------------------
+/*! @brief   Make a node, char* data is copied to the node.
+ *
+ *  @param   data        Node data
+ *
+ *  @return  pointer to the node
+ */
+
+    SharedNode<TYPE>* newNode (TYPE data);
+
+//------------------------------------------------------------------------------
+/*! @brief   Make a copy of the node with the same data and children.
+ *
+ *  @param   node        Source node
+ *
+ *  @return  pointer to the copy
+ */
+
+    SharedNode<TYPE>* copyNode (const SharedNode<TYPE>* node);
+
+//------------------------------------------------------------------------------
+/*! @brief   Check that the path goes from the root of the last version.
+ *
+ *  @param   path        Path of node addresses
+ *
+ *  @return  1 if the path is valid, else 0
+ */
+
+    template <size_t INLINE, typename POLICY>
+    bool isValid (Stack<size_t, INLINE, POLICY>& path) const;
+
+//------------------------------------------------------------------------------
+/*! @brief   Copy the path above the replaced node, publish the new root and
+ *           retire the old path.
+ *
+ *  @param   path        Valid path, its last node is replaced
+ *  @param   node        Replacing node, nullptr to unlink
+ *  @param   added       Change of the number of nodes
+ */
+
+    template <size_t INLINE, typename POLICY>
+    void Publish (Stack<size_t, INLINE, POLICY>& path, const SharedNode<TYPE>* node, int64_t added);
+
+//------------------------------------------------------------------------------
+/*! @brief   Add a child and publish the version.
+ *
+ *  @param   path        Path from the root to the parent
+ *  @param   data        Data of the child
+ *  @param   right       Add the right child
+ *
+ *  @return  error code
+ */
+
+    template <size_t INLINE, typename POLICY>
+    int addChild (Stack<size_t, INLINE, POLICY>& path, TYPE data, bool right);
+
+//------------------------------------------------------------------------------
+/*! @brief   Free the node and its string, used by the epoch reclamation.
+ *
+ *  @param   node        Node
+ */
+
+    static void dropNode (void* node);
+
+//------------------------------------------------------------------------------
+/*! @brief   Free the node, its string stays with the copy of the node, used
+ *           by the epoch reclamation.
+ *
+ *  @param   node        Node
+ */
+
+    static void dropCopy (void* node);
+
+//------------------------------------------------------------------------------
+/*! @brief   Retire the subtree, the nodes are freed when no reader sees them.
+ *
+ *  @param   node        Root of the subtree
+ *
+ *  @return  number of nodes
+ */
+
+    size_t retireSubtree (const SharedNode<TYPE>* node);
+
+//------------------------------------------------------------------------------
+};
+
+#include "ConcurrentTree.ipp"
+
+#endif // CONCURRENTTREE_H_INCLUDED
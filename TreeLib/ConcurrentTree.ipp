@@ -0,0 +1,541 @@
+/*------------------------------------------------------------------------------
+    * File:        ConcurrentTree.ipp                                          *
+    * Description: Functions of the tree with lock-free readers.               *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+/*------------------------------------------------------------------------------
+    The nodes are filled before the root is stored, the seq_cst store of the
+    root publishes them to the readers loading it. The writer retires the
+    replaced nodes after the store, so a reader entering the epoch later
+    cannot reach them, and a reader already inside keeps them alive.
+
+    The string of a char* node belongs to the node and to its copies made
+    on the way to the root. A copy is retired by dropCopy, the node whose
+    data is replaced or deleted is retired last by dropNode with the string,
+    so the string lives while any reader may see a version with it.
+*///----------------------------------------------------------------------------
+
+template <typename TYPE>
+ConcurrentTree<TYPE>::Reader::Reader (const ConcurrentTree& tree) :
+    guard_ (tree.epoch_),
+    root_  (tree.root_.load())
+{ }
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+const SharedNode<TYPE>* ConcurrentTree<TYPE>::Reader::getRoot () const
+{
+    return root_;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+template <size_t INLINE, typename POLICY>
+bool ConcurrentTree<TYPE>::Reader::findPath (Stack<size_t, INLINE, POLICY>& path, TYPE elem) const
+{
+    assert(not isPOISON(elem));
+
+    struct Frame
+    {
+        const SharedNode<TYPE>* node;
+        size_t                  depth;
+    };
+
+    WalkStack<Frame> frames;
+    WalkStack<const SharedNode<TYPE>*> line;
+
+    if (root_ != nullptr) frames.Push({ root_, 0 });
+
+    while (frames.getSize() > 0)
+    {
+        Frame frame = frames.Pop();
+        const SharedNode<TYPE>* node = frame.node;
+
+        line.Cut(frame.depth);
+        line.Push(node);
+
+        if ((node->left_ == nullptr) && (node->right_ == nullptr))
+        {
+            bool found = false;
+            if constexpr (std::is_same<TYPE, char*>::value)
+                found = (strcmp(elem, node->data_) == 0);
+            else
+                found = (elem == node->data_);
+
+            if (not found) continue;
+
+            path.Reserve(path.getSize() + line.getSize());
+
+            for (size_t i = 0; i < line.getSize(); ++i)
+                path.Push((size_t)line[i]);
+
+            return true;
+        }
+
+        if (node->left_  != nullptr) frames.Push({ node->left_,  frame.depth + 1 });
+        if (node->right_ != nullptr) frames.Push({ node->right_, frame.depth + 1 });
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+template <typename FUNC>
+void ConcurrentTree<TYPE>::Reader::Walk (FUNC func) const
+{
+    struct Frame
+    {
+        const SharedNode<TYPE>* node;
+        size_t                  depth;
+    };
+
+    WalkStack<Frame> frames;
+
+    if (root_ != nullptr) frames.Push({ root_, 0 });
+
+    while (frames.getSize() > 0)
+    {
+        Frame frame = frames.Pop();
+
+        func(frame.node, frame.depth);
+
+        if (frame.node->left_  != nullptr) frames.Push({ frame.node->left_,  frame.depth + 1 });
+        if (frame.node->right_ != nullptr) frames.Push({ frame.node->right_, frame.depth + 1 });
+    }
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+ConcurrentTree<TYPE>::ConcurrentTree (char* tree_name) :
+    errCode_ (TREE_OK),
+    root_    (nullptr),
+    size_    (0),
+    name_    (tree_name)
+{
+    TREE_ASSERTOK((tree_name == nullptr), TREE_WRONG_INPUT_TREE_NAME, -1);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+ConcurrentTree<TYPE>::ConcurrentTree (char* tree_name, const Tree<TYPE>& tree) :
+    errCode_ (TREE_OK),
+    root_    (nullptr),
+    size_    (0),
+    name_    (tree_name)
+{
+    TREE_ASSERTOK((tree_name == nullptr), TREE_WRONG_INPUT_TREE_NAME, -1);
+
+    if (tree.root_ == nullptr) return;
+
+    struct Frame
+    {
+        const Node<TYPE>* node;
+        SharedNode<TYPE>* prev;
+        bool              right;
+    };
+
+    WalkStack<Frame> frames;
+    frames.Push({ tree.root_, nullptr, false });
+
+    SharedNode<TYPE>* root = nullptr;
+    size_t size = 0;
+
+    while (frames.getSize() > 0)
+    {
+        Frame frame = frames.Pop();
+
+        SharedNode<TYPE>* node = newNode(frame.node->data_);
+        ++size;
+
+        if (frame.prev == nullptr) root = node;
+        else if (frame.right)      frame.prev->right_ = node;
+        else                       frame.prev->left_  = node;
+
+        if (frame.node->left_  != nullptr) frames.Push({ frame.node->left_,  node, false });
+        if (frame.node->right_ != nullptr) frames.Push({ frame.node->right_, node, true  });
+    }
+
+    size_.store(size);
+    root_.store(root);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+ConcurrentTree<TYPE>::~ConcurrentTree ()
+{
+    retireSubtree(root_.load());
+    root_.store(nullptr);
+
+    size_.store(0);
+
+    errCode_ = TREE_DESTRUCTED;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+size_t ConcurrentTree<TYPE>::getSize () const
+{
+    return size_.load(std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+template <size_t INLINE, typename POLICY>
+int ConcurrentTree<TYPE>::setData (Stack<size_t, INLINE, POLICY>& path, TYPE data)
+{
+    TREE_ASSERTOK((isPOISON(data)), TREE_INPUT_DATA_POISON, -1);
+
+    std::lock_guard<std::mutex> lock(writer_);
+
+    if (not isValid(path)) return TREE_WRONG_PATH;
+
+    const SharedNode<TYPE>* old = (const SharedNode<TYPE>*)path[path.getSize() - 1];
+
+    SharedNode<TYPE>* node = newNode(data);
+    node->left_  = old->left_;
+    node->right_ = old->right_;
+
+    Publish(path, node, 0);
+    epoch_.Retire((void*)old, dropNode);
+
+    return TREE_OK;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+template <size_t INLINE, typename POLICY>
+int ConcurrentTree<TYPE>::addRight (Stack<size_t, INLINE, POLICY>& path, TYPE data)
+{
+    return addChild(path, data, true);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+template <size_t INLINE, typename POLICY>
+int ConcurrentTree<TYPE>::addLeft (Stack<size_t, INLINE, POLICY>& path, TYPE data)
+{
+    return addChild(path, data, false);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+template <size_t INLINE, typename POLICY>
+int ConcurrentTree<TYPE>::addChild (Stack<size_t, INLINE, POLICY>& path, TYPE data, bool right)
+{
+    TREE_ASSERTOK((isPOISON(data)), TREE_INPUT_DATA_POISON, -1);
+
+    std::lock_guard<std::mutex> lock(writer_);
+
+    if (path.getSize() == 0)
+    {
+        if (root_.load() != nullptr) return TREE_WRONG_PATH;
+
+        Publish(path, newNode(data), 1);
+
+        return TREE_OK;
+    }
+
+    if (not isValid(path)) return TREE_WRONG_PATH;
+
+    const SharedNode<TYPE>* old = (const SharedNode<TYPE>*)path[path.getSize() - 1];
+    if (((right) ? old->right_ : old->left_) != nullptr) return TREE_WRONG_PATH;
+
+    SharedNode<TYPE>* node = copyNode(old);
+
+    if (right) node->right_ = newNode(data);
+    else       node->left_  = newNode(data);
+
+    Publish(path, node, 1);
+    epoch_.Retire((void*)old, dropCopy);
+
+    return TREE_OK;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+template <size_t INLINE, typename POLICY>
+int ConcurrentTree<TYPE>::splitLeaf (Stack<size_t, INLINE, POLICY>& path, TYPE data, TYPE leaf, bool right)
+{
+    TREE_ASSERTOK((isPOISON(data)), TREE_INPUT_DATA_POISON, -1);
+    TREE_ASSERTOK((isPOISON(leaf)), TREE_INPUT_DATA_POISON, -1);
+
+    std::lock_guard<std::mutex> lock(writer_);
+
+    if (not isValid(path)) return TREE_WRONG_PATH;
+
+    const SharedNode<TYPE>* old = (const SharedNode<TYPE>*)path[path.getSize() - 1];
+    if ((old->left_ != nullptr) || (old->right_ != nullptr)) return TREE_WRONG_PATH;
+
+    SharedNode<TYPE>* node = newNode(data);
+
+    if (right)
+    {
+        node->right_ = newNode(leaf);
+        node->left_  = old;
+    }
+    else
+    {
+        node->left_  = newNode(leaf);
+        node->right_ = old;
+    }
+
+    Publish(path, node, 2);
+
+    return TREE_OK;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+template <size_t INLINE, typename POLICY>
+int ConcurrentTree<TYPE>::deleteNode (Stack<size_t, INLINE, POLICY>& path)
+{
+    std::lock_guard<std::mutex> lock(writer_);
+
+    if (not isValid(path)) return TREE_WRONG_PATH;
+
+    const SharedNode<TYPE>* old = (const SharedNode<TYPE>*)path[path.getSize() - 1];
+
+    Publish(path, nullptr, 0);
+
+    size_t removed = retireSubtree(old);
+    size_.store(size_.load(std::memory_order_relaxed) - removed, std::memory_order_relaxed);
+
+    return TREE_OK;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void ConcurrentTree<TYPE>::toTree (Tree<TYPE>& tree)
+{
+    Reader reader(*this);
+
+    tree.Clean();
+    if (reader.getRoot() == nullptr) return;
+
+    struct Frame
+    {
+        const SharedNode<TYPE>* node;
+        Node<TYPE>*             prev;
+        bool                    right;
+    };
+
+    WalkStack<Frame> frames;
+    frames.Push({ reader.getRoot(), nullptr, false });
+
+    while (frames.getSize() > 0)
+    {
+        Frame frame = frames.Pop();
+        Node<TYPE>* node = tree.newNode();
+
+        if constexpr (std::is_same<TYPE, char*>::value)
+        {
+            if (frame.node->data_ != nullptr)
+            {
+                node->data_     = tree.strings_.Copy(frame.node->data_);
+                node->in_store_ = true;
+            }
+        }
+        else node->data_ = frame.node->data_;
+
+        if (frame.prev == nullptr) tree.root_ = node;
+        else
+        {
+            node->prev_  = frame.prev;
+            node->depth_ = frame.prev->depth_ + 1;
+
+            if (frame.right) frame.prev->right_ = node;
+            else             frame.prev->left_  = node;
+        }
+
+        if (frame.node->left_  != nullptr) frames.Push({ frame.node->left_,  node, false });
+        if (frame.node->right_ != nullptr) frames.Push({ frame.node->right_, node, true  });
+    }
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+size_t ConcurrentTree<TYPE>::Collect ()
+{
+    std::lock_guard<std::mutex> lock(writer_);
+
+    return epoch_.Collect();
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+SharedNode<TYPE>* ConcurrentTree<TYPE>::newNode (TYPE data)
+{
+    SharedNode<TYPE>* node = new (std::nothrow) SharedNode<TYPE>;
+    TREE_ASSERTOK((node == nullptr), TREE_NO_MEMORY, -1);
+
+    if constexpr (std::is_same<TYPE, char*>::value)
+    {
+        if (data != nullptr)
+        {
+            size_t len = strlen(data);
+
+            char* copy = (char*)malloc(len + 1);
+            TREE_ASSERTOK((copy == nullptr), TREE_NO_MEMORY, -1);
+
+            data = (char*)memcpy(copy, data, len + 1);
+        }
+    }
+
+    node->data_ = data;
+
+    return node;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+SharedNode<TYPE>* ConcurrentTree<TYPE>::copyNode (const SharedNode<TYPE>* node)
+{
+    SharedNode<TYPE>* copy = new (std::nothrow) SharedNode<TYPE>(*node);
+    TREE_ASSERTOK((copy == nullptr), TREE_NO_MEMORY, -1);
+
+    return copy;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+template <size_t INLINE, typename POLICY>
+bool ConcurrentTree<TYPE>::isValid (Stack<size_t, INLINE, POLICY>& path) const
+{
+    if (path.getSize() == 0) return false;
+
+    const SharedNode<TYPE>* node = root_.load(std::memory_order_relaxed);
+    if ((node == nullptr) || ((size_t)node != path[0])) return false;
+
+    for (size_t i = 1; i < path.getSize(); ++i)
+    {
+        if      ((size_t)node->right_ == path[i]) node = node->right_;
+        else if ((size_t)node->left_  == path[i]) node = node->left_;
+        else return false;
+
+        if (node == nullptr) return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+template <size_t INLINE, typename POLICY>
+void ConcurrentTree<TYPE>::Publish (Stack<size_t, INLINE, POLICY>& path, const SharedNode<TYPE>* node, int64_t added)
+{
+    const SharedNode<TYPE>* child = node;
+
+    for (size_t i = path.getSize(); i-- > 1; )
+    {
+        const SharedNode<TYPE>* old = (const SharedNode<TYPE>*)path[i - 1];
+
+        SharedNode<TYPE>* copy = copyNode(old);
+
+        if ((size_t)old->right_ == path[i]) copy->right_ = child;
+        else                                copy->left_  = child;
+
+        child = copy;
+    }
+
+    root_.store(child);
+
+    size_.store(size_.load(std::memory_order_relaxed) + added, std::memory_order_relaxed);
+
+    for (size_t i = 0; i + 1 < path.getSize(); ++i)
+        epoch_.Retire((void*)path[i], dropCopy);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void ConcurrentTree<TYPE>::dropNode (void* node)
+{
+    if constexpr (std::is_same<TYPE, char*>::value) free(((SharedNode<TYPE>*)node)->data_);
+
+    delete (SharedNode<TYPE>*)node;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void ConcurrentTree<TYPE>::dropCopy (void* node)
+{
+    delete (SharedNode<TYPE>*)node;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+size_t ConcurrentTree<TYPE>::retireSubtree (const SharedNode<TYPE>* node)
+{
+    if (node == nullptr) return 0;
+
+    WalkStack<const SharedNode<TYPE>*> nodes;
+    nodes.Push(node);
+
+    size_t size = 0;
+
+    while (nodes.getSize() > 0)
+    {
+        const SharedNode<TYPE>* cur = nodes.Pop();
+
+        if (cur->left_  != nullptr) nodes.Push(cur->left_);
+        if (cur->right_ != nullptr) nodes.Push(cur->right_);
+
+        epoch_.Retire((void*)cur, dropNode);
+        ++size;
+    }
+
+    return size;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void ConcurrentTree<TYPE>::PrintError (const char* logname, const char* file, int line, const char* function, int err, int errline)
+{
+    assert(function != nullptr);
+    assert(logname  != nullptr);
+    assert(file     != nullptr);
+
+    FILE* log = fopen(logname, "a");
+    assert(log != nullptr);
+
+    fprintf(log, "********************************************************************************\n");
+    fprintf(log, "ERROR: file %s  line %d  function %s\n\n", file, line, function);
+    fprintf(log, "%s\n", tree_errstr[err + 1]);
+    if (errline != -1) fprintf(log, "line %d\n", errline + 1);
+
+    printf("ERROR: file %s  line %d  function %s\n", file, line, function);
+    printf("%s\n\n", tree_errstr[err + 1]);
+    if (errline != -1) printf("line %d\n", errline + 1);
+
+    fclose(log);
+}
+
+//------------------------------------------------------------------------------
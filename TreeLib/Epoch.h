@@ -0,0 +1,171 @@
+/*------------------------------------------------------------------------------
+    * File:        Epoch.h                                                     *
+    * Description: Epoch-based reclamation of memory shared with readers.      *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+#ifndef EPOCH_H_INCLUDED
+#define EPOCH_H_INCLUDED
+
+#define _CRT_SECURE_NO_WARNINGS
+
+
+#include "NodeWalk.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <atomic>
+#include <functional>
+#include <thread>
+
+
+const size_t EPOCH_SLOTS        = 128;
+const size_t EPOCH_RETIRE_BATCH = 64;
+
+
+//------------------------------------------------------------------------------
+/*! @brief   Epoch-based reclamation domain. Readers announce the global epoch
+ *           in their own slot while they hold pointers, the writer frees the
+ *           memory retired in epoch e when the global epoch reaches e + 2,
+ *           that is when every reader of epoch e has left.
+ *
+ *  @note    Retire and Collect are called by one thread at a time (the
+ *           writer), Enter and Leave by any thread. More than EPOCH_SLOTS
+ *           readers at once wait for a free slot.
+ */
+
+class EpochDomain
+{
+    struct alignas(64) Slot
+    {
+        std::atomic<uint64_t> epoch_ { 0 };
+        std::atomic<bool>     used_  { false };
+    };
+
+    struct Retired
+    {
+        void*    ptr_   = nullptr;
+        void   (*drop_) (void*) = nullptr;
+        uint64_t epoch_ = 0;
+    };
+
+    alignas(64) std::atomic<uint64_t> epoch_;
+
+    Slot slots_[EPOCH_SLOTS];
+
+    WalkStack<Retired> retired_;
+
+public:
+
+//------------------------------------------------------------------------------
+/*! @brief   Domain constructor.
+ */
+
+    EpochDomain ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Domain destructor, all retired memory is freed. No reader may be
+ *           inside the domain.
+ */
+
+   ~EpochDomain ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Domain copy constructor (deleted).
+ *
+ *  @param   obj         Source domain
+ */
+
+    EpochDomain (const EpochDomain& obj) = delete;
+
+    EpochDomain& operator = (const EpochDomain& obj) = delete;
+
+//------------------------------------------------------------------------------
+/*! @brief   Enter the domain, the memory the reader sees after it is not freed
+ *           until Leave.
+ *
+ *  @return  slot of the reader
+ */
+
+    size_t Enter ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Leave the domain.
+ *
+ *  @param   slot        Slot returned by Enter
+ */
+
+    void Leave (size_t slot);
+
+//------------------------------------------------------------------------------
+/*! @brief   Retire memory unlinked from the shared data, it is freed when no
+ *           reader can see it anymore.
+ *
+ *  @param   ptr         Pointer to the memory
+ *  @param   drop        Function freeing the memory
+ */
+
+    void Retire (void* ptr, void (*drop) (void*));
+
+//------------------------------------------------------------------------------
+/*! @brief   Try to advance the global epoch and free the retired memory that
+ *           is not seen by readers.
+ *
+ *  @return  number of retired pointers left
+ */
+
+    size_t Collect ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Get number of retired pointers waiting to be freed.
+ *
+ *  @return  number of pointers
+ */
+
+    size_t getRetired () const;
+
+/*------------------------------------------------------------------------------
+                   Private functions                                           *
+*///----------------------------------------------------------------------------
+
+private:
+
+//------------------------------------------------------------------------------
+/*! @brief   Advance the global epoch if all readers announced the current one.
+ *
+ *  @return  global epoch
+ */
+
+    uint64_t Advance ();
+
+//------------------------------------------------------------------------------
+};
+
+//------------------------------------------------------------------------------
+/*! @brief   Reader guard, the thread stays inside the domain while the guard
+ *           lives.
+ */
+
+class EpochGuard
+{
+    EpochDomain& domain_;
+    size_t       slot_;
+
+public:
+
+    EpochGuard (EpochDomain& domain);
+
+   ~EpochGuard ();
+
+    EpochGuard (const EpochGuard& obj) = delete;
+
+    EpochGuard& operator = (const EpochGuard& obj) = delete;
+};
+
+#include "Epoch.ipp"
+
+#endif // EPOCH_H_INCLUDED
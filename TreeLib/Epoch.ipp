@@ -0,0 +1,138 @@
+/*------------------------------------------------------------------------------
+    * File:        Epoch.ipp                                                   *
+    * Description: Functions of the epoch-based reclamation.                   *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+/*------------------------------------------------------------------------------
+    Epoch 0 in a slot means the slot is free. A reader stores the global epoch
+    to its slot and only then loads shared pointers, both seq_cst, so the
+    writer scanning the slots after unlinking either sees the reader or the
+    reader sees the unlinked state. The epoch a reader announces may be stale,
+    this only stops the epoch from advancing until the reader leaves.
+*///----------------------------------------------------------------------------
+
+inline EpochDomain::EpochDomain () :
+    epoch_ (1)
+{ }
+
+//------------------------------------------------------------------------------
+
+inline EpochDomain::~EpochDomain ()
+{
+    for (size_t i = 0; i < retired_.getSize(); ++i)
+        retired_[i].drop_(retired_[i].ptr_);
+
+    retired_.Clean();
+}
+
+//------------------------------------------------------------------------------
+
+inline size_t EpochDomain::Enter ()
+{
+    static thread_local size_t hint = std::hash<std::thread::id>()(std::this_thread::get_id());
+
+    for (;;)
+    {
+        for (size_t k = 0; k < EPOCH_SLOTS; ++k)
+        {
+            size_t i = (hint + k) % EPOCH_SLOTS;
+            Slot& slot = slots_[i];
+
+            if (slot.used_.load(std::memory_order_relaxed)) continue;
+            if (slot.used_.exchange(true, std::memory_order_acquire)) continue;
+
+            slot.epoch_.store(epoch_.load());
+
+            hint = i;
+
+            return i;
+        }
+
+        std::this_thread::yield();
+    }
+}
+
+//------------------------------------------------------------------------------
+
+inline void EpochDomain::Leave (size_t slot)
+{
+    assert(slot < EPOCH_SLOTS);
+
+    slots_[slot].epoch_.store(0, std::memory_order_release);
+    slots_[slot].used_.store(false, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------
+
+inline void EpochDomain::Retire (void* ptr, void (*drop) (void*))
+{
+    assert(ptr  != nullptr);
+    assert(drop != nullptr);
+
+    retired_.Push({ ptr, drop, epoch_.load() });
+
+    if (retired_.getSize() >= EPOCH_RETIRE_BATCH) Collect();
+}
+
+//------------------------------------------------------------------------------
+
+inline size_t EpochDomain::Collect ()
+{
+    uint64_t epoch = Advance();
+
+    size_t freed = 0;
+    while ((freed < retired_.getSize()) && (retired_[freed].epoch_ + 2 <= epoch))
+    {
+        retired_[freed].drop_(retired_[freed].ptr_);
+        ++freed;
+    }
+
+    retired_.Shift(freed);
+
+    return retired_.getSize();
+}
+
+//------------------------------------------------------------------------------
+
+inline size_t EpochDomain::getRetired () const
+{
+    return retired_.getSize();
+}
+
+//------------------------------------------------------------------------------
+
+inline uint64_t EpochDomain::Advance ()
+{
+    uint64_t epoch = epoch_.load();
+
+    for (size_t i = 0; i < EPOCH_SLOTS; ++i)
+    {
+        uint64_t seen = slots_[i].epoch_.load();
+        if ((seen != 0) && (seen != epoch)) return epoch;
+    }
+
+    epoch_.store(epoch + 1);
+
+    return epoch + 1;
+}
+
+//------------------------------------------------------------------------------
+
+inline EpochGuard::EpochGuard (EpochDomain& domain) :
+    domain_ (domain),
+    slot_   (domain.Enter())
+{ }
+
+//------------------------------------------------------------------------------
+
+inline EpochGuard::~EpochGuard ()
+{
+    domain_.Leave(slot_);
+}
+
+//------------------------------------------------------------------------------
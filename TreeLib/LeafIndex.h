@@ -0,0 +1,226 @@
+/*------------------------------------------------------------------------------
+    * File:        LeafIndex.h                                                 *
+    * Description: Declaration of the hash index from leaf data to tree nodes. *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+#ifndef LEAFINDEX_H_INCLUDED
+#define LEAFINDEX_H_INCLUDED
+
+#define _CRT_SECURE_NO_WARNINGS
+
+
+#include "../StackLib/hash.h"
+#include <type_traits>
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <utility>
+
+
+const size_t INDEX_FIRST_CAPACITY = 64;
+
+
+template <typename TYPE>
+class Node;
+
+//------------------------------------------------------------------------------
+/*! @brief   Open addressing (linear probing) table from leaf data to the leaf.
+ *           The key is not copied, it is read from the node. When several
+ *           leaves have equal data the first inserted one is found, the
+ *           others are kept in a chain of its entry.
+ */
+
+template <typename TYPE>
+class LeafIndex
+{
+    struct Entry
+    {
+        uint64_t    hash;
+        Node<TYPE>* node;
+        size_t      chain;
+    };
+
+    struct Link
+    {
+        Node<TYPE>* node;
+        size_t      next;
+    };
+
+    Entry* table_    = nullptr;
+    size_t capacity_ = 0;
+    size_t size_     = 0;
+
+    Link*  links_          = nullptr;
+    size_t links_capacity_ = 0;
+    size_t free_link_      = 0;
+
+    bool built_ = false;
+
+public:
+
+//------------------------------------------------------------------------------
+/*! @brief   Index default constructor, the index is not built.
+ */
+
+    LeafIndex ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Index destructor.
+ */
+
+   ~LeafIndex ();
+
+    LeafIndex (const LeafIndex& obj) = delete;
+
+    LeafIndex& operator = (const LeafIndex& obj) = delete;
+
+//------------------------------------------------------------------------------
+/*! @brief   Add leaf to the index, a leaf with the data of an indexed one
+ *           goes to the chain of its entry.
+ *
+ *  @param   node        Leaf, not indexed yet
+ *
+ *  @return  error code (0 if ok)
+ */
+
+    int Insert (Node<TYPE>* node);
+
+//------------------------------------------------------------------------------
+/*! @brief   Remove leaf from the index, the first leaf of the chain takes the
+ *           place of the found one.
+ *
+ *  @param   node        Leaf
+ *
+ *  @return  1 if the leaf was indexed and is removed, else 0
+ */
+
+    int Erase (Node<TYPE>* node);
+
+//------------------------------------------------------------------------------
+/*! @brief   Move the leaf in the index to another leaf with the same data.
+ *
+ *  @param   node        Indexed leaf
+ *  @param   other       Leaf taking its place
+ *
+ *  @return  1 if the leaf was indexed and is replaced, else 0
+ */
+
+    int Replace (Node<TYPE>* node, Node<TYPE>* other);
+
+//------------------------------------------------------------------------------
+/*! @brief   Find leaf by data.
+ *
+ *  @param   key         Leaf data
+ *
+ *  @return  leaf, nullptr if not found
+ */
+
+    Node<TYPE>* Find (const TYPE& key) const;
+
+//------------------------------------------------------------------------------
+/*! @brief   Remove all leaves and mark the index as built or not built.
+ *
+ *  @param   built       New state of the index
+ */
+
+    void Clean (bool built = false);
+
+//------------------------------------------------------------------------------
+/*! @brief   Exchange contents of two indices.
+ *
+ *  @param   obj         Other index
+ */
+
+    void Swap (LeafIndex& obj) noexcept;
+
+//------------------------------------------------------------------------------
+/*! @brief   Check if the index is built and has to be kept up to date.
+ *
+ *  @return  1 if built, else 0
+ */
+
+    bool isBuilt () const;
+
+//------------------------------------------------------------------------------
+/*! @brief   Get number of indexed leaves with different data.
+ *
+ *  @return  number of leaves
+ */
+
+    size_t getSize () const;
+
+//------------------------------------------------------------------------------
+/*! @brief   Compute hash of the key.
+ *
+ *  @param   key         Key
+ *
+ *  @return  hash
+ */
+
+    static uint64_t KeyHash (const TYPE& key);
+
+//------------------------------------------------------------------------------
+/*! @brief   Compare two keys.
+ *
+ *  @param   key1        First key
+ *  @param   key2        Second key
+ *
+ *  @return  1 if keys are equal, else 0
+ */
+
+    static bool KeyEqual (const TYPE& key1, const TYPE& key2);
+
+/*------------------------------------------------------------------------------
+                   Private functions                                           *
+*///----------------------------------------------------------------------------
+
+private:
+
+//------------------------------------------------------------------------------
+/*! @brief   Increase the table by 2 times.
+ *
+ *  @return  error code
+ */
+
+    int Expand ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Take a free link, the links array is increased by 2 times if it
+ *           is full.
+ *
+ *  @return  link number, 0 if there is no memory
+ */
+
+    size_t newLink ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Return the link to the free list.
+ *
+ *  @param   link        Link number
+ */
+
+    void freeLink (size_t link);
+
+//------------------------------------------------------------------------------
+/*! @brief   Find position of the key or of the free slot for it.
+ *
+ *  @param   key         Key
+ *  @param   hash        Hash of the key
+ *
+ *  @return  slot number
+ */
+
+    size_t Probe (const TYPE& key, uint64_t hash) const;
+
+//------------------------------------------------------------------------------
+};
+
+#include "LeafIndex.ipp"
+
+#endif // LEAFINDEX_H_INCLUDED
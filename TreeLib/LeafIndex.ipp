@@ -0,0 +1,316 @@
+/*------------------------------------------------------------------------------
+    * File:        LeafIndex.ipp                                               *
+    * Description: Functions of the hash index from leaf data to tree nodes.   *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+template <typename TYPE>
+LeafIndex<TYPE>::LeafIndex () { }
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+LeafIndex<TYPE>::~LeafIndex ()
+{
+    free(table_);
+    table_ = nullptr;
+
+    capacity_ = 0;
+    size_     = 0;
+
+    free(links_);
+    links_ = nullptr;
+
+    links_capacity_ = 0;
+    free_link_      = 0;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+int LeafIndex<TYPE>::Insert (Node<TYPE>* node)
+{
+    assert(node != nullptr);
+
+    if ((size_ + 1) * 2 > capacity_)
+        if (Expand()) return 1;
+
+    uint64_t hash = KeyHash(node->getData());
+    size_t   slot = Probe(node->getData(), hash);
+
+    if (table_[slot].node != nullptr)
+    {
+        if (table_[slot].node == node) return 0;
+
+        size_t link = newLink();
+        if (link == 0) return 1;
+
+        links_[link] = { node, table_[slot].chain };
+        table_[slot].chain = link;
+
+        return 0;
+    }
+
+    table_[slot] = { hash, node, 0 };
+    ++size_;
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+int LeafIndex<TYPE>::Erase (Node<TYPE>* node)
+{
+    assert(node != nullptr);
+
+    if (size_ == 0) return 0;
+
+    size_t slot = Probe(node->getData(), KeyHash(node->getData()));
+
+    if (table_[slot].node == nullptr) return 0;
+
+    if (table_[slot].node != node)
+    {
+        for (size_t* link = &table_[slot].chain; *link != 0; link = &links_[*link].next)
+        {
+            if (links_[*link].node != node) continue;
+
+            size_t next = links_[*link].next;
+            freeLink(*link);
+            *link = next;
+
+            return 1;
+        }
+
+        return 0;
+    }
+
+    size_t chain = table_[slot].chain;
+    if (chain != 0)
+    {
+        table_[slot].node  = links_[chain].node;
+        table_[slot].chain = links_[chain].next;
+        freeLink(chain);
+
+        return 1;
+    }
+
+    table_[slot].node = nullptr;
+    --size_;
+
+    size_t mask = capacity_ - 1;
+    size_t hole = slot;
+
+    for (size_t cur = (slot + 1) & mask; table_[cur].node != nullptr; cur = (cur + 1) & mask)
+    {
+        size_t home = table_[cur].hash & mask;
+
+        if (((cur - home) & mask) >= ((cur - hole) & mask))
+        {
+            table_[hole] = table_[cur];
+            table_[cur].node = nullptr;
+            hole = cur;
+        }
+    }
+
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+int LeafIndex<TYPE>::Replace (Node<TYPE>* node, Node<TYPE>* other)
+{
+    assert(node  != nullptr);
+    assert(other != nullptr);
+
+    if (size_ == 0) return 0;
+
+    size_t slot = Probe(node->getData(), KeyHash(node->getData()));
+
+    if (table_[slot].node == nullptr) return 0;
+
+    if (table_[slot].node == node)
+    {
+        table_[slot].node = other;
+        return 1;
+    }
+
+    for (size_t link = table_[slot].chain; link != 0; link = links_[link].next)
+    {
+        if (links_[link].node != node) continue;
+
+        links_[link].node = other;
+        return 1;
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+Node<TYPE>* LeafIndex<TYPE>::Find (const TYPE& key) const
+{
+    if (size_ == 0) return nullptr;
+
+    return table_[Probe(key, KeyHash(key))].node;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void LeafIndex<TYPE>::Clean (bool built)
+{
+    if (table_ != nullptr) memset(table_, 0, capacity_ * sizeof(Entry));
+
+    free_link_ = 0;
+    for (size_t link = links_capacity_; link-- > 1; ) freeLink(link);
+
+    size_  = 0;
+    built_ = built;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void LeafIndex<TYPE>::Swap (LeafIndex& obj) noexcept
+{
+    std::swap(table_,    obj.table_);
+    std::swap(capacity_, obj.capacity_);
+    std::swap(size_,     obj.size_);
+    std::swap(built_,    obj.built_);
+
+    std::swap(links_,          obj.links_);
+    std::swap(links_capacity_, obj.links_capacity_);
+    std::swap(free_link_,      obj.free_link_);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+bool LeafIndex<TYPE>::isBuilt () const
+{
+    return built_;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+size_t LeafIndex<TYPE>::getSize () const
+{
+    return size_;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+uint64_t LeafIndex<TYPE>::KeyHash (const TYPE& key)
+{
+    if constexpr (std::is_same<TYPE, char*>::value)
+        return hash(key, strlen(key));
+    else
+        return hash(&key, sizeof(TYPE));
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+bool LeafIndex<TYPE>::KeyEqual (const TYPE& key1, const TYPE& key2)
+{
+    if constexpr (std::is_same<TYPE, char*>::value)
+        return (strcmp(key1, key2) == 0);
+    else
+        return (key1 == key2);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+int LeafIndex<TYPE>::Expand ()
+{
+    size_t capacity = (capacity_ == 0) ? INDEX_FIRST_CAPACITY : capacity_ * 2;
+
+    Entry* table = (Entry*)calloc(capacity, sizeof(Entry));
+    if (table == nullptr) return 1;
+
+    Entry* old_table    = table_;
+    size_t old_capacity = capacity_;
+
+    table_    = table;
+    capacity_ = capacity;
+
+    for (size_t i = 0; i < old_capacity; ++i)
+    {
+        if (old_table[i].node == nullptr) continue;
+
+        size_t slot = old_table[i].hash & (capacity_ - 1);
+        while (table_[slot].node != nullptr) slot = (slot + 1) & (capacity_ - 1);
+
+        table_[slot] = old_table[i];
+    }
+
+    free(old_table);
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+size_t LeafIndex<TYPE>::newLink ()
+{
+    if (free_link_ == 0)
+    {
+        size_t capacity = (links_capacity_ == 0) ? INDEX_FIRST_CAPACITY : links_capacity_ * 2;
+
+        Link* links = (Link*)realloc(links_, capacity * sizeof(Link));
+        if (links == nullptr) return 0;
+
+        links_ = links;
+
+        for (size_t link = capacity; link-- > ((links_capacity_ == 0) ? 1 : links_capacity_); ) freeLink(link);
+
+        links_capacity_ = capacity;
+    }
+
+    size_t link = free_link_;
+    free_link_ = links_[link].next;
+
+    return link;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void LeafIndex<TYPE>::freeLink (size_t link)
+{
+    links_[link] = { nullptr, free_link_ };
+    free_link_ = link;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+size_t LeafIndex<TYPE>::Probe (const TYPE& key, uint64_t hash) const
+{
+    size_t mask = capacity_ - 1;
+    size_t slot = hash & mask;
+
+    while (table_[slot].node != nullptr)
+    {
+        if ((table_[slot].hash == hash) && KeyEqual(table_[slot].node->getData(), key))
+            break;
+
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,159 @@
+/*------------------------------------------------------------------------------
+    * File:        NodeArena.h                                                 *
+    * Description: Declaration of the chunked node allocator used by trees.    *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+#ifndef NODEARENA_H_INCLUDED
+#define NODEARENA_H_INCLUDED
+
+#define _CRT_SECURE_NO_WARNINGS
+
+
+#include <assert.h>
+#include <stdlib.h>
+#include <new>
+#include <utility>
+
+
+const size_t ARENA_FIRST_SLAB_SIZE = 256;
+const size_t ARENA_MAX_SLAB_SIZE   = 65536;
+
+
+template <typename TYPE>
+class Node;
+
+template <typename TYPE>
+class NodeArena
+{
+    struct Slab
+    {
+        Slab*  next_     = nullptr;
+        size_t capacity_ = 0;
+        size_t used_     = 0;
+    };
+
+    Slab*       slabs_     = nullptr;
+    Node<TYPE>* free_list_ = nullptr;
+
+    size_t slabs_num_ = 0;
+    size_t size_      = 0;
+
+public:
+
+//------------------------------------------------------------------------------
+/*! @brief   Arena default constructor.
+ */
+
+    NodeArena ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Arena destructor, releases all slabs.
+ */
+
+   ~NodeArena ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Arena copy constructor (deleted), nodes are never shared between arenas.
+ */
+
+    NodeArena (const NodeArena& obj) = delete;
+
+    NodeArena& operator = (const NodeArena& obj) = delete;
+
+//------------------------------------------------------------------------------
+/*! @brief   Take a node from the free list or from the current slab.
+ *
+ *  @return  pointer to the new default constructed node, nullptr if no memory
+ */
+
+    Node<TYPE>* Alloc ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Return a single node to the free list.
+ *
+ *  @param   node        Node allocated by this arena (children are not touched)
+ */
+
+    void Free (Node<TYPE>* node);
+
+//------------------------------------------------------------------------------
+/*! @brief   Release all slabs at once, nodes destructors are not called.
+ */
+
+    void Clean ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Exchange contents of two arenas.
+ *
+ *  @param   obj         Other arena
+ */
+
+    void Swap (NodeArena& obj) noexcept;
+
+//------------------------------------------------------------------------------
+/*! @brief   Take all slabs and free nodes of another arena, nodes are not moved.
+ *
+ *  @param   obj         Other arena, left empty
+ */
+
+    void Merge (NodeArena& obj);
+
+//------------------------------------------------------------------------------
+/*! @brief   Get number of live nodes in the arena.
+ *
+ *  @return  number of nodes
+ */
+
+    size_t getSize () const;
+
+//------------------------------------------------------------------------------
+/*! @brief   Get number of allocated slabs.
+ *
+ *  @return  number of slabs
+ */
+
+    size_t getSlabsNum () const;
+
+/*------------------------------------------------------------------------------
+                   Private functions                                           *
+*///----------------------------------------------------------------------------
+
+private:
+
+//------------------------------------------------------------------------------
+/*! @brief   Allocate a new slab twice as big as the previous one.
+ *
+ *  @return  error code
+ */
+
+    int Expand ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Get size of the slab header aligned for nodes.
+ *
+ *  @return  header size
+ */
+
+    static size_t HeaderSize ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Get pointer to the first node of the slab.
+ *
+ *  @param   slab        Slab
+ *
+ *  @return  pointer to the nodes array
+ */
+
+    static Node<TYPE>* SlabNodes (Slab* slab);
+
+//------------------------------------------------------------------------------
+};
+
+#include "NodeArena.ipp"
+
+#endif // NODEARENA_H_INCLUDED
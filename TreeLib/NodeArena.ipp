@@ -0,0 +1,191 @@
+/*------------------------------------------------------------------------------
+    * File:        NodeArena.ipp                                               *
+    * Description: Functions of the chunked node allocator.                    *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+template <typename TYPE>
+NodeArena<TYPE>::NodeArena () { }
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+NodeArena<TYPE>::~NodeArena ()
+{
+    Clean();
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+Node<TYPE>* NodeArena<TYPE>::Alloc ()
+{
+    Node<TYPE>* node = nullptr;
+
+    if (free_list_ != nullptr)
+    {
+        node = free_list_;
+        free_list_ = free_list_->right_;
+    }
+    else
+    {
+        if ((slabs_ == nullptr) || (slabs_->used_ == slabs_->capacity_))
+            if (Expand()) return nullptr;
+
+        node = SlabNodes(slabs_) + slabs_->used_++;
+    }
+
+    new (node) Node<TYPE>;
+    node->in_arena_ = true;
+
+    ++size_;
+
+    return node;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void NodeArena<TYPE>::Free (Node<TYPE>* node)
+{
+    assert(node != nullptr);
+    assert(node->in_arena_);
+
+    node->left_  = nullptr;
+    node->prev_  = nullptr;
+    node->right_ = free_list_;
+
+    free_list_ = node;
+
+    --size_;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void NodeArena<TYPE>::Clean ()
+{
+    while (slabs_ != nullptr)
+    {
+        Slab* next = slabs_->next_;
+        free(slabs_);
+        slabs_ = next;
+    }
+
+    free_list_ = nullptr;
+    slabs_num_ = 0;
+    size_      = 0;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void NodeArena<TYPE>::Swap (NodeArena& obj) noexcept
+{
+    std::swap(slabs_,     obj.slabs_);
+    std::swap(free_list_, obj.free_list_);
+    std::swap(slabs_num_, obj.slabs_num_);
+    std::swap(size_,      obj.size_);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void NodeArena<TYPE>::Merge (NodeArena& obj)
+{
+    if ((this == &obj) || (obj.slabs_ == nullptr)) return;
+
+    if (slabs_ == nullptr)
+    {
+        Swap(obj);
+        return;
+    }
+
+    Slab* tail = obj.slabs_;
+    while (tail->next_ != nullptr) tail = tail->next_;
+
+    tail->next_   = slabs_->next_;
+    slabs_->next_ = obj.slabs_;
+
+    if (obj.free_list_ != nullptr)
+    {
+        Node<TYPE>* last = obj.free_list_;
+        while (last->right_ != nullptr) last = last->right_;
+
+        last->right_ = free_list_;
+        free_list_   = obj.free_list_;
+    }
+
+    slabs_num_ += obj.slabs_num_;
+    size_      += obj.size_;
+
+    obj.slabs_     = nullptr;
+    obj.free_list_ = nullptr;
+    obj.slabs_num_ = 0;
+    obj.size_      = 0;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+size_t NodeArena<TYPE>::getSize () const
+{
+    return size_;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+size_t NodeArena<TYPE>::getSlabsNum () const
+{
+    return slabs_num_;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+int NodeArena<TYPE>::Expand ()
+{
+    size_t capacity = ARENA_FIRST_SLAB_SIZE;
+    if (slabs_ != nullptr)
+    {
+        capacity = slabs_->capacity_ * 2;
+        if (capacity > ARENA_MAX_SLAB_SIZE) capacity = ARENA_MAX_SLAB_SIZE;
+    }
+
+    Slab* slab = (Slab*)malloc(HeaderSize() + capacity * sizeof(Node<TYPE>));
+    if (slab == nullptr) return 1;
+
+    slab->next_     = slabs_;
+    slab->capacity_ = capacity;
+    slab->used_     = 0;
+
+    slabs_ = slab;
+    ++slabs_num_;
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+size_t NodeArena<TYPE>::HeaderSize ()
+{
+    const size_t align = alignof(Node<TYPE>);
+
+    return (sizeof(Slab) + align - 1) / align * align;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+Node<TYPE>* NodeArena<TYPE>::SlabNodes (Slab* slab)
+{
+    return (Node<TYPE>*)((char*)slab + HeaderSize());
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,227 @@
+/*------------------------------------------------------------------------------
+    * File:        NodeWalk.h                                                  *
+    * Description: Declaration of the iterative tree traversal with an         *
+                   explicit stack.                                             *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+#ifndef NODEWALK_H_INCLUDED
+#define NODEWALK_H_INCLUDED
+
+#define _CRT_SECURE_NO_WARNINGS
+
+
+#include "TreeConfig.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <utility>
+
+
+const size_t WALK_STACK_CAPACITY = 64;
+
+enum WalkOrder
+{
+    WALK_PRE_ORDER                                                  ,
+    WALK_POST_ORDER                                                 ,
+    WALK_LEVEL_ORDER                                                ,
+};
+
+
+template <typename TYPE>
+class Node;
+
+//------------------------------------------------------------------------------
+/*! @brief   Growing array of trivially copyable frames used as a stack or a
+ *           queue by the tree walks. Unlike Stack it has no size limit and
+ *           no checks, every operation is a plain array access.
+ */
+
+template <typename FRAME>
+class WalkStack
+{
+    FRAME* data_     = nullptr;
+    size_t size_     = 0;
+    size_t capacity_ = 0;
+
+public:
+
+    WalkStack ();
+
+   ~WalkStack ();
+
+    WalkStack (const WalkStack& obj) = delete;
+
+    WalkStack& operator = (const WalkStack& obj) = delete;
+
+//------------------------------------------------------------------------------
+/*! @brief   Push frame to the end.
+ *
+ *  @param   frame       Frame
+ */
+
+    void Push (const FRAME& frame);
+
+//------------------------------------------------------------------------------
+/*! @brief   Pop frame from the end.
+ *
+ *  @return  frame
+ */
+
+    FRAME Pop ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Get the last frame.
+ *
+ *  @return  frame
+ */
+
+    FRAME& Top ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Drop first n frames (used when the array works as a queue).
+ *
+ *  @param   n           Number of frames
+ */
+
+    void Shift (size_t n);
+
+//------------------------------------------------------------------------------
+/*! @brief   Drop frames above the given size.
+ *
+ *  @param   size        New size (bigger values are ignored)
+ */
+
+    void Cut (size_t size);
+
+    size_t getSize () const;
+
+    FRAME& operator [] (size_t n);
+
+    const FRAME& operator [] (size_t n) const;
+
+//------------------------------------------------------------------------------
+/*! @brief   Remove all frames, memory is kept.
+ */
+
+    void Clean ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Exchange contents of two arrays.
+ *
+ *  @param   obj         Other array
+ */
+
+    void Swap (WalkStack& obj) noexcept;
+
+private:
+
+//------------------------------------------------------------------------------
+/*! @brief   Increase the array by 2 times, exits with TREE_NO_MEMORY if there
+ *           is no memory.
+ */
+
+#if defined (__GNUC__) || defined (__clang__)
+    __attribute__((noinline))
+#endif
+    void Expand ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Print error explanations to log file and to console.
+ *
+ *  @param   logname     Name of the log file
+ *  @param   file        Name of the file from which this function was called
+ *  @param   line        Line of the code from which this function was called
+ *  @param   function    Name of the function from which this function was called
+ *  @param   err         Error code
+ *  @param   errline     Number of base line with error
+ */
+
+    static void PrintError (const char* logname, const char* file, int line, const char* function, int err, int errline);
+
+//------------------------------------------------------------------------------
+};
+
+//------------------------------------------------------------------------------
+/*! @brief   Iterative walk over the subtree. Next() returns nodes one by one in
+ *           the chosen order, native stack usage does not depend on depth.
+ *           Pre-order keeps a stack of pending nodes with their depths and
+ *           the path to the current node, post-order keeps the path with
+ *           a visit state per node, level-order keeps a queue.
+ */
+
+template <typename TYPE>
+class NodeWalk
+{
+    struct Frame
+    {
+        Node<TYPE>* node;
+        size_t      state;
+    };
+
+    WalkStack<Frame>       frames_;
+    WalkStack<Node<TYPE>*> path_;
+
+    size_t head_   = 0;
+    size_t depth_  = 0;
+    size_t pushed_ = 0;
+
+    int  order_       = WALK_PRE_ORDER;
+    bool right_first_ = true;
+
+public:
+
+//------------------------------------------------------------------------------
+/*! @brief   Walk constructor.
+ *
+ *  @param   root        Root of the subtree to walk (may be nullptr)
+ *  @param   order       Walk order (WalkOrder)
+ *  @param   right_first Visit right child before the left one (base file order)
+ */
+
+    NodeWalk (Node<TYPE>* root, int order = WALK_PRE_ORDER, bool right_first = true);
+
+//------------------------------------------------------------------------------
+/*! @brief   Get the next node of the walk.
+ *
+ *  @return  node, nullptr if the walk is over
+ */
+
+    Node<TYPE>* Next ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Do not descend into the children of the node just returned
+ *           (pre-order only).
+ */
+
+    void Skip ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Get depth of the node just returned relative to the walk root.
+ *
+ *  @return  depth
+ */
+
+    size_t getDepth () const;
+
+//------------------------------------------------------------------------------
+/*! @brief   Get ancestor of the node just returned (pre- and post-order only).
+ *
+ *  @param   depth       Depth of the ancestor, less than getDepth()
+ *
+ *  @return  ancestor
+ */
+
+    Node<TYPE>* getAncestor (size_t depth) const;
+
+//------------------------------------------------------------------------------
+};
+
+#include "NodeWalk.ipp"
+
+#endif // NODEWALK_H_INCLUDED
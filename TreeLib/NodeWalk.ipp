@@ -0,0 +1,272 @@
+/*------------------------------------------------------------------------------
+    * File:        NodeWalk.ipp                                                *
+    * Description: Functions of the iterative tree traversal.                  *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+template <typename FRAME>
+WalkStack<FRAME>::WalkStack () { }
+
+//------------------------------------------------------------------------------
+
+template <typename FRAME>
+WalkStack<FRAME>::~WalkStack ()
+{
+    free(data_);
+    data_ = nullptr;
+
+    size_     = 0;
+    capacity_ = 0;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename FRAME>
+void WalkStack<FRAME>::Push (const FRAME& frame)
+{
+    if (size_ == capacity_) Expand();
+
+    data_[size_++] = frame;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename FRAME>
+void WalkStack<FRAME>::Expand ()
+{
+    size_t capacity = (capacity_ == 0) ? WALK_STACK_CAPACITY : capacity_ * 2;
+
+    FRAME* temp = (FRAME*)realloc(data_, capacity * sizeof(FRAME));
+    TREE_ASSERTOK((temp == nullptr), TREE_NO_MEMORY, -1);
+
+    data_     = temp;
+    capacity_ = capacity;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename FRAME>
+FRAME WalkStack<FRAME>::Pop ()
+{
+    assert(size_ > 0);
+
+    return data_[--size_];
+}
+
+//------------------------------------------------------------------------------
+
+template <typename FRAME>
+FRAME& WalkStack<FRAME>::Top ()
+{
+    assert(size_ > 0);
+
+    return data_[size_ - 1];
+}
+
+//------------------------------------------------------------------------------
+
+template <typename FRAME>
+void WalkStack<FRAME>::Shift (size_t n)
+{
+    assert(n <= size_);
+
+    memmove(data_, data_ + n, (size_ - n) * sizeof(FRAME));
+    size_ -= n;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename FRAME>
+void WalkStack<FRAME>::Cut (size_t size)
+{
+    if (size < size_) size_ = size;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename FRAME>
+size_t WalkStack<FRAME>::getSize () const
+{
+    return size_;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename FRAME>
+FRAME& WalkStack<FRAME>::operator [] (size_t n)
+{
+    assert(n < size_);
+
+    return data_[n];
+}
+
+//------------------------------------------------------------------------------
+
+template <typename FRAME>
+const FRAME& WalkStack<FRAME>::operator [] (size_t n) const
+{
+    assert(n < size_);
+
+    return data_[n];
+}
+
+//------------------------------------------------------------------------------
+
+template <typename FRAME>
+void WalkStack<FRAME>::Clean ()
+{
+    size_ = 0;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename FRAME>
+void WalkStack<FRAME>::Swap (WalkStack& obj) noexcept
+{
+    std::swap(data_,     obj.data_);
+    std::swap(size_,     obj.size_);
+    std::swap(capacity_, obj.capacity_);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename FRAME>
+void WalkStack<FRAME>::PrintError (const char* logname, const char* file, int line, const char* function, int err, int errline)
+{
+    assert(function != nullptr);
+    assert(logname  != nullptr);
+    assert(file     != nullptr);
+
+    FILE* log = fopen(logname, "a");
+    assert(log != nullptr);
+
+    fprintf(log, "********************************************************************************\n");
+    fprintf(log, "ERROR: file %s  line %d  function %s\n\n", file, line, function);
+    fprintf(log, "%s\n", tree_errstr[err + 1]);
+    if (errline != -1) fprintf(log, "line %d\n", errline + 1);
+
+    printf("ERROR: file %s  line %d  function %s\n", file, line, function);
+    printf("%s\n\n", tree_errstr[err + 1]);
+    if (errline != -1) printf("line %d\n", errline + 1);
+
+    fclose(log);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+NodeWalk<TYPE>::NodeWalk (Node<TYPE>* root, int order, bool right_first) :
+    order_       (order),
+    right_first_ (right_first)
+{
+    if (root != nullptr) frames_.Push({ root, 0 });
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+Node<TYPE>* NodeWalk<TYPE>::Next ()
+{
+    if (order_ == WALK_LEVEL_ORDER)
+    {
+        if (head_ == frames_.getSize()) return nullptr;
+
+        if ((head_ >= WALK_STACK_CAPACITY) && (head_ * 2 >= frames_.getSize()))
+        {
+            frames_.Shift(head_);
+            head_ = 0;
+        }
+
+        Frame frame = frames_[head_++];
+        Node<TYPE>* first  = right_first_ ? frame.node->right_ : frame.node->left_;
+        Node<TYPE>* second = right_first_ ? frame.node->left_  : frame.node->right_;
+
+        if (first  != nullptr) frames_.Push({ first,  frame.state + 1 });
+        if (second != nullptr) frames_.Push({ second, frame.state + 1 });
+
+        depth_ = frame.state;
+
+        return frame.node;
+    }
+
+    if (order_ == WALK_PRE_ORDER)
+    {
+        if (frames_.getSize() == 0) return nullptr;
+
+        Frame frame = frames_.Pop();
+        Node<TYPE>* first  = right_first_ ? frame.node->right_ : frame.node->left_;
+        Node<TYPE>* second = right_first_ ? frame.node->left_  : frame.node->right_;
+
+        pushed_ = 0;
+        if (second != nullptr) { frames_.Push({ second, frame.state + 1 }); ++pushed_; }
+        if (first  != nullptr) { frames_.Push({ first,  frame.state + 1 }); ++pushed_; }
+
+        path_.Cut(frame.state);
+        path_.Push(frame.node);
+
+        depth_ = frame.state;
+
+        return frame.node;
+    }
+
+    while (frames_.getSize() > 0)
+    {
+        Frame& top = frames_.Top();
+        Node<TYPE>* node  = top.node;
+        Node<TYPE>* child = nullptr;
+
+        if (top.state < 2)
+        {
+            child = ((top.state == 0) == right_first_) ? node->right_ : node->left_;
+            ++top.state;
+
+            if (child != nullptr) frames_.Push({ child, 0 });
+            continue;
+        }
+
+        frames_.Pop();
+
+        depth_ = frames_.getSize();
+        return node;
+    }
+
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void NodeWalk<TYPE>::Skip ()
+{
+    assert(order_ == WALK_PRE_ORDER);
+
+    frames_.Cut(frames_.getSize() - pushed_);
+    pushed_ = 0;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+size_t NodeWalk<TYPE>::getDepth () const
+{
+    return depth_;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+Node<TYPE>* NodeWalk<TYPE>::getAncestor (size_t depth) const
+{
+    assert(order_ != WALK_LEVEL_ORDER);
+    assert(depth < depth_);
+
+    if (order_ == WALK_PRE_ORDER) return path_[depth];
+
+    return frames_[depth].node;
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,338 @@
+/*------------------------------------------------------------------------------
+    * File:        PersistentTree.h                                            *
+    * Description: Declaration of the persistent tree, versions share the      *
+                   nodes they did not change.                                  *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+#ifndef PERSISTENTTREE_H_INCLUDED
+#define PERSISTENTTREE_H_INCLUDED
+
+#define _CRT_SECURE_NO_WARNINGS
+
+
+#include "Tree.h"
+#include <atomic>
+
+
+#define newPersistentTree(NAME, TREE_TYPE) \
+        PersistentTree<TREE_TYPE> NAME ((char*)#NAME);
+
+#define newPersistentTree_tree(NAME, tree, TREE_TYPE) \
+        PersistentTree<TREE_TYPE> NAME ((char*)#NAME, tree);
+
+
+//------------------------------------------------------------------------------
+/*! @brief   Node shared by tree versions, never changed after it is made. It
+ *           counts the parents and versions holding it. It has no previous
+ *           node and depth: a shared node has a parent in every version, the
+ *           path from findPath gives them instead.
+ */
+
+template <typename TYPE>
+struct PersistentNode
+{
+    TYPE data_ = POISON<TYPE>;
+
+    const PersistentNode* left_  = nullptr;
+    const PersistentNode* right_ = nullptr;
+
+    mutable std::atomic<size_t> refs_ { 1 };
+};
+
+//------------------------------------------------------------------------------
+/*! @brief   Persistent tree. Copying the tree makes a snapshot in O(1), the
+ *           versions share all nodes. A change copies only the path from the
+ *           root to the changed node, so the other versions do not see it.
+ *           Nodes are freed with the last version holding them.
+ *
+ *  @note    Versions sharing nodes may live in different threads, one version
+ *           is used by one thread at a time. Strings of char* trees are
+ *           shared by the versions through their string arenas.
+ */
+
+template <typename TYPE>
+class PersistentTree
+{
+    int errCode_ = 0;
+
+    const PersistentNode<TYPE>* root_ = nullptr;
+    size_t size_ = 0;
+
+    StringArena strings_;
+
+public:
+
+    char* name_ = nullptr;
+
+//------------------------------------------------------------------------------
+/*! @brief   Empty tree constructor.
+ *
+ *  @param   tree_name   Tree variable name
+ */
+
+    PersistentTree (char* tree_name);
+
+//------------------------------------------------------------------------------
+/*! @brief   Tree constructor from a linked tree.
+ *
+ *  @param   tree_name   Tree variable name
+ *  @param   tree        Source tree
+ */
+
+    PersistentTree (char* tree_name, const Tree<TYPE>& tree);
+
+//------------------------------------------------------------------------------
+/*! @brief   Snapshot constructor, the nodes are shared, not copied.
+ *
+ *  @param   obj         Source tree
+ */
+
+    PersistentTree (const PersistentTree& obj);
+
+//------------------------------------------------------------------------------
+/*! @brief   Make this tree a snapshot of another one, own nodes are released.
+ *
+ *  @param   obj         Source tree
+ *
+ *  @return  this tree
+ */
+
+    PersistentTree& operator = (const PersistentTree& obj);
+
+//------------------------------------------------------------------------------
+/*! @brief   Tree destructor, the nodes are freed with the last version.
+ */
+
+   ~PersistentTree ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Exchange contents of two trees.
+ *
+ *  @param   obj         Other tree
+ */
+
+    void Swap (PersistentTree& obj) noexcept;
+
+//------------------------------------------------------------------------------
+/*! @brief   Release all nodes, the tree becomes empty.
+ */
+
+    void Clean ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Get root of the tree.
+ *
+ *  @return  root node, nullptr if the tree is empty
+ */
+
+    const PersistentNode<TYPE>* getRoot () const;
+
+//------------------------------------------------------------------------------
+/*! @brief   Get number of nodes.
+ *
+ *  @return  number of nodes
+ */
+
+    size_t getSize () const;
+
+//------------------------------------------------------------------------------
+/*! @brief   Find path in the tree to the leaf with the element.
+ *
+ *  @param   path        Path to the element (node addresses from the root)
+ *  @param   elem        Data of node
+ *
+ *  @return  1 if found, 0 if not
+ */
+
+    template <size_t INLINE, typename POLICY>
+    bool findPath (Stack<size_t, INLINE, POLICY>& path, TYPE elem) const;
+
+//------------------------------------------------------------------------------
+/*! @brief   Visit the nodes in pre-order, right child first.
+ *
+ *  @param   func        Function taking a node and its depth
+ */
+
+    template <typename FUNC>
+    void Walk (FUNC func) const;
+
+//------------------------------------------------------------------------------
+/*! @brief   Change data of the node.
+ *
+ *  @param   path        Path from the root to the node
+ *  @param   data        New data
+ *
+ *  @return  error code, TREE_WRONG_PATH if the path is not in this version
+ */
+
+    template <size_t INLINE, typename POLICY>
+    int setData (Stack<size_t, INLINE, POLICY>& path, TYPE data);
+
+//------------------------------------------------------------------------------
+/*! @brief   Create right child of the node.
+ *
+ *  @param   path        Path from the root to the node, empty to add the
+ *                       root to an empty tree
+ *  @param   data        Data of the child
+ *
+ *  @return  error code, TREE_WRONG_PATH if the path is not in this version
+ *           or the child exists
+ */
+
+    template <size_t INLINE, typename POLICY>
+    int addRight (Stack<size_t, INLINE, POLICY>& path, TYPE data);
+
+//------------------------------------------------------------------------------
+/*! @brief   Create left child of the node.
+ *
+ *  @param   path        Path from the root to the node, empty to add the
+ *                       root to an empty tree
+ *  @param   data        Data of the child
+ *
+ *  @return  error code, TREE_WRONG_PATH if the path is not in this version
+ *           or the child exists
+ */
+
+    template <size_t INLINE, typename POLICY>
+    int addLeft (Stack<size_t, INLINE, POLICY>& path, TYPE data);
+
+//------------------------------------------------------------------------------
+/*! @brief   Turn the leaf into a node with the data and two children: the old
+ *           leaf and the new one.
+ *
+ *  @param   path        Path from the root to the leaf
+ *  @param   data        Data of the node replacing the leaf
+ *  @param   leaf        Data of the new leaf
+ *  @param   right       Put the new leaf to the right, the old one to the left
+ *
+ *  @return  error code, TREE_WRONG_PATH if the path is not in this version
+ *           or does not end with a leaf
+ */
+
+    template <size_t INLINE, typename POLICY>
+    int splitLeaf (Stack<size_t, INLINE, POLICY>& path, TYPE data, TYPE leaf, bool right = true);
+
+//------------------------------------------------------------------------------
+/*! @brief   Delete the node with its subtree.
+ *
+ *  @param   path        Path from the root to the node
+ *
+ *  @return  error code, TREE_WRONG_PATH if the path is not in this version
+ */
+
+    template <size_t INLINE, typename POLICY>
+    int deleteNode (Stack<size_t, INLINE, POLICY>& path);
+
+//------------------------------------------------------------------------------
+/*! @brief   Build a linked tree from this version, previous nodes and depths
+ *           are restored.
+ *
+ *  @param   tree        Destination tree, its nodes are replaced
+ */
+
+    void toTree (Tree<TYPE>& tree) const;
+
+//------------------------------------------------------------------------------
+/*! @brief   Print error explanations to log file and to console.
+ *
+ *  @param   logname     Name of the log file
+ *  @param   file        Name of the file from which this function was called
+ *  @param   line        Line of the code from which this function was called
+ *  @param   function    Name of the function from which this function was called
+ *  @param   err         Error code
+ *  @param   errline     Number of base line with error
+ */
+
+    void PrintError (const char* logname, const char* file, int line, const char* function, int err, int errline);
+
+/*------------------------------------------------------------------------------
+                   Private functions                                           *
+*///----------------------------------------------------------------------------
+
+private:
+
+//------------------------------------------------------------------------------
+/*! @brief   Make a node, char* data is copied to the tree arena.
+ *
+ *  @param   data        Node data
+ *
+ *  @return  pointer to the node
+ */
+
+    PersistentNode<TYPE>* newNode (TYPE data);
+
+//------------------------------------------------------------------------------
+/*! @brief   Make a node with the same data as the given one, the data is
+ *           shared, not copied.
+ *
+ *  @param   node        Source node
+ *
+ *  @return  pointer to the node without children
+ */
+
+    PersistentNode<TYPE>* copyNode (const PersistentNode<TYPE>* node);
+
+//------------------------------------------------------------------------------
+/*! @brief   Check that the path goes from the root of this version.
+ *
+ *  @param   path        Path of node addresses
+ *
+ *  @return  1 if the path is valid, else 0
+ */
+
+    template <size_t INLINE, typename POLICY>
+    bool isValid (Stack<size_t, INLINE, POLICY>& path) const;
+
+//------------------------------------------------------------------------------
+/*! @brief   Copy the path above the replaced node and release the old root.
+ *
+ *  @param   path        Valid path, its last node is replaced
+ *  @param   node        Replacing node, nullptr to unlink
+ */
+
+    template <size_t INLINE, typename POLICY>
+    void Rebuild (Stack<size_t, INLINE, POLICY>& path, const PersistentNode<TYPE>* node);
+
+//------------------------------------------------------------------------------
+/*! @brief   Add a child to the node.
+ *
+ *  @param   path        Path from the root to the parent
+ *  @param   data        Data of the child
+ *  @param   right       Add the right child
+ *
+ *  @return  error code
+ */
+
+    template <size_t INLINE, typename POLICY>
+    int addChild (Stack<size_t, INLINE, POLICY>& path, TYPE data, bool right);
+
+//------------------------------------------------------------------------------
+/*! @brief   Take one more reference to the node.
+ *
+ *  @param   node        Node (may be nullptr)
+ *
+ *  @return  the node
+ */
+
+    static const PersistentNode<TYPE>* Hold (const PersistentNode<TYPE>* node);
+
+//------------------------------------------------------------------------------
+/*! @brief   Drop a reference to the node, the nodes left without references
+ *           are freed.
+ *
+ *  @param   node        Node (may be nullptr)
+ */
+
+    static void Release (const PersistentNode<TYPE>* node);
+
+//------------------------------------------------------------------------------
+};
+
+#include "PersistentTree.ipp"
+
+#endif // PERSISTENTTREE_H_INCLUDED
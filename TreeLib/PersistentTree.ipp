@@ -0,0 +1,557 @@
+/*------------------------------------------------------------------------------
+    * File:        PersistentTree.ipp                                          *
+    * Description: Functions of the persistent tree.                           *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+/*------------------------------------------------------------------------------
+    Every node counts its references: parents in all versions and versions
+    having it as the root. A change makes new nodes for the path, each new
+    node holds the old child it shares, then the version drops the old root.
+    If no other version holds the old path, it is freed right away, and the
+    shared children go back to their old counts.
+*///----------------------------------------------------------------------------
+
+template <typename TYPE>
+PersistentTree<TYPE>::PersistentTree (char* tree_name) :
+    errCode_ (TREE_OK),
+    name_    (tree_name)
+{
+    TREE_ASSERTOK((tree_name == nullptr), TREE_WRONG_INPUT_TREE_NAME, -1);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+PersistentTree<TYPE>::PersistentTree (char* tree_name, const Tree<TYPE>& tree) :
+    errCode_ (TREE_OK),
+    name_    (tree_name)
+{
+    TREE_ASSERTOK((tree_name == nullptr), TREE_WRONG_INPUT_TREE_NAME, -1);
+
+    if (tree.root_ == nullptr) return;
+
+    struct Frame
+    {
+        const Node<TYPE>*     node;
+        PersistentNode<TYPE>* prev;
+        bool                  right;
+    };
+
+    WalkStack<Frame> frames;
+    frames.Push({ tree.root_, nullptr, false });
+
+    while (frames.getSize() > 0)
+    {
+        Frame frame = frames.Pop();
+
+        PersistentNode<TYPE>* node = newNode(frame.node->data_);
+        ++size_;
+
+        if (frame.prev == nullptr) root_ = node;
+        else if (frame.right)      frame.prev->right_ = node;
+        else                       frame.prev->left_  = node;
+
+        if (frame.node->left_  != nullptr) frames.Push({ frame.node->left_,  node, false });
+        if (frame.node->right_ != nullptr) frames.Push({ frame.node->right_, node, true  });
+    }
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+PersistentTree<TYPE>::PersistentTree (const PersistentTree& obj) :
+    errCode_ (obj.errCode_),
+    root_    (Hold(obj.root_)),
+    size_    (obj.size_),
+    strings_ (obj.strings_),
+    name_    (obj.name_)
+{ }
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+PersistentTree<TYPE>& PersistentTree<TYPE>::operator = (const PersistentTree& obj)
+{
+    if (this == &obj) return *this;
+
+    PersistentTree<TYPE> temp(obj);
+    Swap(temp);
+
+    name_ = temp.name_;
+
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+PersistentTree<TYPE>::~PersistentTree ()
+{
+    Clean();
+
+    errCode_ = TREE_DESTRUCTED;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void PersistentTree<TYPE>::Swap (PersistentTree& obj) noexcept
+{
+    std::swap(errCode_, obj.errCode_);
+    std::swap(root_,    obj.root_);
+    std::swap(size_,    obj.size_);
+    std::swap(name_,    obj.name_);
+
+    strings_.Swap(obj.strings_);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void PersistentTree<TYPE>::Clean ()
+{
+    Release(root_);
+
+    root_ = nullptr;
+    size_ = 0;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+const PersistentNode<TYPE>* PersistentTree<TYPE>::getRoot () const
+{
+    return root_;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+size_t PersistentTree<TYPE>::getSize () const
+{
+    return size_;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+template <size_t INLINE, typename POLICY>
+bool PersistentTree<TYPE>::findPath (Stack<size_t, INLINE, POLICY>& path, TYPE elem) const
+{
+    assert(not isPOISON(elem));
+
+    struct Frame
+    {
+        const PersistentNode<TYPE>* node;
+        size_t                      depth;
+    };
+
+    WalkStack<Frame> frames;
+    WalkStack<const PersistentNode<TYPE>*> line;
+
+    if (root_ != nullptr) frames.Push({ root_, 0 });
+
+    while (frames.getSize() > 0)
+    {
+        Frame frame = frames.Pop();
+        const PersistentNode<TYPE>* node = frame.node;
+
+        line.Cut(frame.depth);
+        line.Push(node);
+
+        if ((node->left_ == nullptr) && (node->right_ == nullptr))
+        {
+            bool found = false;
+            if constexpr (std::is_same<TYPE, char*>::value)
+                found = (strcmp(elem, node->data_) == 0);
+            else
+                found = (elem == node->data_);
+
+            if (not found) continue;
+
+            path.Reserve(path.getSize() + line.getSize());
+
+            for (size_t i = 0; i < line.getSize(); ++i)
+                path.Push((size_t)line[i]);
+
+            return true;
+        }
+
+        if (node->left_  != nullptr) frames.Push({ node->left_,  frame.depth + 1 });
+        if (node->right_ != nullptr) frames.Push({ node->right_, frame.depth + 1 });
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+template <typename FUNC>
+void PersistentTree<TYPE>::Walk (FUNC func) const
+{
+    struct Frame
+    {
+        const PersistentNode<TYPE>* node;
+        size_t                      depth;
+    };
+
+    WalkStack<Frame> frames;
+
+    if (root_ != nullptr) frames.Push({ root_, 0 });
+
+    while (frames.getSize() > 0)
+    {
+        Frame frame = frames.Pop();
+
+        func(frame.node, frame.depth);
+
+        if (frame.node->left_  != nullptr) frames.Push({ frame.node->left_,  frame.depth + 1 });
+        if (frame.node->right_ != nullptr) frames.Push({ frame.node->right_, frame.depth + 1 });
+    }
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+template <size_t INLINE, typename POLICY>
+int PersistentTree<TYPE>::setData (Stack<size_t, INLINE, POLICY>& path, TYPE data)
+{
+    TREE_ASSERTOK((isPOISON(data)), TREE_INPUT_DATA_POISON, -1);
+
+    if (not isValid(path)) return TREE_WRONG_PATH;
+
+    const PersistentNode<TYPE>* old = (const PersistentNode<TYPE>*)path[path.getSize() - 1];
+
+    PersistentNode<TYPE>* node = newNode(data);
+    node->left_  = Hold(old->left_);
+    node->right_ = Hold(old->right_);
+
+    Rebuild(path, node);
+
+    return TREE_OK;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+template <size_t INLINE, typename POLICY>
+int PersistentTree<TYPE>::addRight (Stack<size_t, INLINE, POLICY>& path, TYPE data)
+{
+    return addChild(path, data, true);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+template <size_t INLINE, typename POLICY>
+int PersistentTree<TYPE>::addLeft (Stack<size_t, INLINE, POLICY>& path, TYPE data)
+{
+    return addChild(path, data, false);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+template <size_t INLINE, typename POLICY>
+int PersistentTree<TYPE>::addChild (Stack<size_t, INLINE, POLICY>& path, TYPE data, bool right)
+{
+    TREE_ASSERTOK((isPOISON(data)), TREE_INPUT_DATA_POISON, -1);
+
+    if (path.getSize() == 0)
+    {
+        if (root_ != nullptr) return TREE_WRONG_PATH;
+
+        root_ = newNode(data);
+        size_ = 1;
+
+        return TREE_OK;
+    }
+
+    if (not isValid(path)) return TREE_WRONG_PATH;
+
+    const PersistentNode<TYPE>* old = (const PersistentNode<TYPE>*)path[path.getSize() - 1];
+    if (((right) ? old->right_ : old->left_) != nullptr) return TREE_WRONG_PATH;
+
+    PersistentNode<TYPE>* node = copyNode(old);
+
+    if (right)
+    {
+        node->right_ = newNode(data);
+        node->left_  = Hold(old->left_);
+    }
+    else
+    {
+        node->left_  = newNode(data);
+        node->right_ = Hold(old->right_);
+    }
+
+    Rebuild(path, node);
+    ++size_;
+
+    return TREE_OK;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+template <size_t INLINE, typename POLICY>
+int PersistentTree<TYPE>::splitLeaf (Stack<size_t, INLINE, POLICY>& path, TYPE data, TYPE leaf, bool right)
+{
+    TREE_ASSERTOK((isPOISON(data)), TREE_INPUT_DATA_POISON, -1);
+    TREE_ASSERTOK((isPOISON(leaf)), TREE_INPUT_DATA_POISON, -1);
+
+    if (not isValid(path)) return TREE_WRONG_PATH;
+
+    const PersistentNode<TYPE>* old = (const PersistentNode<TYPE>*)path[path.getSize() - 1];
+    if ((old->left_ != nullptr) || (old->right_ != nullptr)) return TREE_WRONG_PATH;
+
+    PersistentNode<TYPE>* node = newNode(data);
+
+    if (right)
+    {
+        node->right_ = newNode(leaf);
+        node->left_  = Hold(old);
+    }
+    else
+    {
+        node->left_  = newNode(leaf);
+        node->right_ = Hold(old);
+    }
+
+    Rebuild(path, node);
+    size_ += 2;
+
+    return TREE_OK;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+template <size_t INLINE, typename POLICY>
+int PersistentTree<TYPE>::deleteNode (Stack<size_t, INLINE, POLICY>& path)
+{
+    if (not isValid(path)) return TREE_WRONG_PATH;
+
+    const PersistentNode<TYPE>* old = (const PersistentNode<TYPE>*)path[path.getSize() - 1];
+
+    size_t removed = 0;
+    WalkStack<const PersistentNode<TYPE>*> nodes;
+    nodes.Push(old);
+
+    while (nodes.getSize() > 0)
+    {
+        const PersistentNode<TYPE>* cur = nodes.Pop();
+        ++removed;
+
+        if (cur->left_  != nullptr) nodes.Push(cur->left_);
+        if (cur->right_ != nullptr) nodes.Push(cur->right_);
+    }
+
+    Rebuild(path, nullptr);
+    size_ -= removed;
+
+    return TREE_OK;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void PersistentTree<TYPE>::toTree (Tree<TYPE>& tree) const
+{
+    tree.Clean();
+    if (root_ == nullptr) return;
+
+    struct Frame
+    {
+        const PersistentNode<TYPE>* node;
+        Node<TYPE>*                 prev;
+        bool                        right;
+    };
+
+    WalkStack<Frame> frames;
+    frames.Push({ root_, nullptr, false });
+
+    while (frames.getSize() > 0)
+    {
+        Frame frame = frames.Pop();
+        Node<TYPE>* node = tree.newNode();
+
+        if constexpr (std::is_same<TYPE, char*>::value)
+        {
+            if (frame.node->data_ != nullptr)
+            {
+                node->data_     = tree.strings_.Copy(frame.node->data_);
+                node->in_store_ = true;
+            }
+        }
+        else node->data_ = frame.node->data_;
+
+        if (frame.prev == nullptr) tree.root_ = node;
+        else
+        {
+            node->prev_  = frame.prev;
+            node->depth_ = frame.prev->depth_ + 1;
+
+            if (frame.right) frame.prev->right_ = node;
+            else             frame.prev->left_  = node;
+        }
+
+        if (frame.node->left_  != nullptr) frames.Push({ frame.node->left_,  node, false });
+        if (frame.node->right_ != nullptr) frames.Push({ frame.node->right_, node, true  });
+    }
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+PersistentNode<TYPE>* PersistentTree<TYPE>::newNode (TYPE data)
+{
+    PersistentNode<TYPE>* node = new (std::nothrow) PersistentNode<TYPE>;
+    TREE_ASSERTOK((node == nullptr), TREE_NO_MEMORY, -1);
+
+    if constexpr (std::is_same<TYPE, char*>::value)
+    {
+        if (data != nullptr)
+        {
+            data = strings_.Copy(data);
+            TREE_ASSERTOK((data == nullptr), TREE_NO_MEMORY, -1);
+        }
+    }
+
+    node->data_ = data;
+
+    return node;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+PersistentNode<TYPE>* PersistentTree<TYPE>::copyNode (const PersistentNode<TYPE>* node)
+{
+    PersistentNode<TYPE>* copy = new (std::nothrow) PersistentNode<TYPE>;
+    TREE_ASSERTOK((copy == nullptr), TREE_NO_MEMORY, -1);
+
+    copy->data_ = node->data_;
+
+    return copy;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+template <size_t INLINE, typename POLICY>
+bool PersistentTree<TYPE>::isValid (Stack<size_t, INLINE, POLICY>& path) const
+{
+    if (path.getSize() == 0) return false;
+
+    const PersistentNode<TYPE>* node = root_;
+    if ((node == nullptr) || ((size_t)node != path[0])) return false;
+
+    for (size_t i = 1; i < path.getSize(); ++i)
+    {
+        if      ((size_t)node->right_ == path[i]) node = node->right_;
+        else if ((size_t)node->left_  == path[i]) node = node->left_;
+        else return false;
+
+        if (node == nullptr) return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+template <size_t INLINE, typename POLICY>
+void PersistentTree<TYPE>::Rebuild (Stack<size_t, INLINE, POLICY>& path, const PersistentNode<TYPE>* node)
+{
+    const PersistentNode<TYPE>* child = node;
+
+    for (size_t i = path.getSize(); i-- > 1; )
+    {
+        const PersistentNode<TYPE>* old = (const PersistentNode<TYPE>*)path[i - 1];
+
+        PersistentNode<TYPE>* copy = copyNode(old);
+
+        if ((size_t)old->right_ == path[i])
+        {
+            copy->right_ = child;
+            copy->left_  = Hold(old->left_);
+        }
+        else
+        {
+            copy->left_  = child;
+            copy->right_ = Hold(old->right_);
+        }
+
+        child = copy;
+    }
+
+    Release(root_);
+    root_ = child;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+const PersistentNode<TYPE>* PersistentTree<TYPE>::Hold (const PersistentNode<TYPE>* node)
+{
+    if (node != nullptr) node->refs_.fetch_add(1, std::memory_order_relaxed);
+
+    return node;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void PersistentTree<TYPE>::Release (const PersistentNode<TYPE>* node)
+{
+    if (node == nullptr) return;
+
+    WalkStack<const PersistentNode<TYPE>*> nodes;
+    nodes.Push(node);
+
+    while (nodes.getSize() > 0)
+    {
+        const PersistentNode<TYPE>* cur = nodes.Pop();
+
+        if (cur->refs_.fetch_sub(1, std::memory_order_acq_rel) != 1) continue;
+
+        if (cur->left_  != nullptr) nodes.Push(cur->left_);
+        if (cur->right_ != nullptr) nodes.Push(cur->right_);
+
+        delete cur;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void PersistentTree<TYPE>::PrintError (const char* logname, const char* file, int line, const char* function, int err, int errline)
+{
+    assert(function != nullptr);
+    assert(logname  != nullptr);
+    assert(file     != nullptr);
+
+    FILE* log = fopen(logname, "a");
+    assert(log != nullptr);
+
+    fprintf(log, "********************************************************************************\n");
+    fprintf(log, "ERROR: file %s  line %d  function %s\n\n", file, line, function);
+    fprintf(log, "%s\n", tree_errstr[err + 1]);
+    if (errline != -1) fprintf(log, "line %d\n", errline + 1);
+
+    printf("ERROR: file %s  line %d  function %s\n", file, line, function);
+    printf("%s\n\n", tree_errstr[err + 1]);
+    if (errline != -1) printf("line %d\n", errline + 1);
+
+    fclose(log);
+}
+
+//------------------------------------------------------------------------------
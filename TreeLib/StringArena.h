@@ -0,0 +1,220 @@
+/*------------------------------------------------------------------------------
+    * File:        StringArena.h                                               *
+    * Description: Declaration of the string storage of char* trees.           *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+#ifndef STRINGARENA_H_INCLUDED
+#define STRINGARENA_H_INCLUDED
+
+#define _CRT_SECURE_NO_WARNINGS
+
+
+#include "../StringLib/StringLib.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <utility>
+
+
+const size_t STRING_ARENA_BLOCK_SIZE = 65536;
+
+
+class StringArena
+{
+    struct Block
+    {
+        Block* next_ = nullptr;
+        size_t size_ = 0;
+    };
+
+    struct Buffer
+    {
+        Buffer* next_   = nullptr;
+        char*   data_   = nullptr;
+        size_t  size_   = 0;
+        bool    mapped_ = false;
+    };
+
+    struct Store
+    {
+        std::atomic<size_t> refs_ { 1 };
+
+        Store*  parent_  = nullptr;
+        Block*  blocks_  = nullptr;
+        Buffer* buffers_ = nullptr;
+
+        size_t  used_    = 0;
+        size_t  size_    = 0;
+    };
+
+    Store* store_ = nullptr;
+
+public:
+
+//------------------------------------------------------------------------------
+/*! @brief   String arena default constructor.
+ */
+
+    StringArena ();
+
+//------------------------------------------------------------------------------
+/*! @brief   String arena copy constructor, the strings are shared, not copied.
+ *
+ *  @param   obj         Source arena
+ */
+
+    StringArena (const StringArena& obj);
+
+//------------------------------------------------------------------------------
+/*! @brief   Share the strings of another arena, own strings are released.
+ *
+ *  @param   obj         Source arena
+ *
+ *  @return  this arena
+ */
+
+    StringArena& operator = (const StringArena& obj);
+
+//------------------------------------------------------------------------------
+/*! @brief   String arena destructor, the strings are released with the last
+ *           arena sharing them.
+ */
+
+   ~StringArena ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Copy the string to the arena.
+ *
+ *  @param   str         C string (may be nullptr)
+ *
+ *  @return  copy of the string, nullptr if str is nullptr or no memory
+ */
+
+    char* Copy (const char* str);
+
+//------------------------------------------------------------------------------
+/*! @brief   Copy the string of known length to the arena.
+ *
+ *  @param   str         String
+ *  @param   len         Length of the string
+ *
+ *  @return  '\0' terminated copy of the string, nullptr if no memory
+ */
+
+    char* Copy (const char* str, size_t len);
+
+//------------------------------------------------------------------------------
+/*! @brief   Keep the string: it is returned as is if it lies in a buffer
+ *           adopted by the arena (or shared with it), else it is copied.
+ *
+ *  @param   str         '\0' terminated string
+ *  @param   len         Length of the string
+ *
+ *  @return  kept string, nullptr if no memory
+ *
+ *  @note    Strings of adopted buffers are not copied, so several threads may
+ *           keep them at the same time.
+ */
+
+    char* Keep (char* str, size_t len);
+
+//------------------------------------------------------------------------------
+/*! @brief   Take the text buffer, it is released with the arena. The lines of
+ *           the text stay readable. The text keeps the buffer if no memory.
+ *
+ *  @param   text        Text read from a file
+ */
+
+    void Adopt (Text& text);
+
+//------------------------------------------------------------------------------
+/*! @brief   Take the file data, it is released with the arena.
+ *
+ *  @param   file        Mapped file, left empty
+ *
+ *  @return  pointer to the file data, nullptr if no memory (the file keeps
+ *           the data)
+ */
+
+    char* Adopt (MappedFile& file);
+
+//------------------------------------------------------------------------------
+/*! @brief   Take all strings of another arena, they are not moved.
+ *
+ *  @param   obj         Other arena, its strings must not be shared, left empty
+ *
+ *  @return  error code
+ */
+
+    int Merge (StringArena& obj);
+
+//------------------------------------------------------------------------------
+/*! @brief   Drop all strings of the arena.
+ */
+
+    void Clean ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Exchange contents of two arenas.
+ *
+ *  @param   obj         Other arena
+ */
+
+    void Swap (StringArena& obj) noexcept;
+
+//------------------------------------------------------------------------------
+/*! @brief   Get size of copied strings and adopted buffers of the arena
+ *           (strings shared from other arenas are not counted).
+ *
+ *  @return  size in bytes
+ */
+
+    size_t getSize () const;
+
+/*------------------------------------------------------------------------------
+                   Private functions                                           *
+*///----------------------------------------------------------------------------
+
+private:
+
+//------------------------------------------------------------------------------
+/*! @brief   Get the store that is not shared with other arenas, the shared
+ *           one stays alive as its parent.
+ *
+ *  @return  own store, nullptr if no memory
+ */
+
+    Store* Own ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Take the buffer, it is released with UnmapFile.
+ *
+ *  @param   data        Pointer to the data
+ *  @param   size        Size of the data
+ *  @param   mapped      The data was mapped
+ *
+ *  @return  error code
+ */
+
+    int Adopt (char* data, size_t size, bool mapped);
+
+//------------------------------------------------------------------------------
+/*! @brief   Drop a reference to the store, release it with the last one.
+ *
+ *  @param   store       Store
+ */
+
+    static void Drop (Store* store);
+
+//------------------------------------------------------------------------------
+};
+
+#include "StringArena.ipp"
+
+#endif // STRINGARENA_H_INCLUDED
@@ -0,0 +1,288 @@
+/*------------------------------------------------------------------------------
+    * File:        StringArena.ipp                                             *
+    * Description: Functions of the string storage of char* trees.             *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+inline StringArena::StringArena () { }
+
+//------------------------------------------------------------------------------
+
+inline StringArena::StringArena (const StringArena& obj) :
+    store_ (obj.store_)
+{
+    if (store_ != nullptr) ++store_->refs_;
+}
+
+//------------------------------------------------------------------------------
+
+inline StringArena& StringArena::operator = (const StringArena& obj)
+{
+    if (store_ == obj.store_) return *this;
+
+    Drop(store_);
+
+    store_ = obj.store_;
+    if (store_ != nullptr) ++store_->refs_;
+
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+
+inline StringArena::~StringArena ()
+{
+    Clean();
+}
+
+//------------------------------------------------------------------------------
+
+inline char* StringArena::Copy (const char* str)
+{
+    if (str == nullptr) return nullptr;
+
+    return Copy(str, strlen(str));
+}
+
+//------------------------------------------------------------------------------
+
+inline char* StringArena::Copy (const char* str, size_t len)
+{
+    assert(str != nullptr);
+
+    Store* store = Own();
+    if (store == nullptr) return nullptr;
+
+    char* copy = nullptr;
+
+    if ((store->blocks_ != nullptr) && (store->used_ + len + 1 <= store->blocks_->size_))
+    {
+        copy = (char*)(store->blocks_ + 1) + store->used_;
+        store->used_ += len + 1;
+    }
+    else
+    {
+        bool   big  = (len + 1 > STRING_ARENA_BLOCK_SIZE / 4);
+        size_t size = big ? len + 1 : STRING_ARENA_BLOCK_SIZE;
+
+        Block* block = (Block*)malloc(sizeof(Block) + size);
+        if (block == nullptr) return nullptr;
+
+        block->size_ = size;
+        copy = (char*)(block + 1);
+
+        if (big && (store->blocks_ != nullptr))
+        {
+            block->next_ = store->blocks_->next_;
+            store->blocks_->next_ = block;
+        }
+        else
+        {
+            block->next_   = store->blocks_;
+            store->blocks_ = block;
+            store->used_   = len + 1;
+        }
+
+        store->size_ += size;
+    }
+
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+
+    return copy;
+}
+
+//------------------------------------------------------------------------------
+
+inline char* StringArena::Keep (char* str, size_t len)
+{
+    assert(str != nullptr);
+
+    static char empty[1] = "";
+    if (len == 0) return empty;
+
+    for (Store* store = store_; store != nullptr; store = store->parent_)
+    {
+        for (Buffer* buffer = store->buffers_; buffer != nullptr; buffer = buffer->next_)
+            if ((str >= buffer->data_) && (str + len <= buffer->data_ + buffer->size_))
+                return str;
+    }
+
+    return Copy(str, len);
+}
+
+//------------------------------------------------------------------------------
+
+inline void StringArena::Adopt (Text& text)
+{
+    if (text.size_ == 0) return;
+
+    if (Adopt(text.text_, text.size_, text.mapped_) == 0) text.size_ = 0;
+}
+
+//------------------------------------------------------------------------------
+
+inline char* StringArena::Adopt (MappedFile& file)
+{
+    char* data = file.data_;
+    if ((data == nullptr) || Adopt(data, file.size_, file.mapped_)) return nullptr;
+
+    file.data_   = nullptr;
+    file.size_   = 0;
+    file.mapped_ = false;
+
+    return data;
+}
+
+//------------------------------------------------------------------------------
+
+inline int StringArena::Merge (StringArena& obj)
+{
+    if ((this == &obj) || (obj.store_ == nullptr)) return 0;
+
+    Store* from = obj.store_;
+    assert((from->refs_ == 1) && (from->parent_ == nullptr));
+
+    if (store_ == nullptr)
+    {
+        Swap(obj);
+        return 0;
+    }
+
+    Store* store = Own();
+    if (store == nullptr) return 1;
+
+    if (from->blocks_ != nullptr)
+    {
+        if (store->blocks_ == nullptr)
+        {
+            store->blocks_ = from->blocks_;
+            store->used_   = from->used_;
+        }
+        else
+        {
+            Block* tail = from->blocks_;
+            while (tail->next_ != nullptr) tail = tail->next_;
+
+            tail->next_ = store->blocks_->next_;
+            store->blocks_->next_ = from->blocks_;
+        }
+    }
+
+    if (from->buffers_ != nullptr)
+    {
+        Buffer* tail = from->buffers_;
+        while (tail->next_ != nullptr) tail = tail->next_;
+
+        tail->next_     = store->buffers_;
+        store->buffers_ = from->buffers_;
+    }
+
+    store->size_ += from->size_;
+
+    from->blocks_  = nullptr;
+    from->buffers_ = nullptr;
+    from->used_    = 0;
+    from->size_    = 0;
+
+    obj.Clean();
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+inline void StringArena::Clean ()
+{
+    Drop(store_);
+
+    store_ = nullptr;
+}
+
+//------------------------------------------------------------------------------
+
+inline void StringArena::Swap (StringArena& obj) noexcept
+{
+    std::swap(store_, obj.store_);
+}
+
+//------------------------------------------------------------------------------
+
+inline size_t StringArena::getSize () const
+{
+    return (store_ == nullptr) ? 0 : store_->size_;
+}
+
+//------------------------------------------------------------------------------
+
+inline StringArena::Store* StringArena::Own ()
+{
+    if ((store_ != nullptr) && (store_->refs_ == 1)) return store_;
+
+    Store* store = new (std::nothrow) Store;
+    if (store == nullptr) return nullptr;
+
+    store->parent_ = store_;
+    store_ = store;
+
+    return store_;
+}
+
+//------------------------------------------------------------------------------
+
+inline int StringArena::Adopt (char* data, size_t size, bool mapped)
+{
+    assert(data != nullptr);
+
+    Store*  store  = Own();
+    Buffer* buffer = new (std::nothrow) Buffer;
+
+    if ((store == nullptr) || (buffer == nullptr))
+    {
+        delete buffer;
+        return 1;
+    }
+
+    buffer->next_   = store->buffers_;
+    buffer->data_   = data;
+    buffer->size_   = size;
+    buffer->mapped_ = mapped;
+
+    store->buffers_ = buffer;
+    store->size_   += size;
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+inline void StringArena::Drop (Store* store)
+{
+    while ((store != nullptr) && (--store->refs_ == 0))
+    {
+        while (store->blocks_ != nullptr)
+        {
+            Block* next = store->blocks_->next_;
+            free(store->blocks_);
+            store->blocks_ = next;
+        }
+
+        while (store->buffers_ != nullptr)
+        {
+            Buffer* next = store->buffers_->next_;
+            UnmapFile(store->buffers_->data_, store->buffers_->size_, store->buffers_->mapped_);
+            delete store->buffers_;
+            store->buffers_ = next;
+        }
+
+        Store* parent = store->parent_;
+        delete store;
+        store = parent;
+    }
+}
+
+//------------------------------------------------------------------------------
@@ -16,14 +16,16 @@
 
 
 #include "../StringLib/StringLib.h"
-
-#define NO_DUMP
-#define NO_HASH
 #include "../StackLib/Stack.h"
-#undef NO_HASH
-#undef NO_DUMP
+#include "../StackLib/TaskPool.h"
 
 #include "TreeConfig.h"
+#include "NodeArena.h"
+#include "StringArena.h"
+#include "NodeWalk.h"
+#include "LeafIndex.h"
+#include "TreeBin.h"
+#include "TreeJournal.h"
 #include <type_traits>
 #include <assert.h>
 #include <limits.h>
@@ -32,31 +34,29 @@
 #include <stdio.h>
 #include <time.h>
 #include <new>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <utility>
 
 
 #define TREE_CHECK if (Check ())                            \
                    {                                        \
-                     Dump(DUMP_NAME);                       \
+                     DumpError(DUMP_NAME);                  \
                      TREE_ASSERTOK(errCode_, errCode_, -1); \
                    } //
 
 
-#define TREE_ASSERTOK(cond, err, line) if (cond)                                                                  \
-                                       {                                                                          \
-                                         PrintError(TREE_LOGNAME , __FILE__, __LINE__, __FUNC_NAME__, err, line); \
-                                         exit(err);                                                               \
-                                       } //
-
-#define CHECK_BRACKET(lines_arr, line, bracket)          \
+#define CHECK_BRACKET(str, bracket)                      \
         (                                                \
-          (lines_arr[line].str[0] != bracket) ||         \
+          ((str)[0] != bracket) ||                       \
           (                                              \
-              (not isspace(base.lines_[line].str[1])) && \
-              (base.lines_[line].str[1] != '\0')         \
+              (not isspace((str)[1])) &&                 \
+              ((str)[1] != '\0')                         \
           )                                              \
         ) //
 
-static int tree_id = 0;
+static std::atomic<int> tree_id (0);
 
 #define newTree(NAME, TREE_TYPE) \
         Tree<TREE_TYPE> NAME ((char*)#NAME);
@@ -71,20 +71,62 @@ static int tree_id = 0;
 template <typename TYPE>
 class Tree;
 
+template <typename TYPE>
+class CompactTree;
+
+template <typename TYPE>
+class ConcurrentTree;
+
+template <typename TYPE>
+class PersistentTree;
+
+// Stack of a path in the tree, the first PATH_INLINE_SIZE levels need no heap,
+// the path is filled on hot paths and is not checked
+template <typename TYPE>
+using PathStack = Stack<TYPE, PATH_INLINE_SIZE, StackUnchecked>;
+
 template<typename TYPE> const char* const PRINT_TYPE<Tree<TYPE>> = "Tree";
 template<typename TYPE> const Tree<TYPE>  POISON    <Tree<TYPE>> = {};
 
 template<typename TYPE> bool isPOISON  (Tree<TYPE> tree);
 template<typename TYPE> void TypePrint (FILE* fp, const Tree<TYPE>& tree);
+template<typename TYPE> void TypePrint (TextWriter& out, const TYPE& value);
+template<typename TYPE> void swap      (Tree<TYPE>& tree1, Tree<TYPE>& tree2) noexcept;
+
+template<typename TYPE> void BaseToBin (const char* basename, const char* binname);
+template<typename TYPE> void BinToBase (const char* binname,  const char* basename);
+
+
+//------------------------------------------------------------------------------
+/*! @brief   Cut of a text base between threads. Subtrees shorter than limit_
+ *           lines are not parsed, their nodes and opening bracket lines are
+ *           saved to be parsed by other threads.
+ */
+
+template <typename TYPE>
+struct BaseSplit
+{
+    const size_t*          skip_  = nullptr; // line after the subtree opened at the line, 0 if unknown
+    size_t                 limit_ = 0;
+
+    WalkStack<Node<TYPE>*> nodes_;
+    WalkStack<size_t>      lines_;
+};
 
 
 template <typename TYPE>
 class Node
 {
     friend class Tree<TYPE>;
+    friend class NodeArena<TYPE>;
+    friend class CompactTree<TYPE>;
+    friend class ConcurrentTree<TYPE>;
+    friend class PersistentTree<TYPE>;
 
     TYPE data_      = POISON<TYPE>;
     bool is_string_ = false;
+    bool in_store_  = false;
+    bool in_arena_  = false;
 
 public:
 
@@ -103,7 +145,8 @@ public:
 //------------------------------------------------------------------------------
 /*! @brief   Node destruction.
  *
- *  @note    All nodes must be created by operator new!!!
+ *  @note    Children created by operator new are deleted, children from a
+ *           tree arena are left to the arena of their tree.
  */
 
     ~Node ();
@@ -125,13 +168,13 @@ public:
     const TYPE& getData ();
 
 //------------------------------------------------------------------------------
-/*! @brief   Recursive depth recount.
+/*! @brief   Depth recount of the subtree.
  */
 
     void recountDepth ();
 
 //------------------------------------------------------------------------------
-/*! @brief   Recursive previous node pointers recount.
+/*! @brief   Previous node pointers recount of the subtree.
  */
 
     void recountPrev ();
@@ -146,21 +189,78 @@ public:
 
     Node& operator = (const Node& obj);
 
+//------------------------------------------------------------------------------
+/*! @brief   Node move constructor, data and children are taken without copying.
+ *
+ *  @param   obj         Source node, left as a leaf with POISON data
+ *
+ *  @note    O(1) if the node gets the same depth as the source, otherwise
+ *           depths of the subtree are recounted.
+ */
+
+    Node (Node&& obj) noexcept;
+
+    Node& operator = (Node&& obj) noexcept;
+
 private:
 
+//------------------------------------------------------------------------------
+/*! @brief   Free node data, links are not touched.
+ */
+
+    void Release ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Delete children created by operator new, links are cleared.
+ */
+
+    void DropChildren ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Copy node data only.
+ *
+ *  @param   obj         Source node
+ *  @param   share       Strings of a tree string arena are shared (the arena is
+ *                       shared by the trees), else they are copied
+ */
+
+    void CopyData (const Node& obj, bool share = false);
+
+//------------------------------------------------------------------------------
+/*! @brief   Copy of the node and its children.
+ *
+ *  @param   obj         Source node
+ *  @param   arena       Arena for new nodes (nullptr to use operator new)
+ */
+
+    void CopyFrom (const Node& obj, NodeArena<TYPE>* arena);
+
+//------------------------------------------------------------------------------
+/*! @brief   Take data and children of the node.
+ *
+ *  @param   obj         Source node
+ */
+
+    void MoveFrom (Node& obj);
+
 //------------------------------------------------------------------------------
 /*! @brief   Create a tree from the base text.
  *
- *  @param   base        Base text
+ *  @param   base        Base text (Text or LineReader), lines are taken in order
  *  @param   line_cur    Current line in the base text
+ *  @param   arena       Arena for new nodes
+ *  @param   strings     Arena for strings of char* nodes (nullptr to allocate
+ *                       each string by operator new)
+ *  @param   split       Subtrees to leave for other threads (not split if nullptr)
  * 
  *  @return  error code
  */
 
-    int AddFromBase (const Text& base, size_t& line_cur);
+    template <typename BASE>
+    int AddFromBase (BASE& base, size_t& line_cur, NodeArena<TYPE>& arena, StringArena* strings = nullptr, BaseSplit<TYPE>* split = nullptr);
 
 //------------------------------------------------------------------------------
-/*! @brief   Recursive tree writing to file.
+/*! @brief   Subtree writing to file.
  *
  *  @param   base        Base file
  */
@@ -168,7 +268,16 @@ private:
     void Write (FILE* base);
 
 //------------------------------------------------------------------------------
-/*! @brief   Recursively find path to the element.
+/*! @brief   Subtree writing to output buffer.
+ *
+ *  @param   out         Output
+ *  @param   compact     Write lines without indentation
+ */
+
+    void Write (TextWriter& out, bool compact = false);
+
+//------------------------------------------------------------------------------
+/*! @brief   Find path to the element in the subtree.
  *
  *  @param   path        Path to the element
  *  @param   elem        Data of node
@@ -176,10 +285,11 @@ private:
  *  @return  1 if found, 0 if not
  */
 
-    bool findPath (Stack<size_t>& path, TYPE elem);
+    template <size_t INLINE, typename POLICY>
+    bool findPath (Stack<size_t, INLINE, POLICY>& path, TYPE elem);
 
 //------------------------------------------------------------------------------
-/*! @brief   Recursive node checker.
+/*! @brief   Subtree checker.
  *
  *  @param   tree        Tree of the node
  *
@@ -189,7 +299,23 @@ private:
     int Check (Tree<TYPE>& tree);
 
 //------------------------------------------------------------------------------
-/*! @brief   Recursive print the contents of the tree like a graphviz dot file.
+/*! @brief   Subtree checker without diagnostics.
+ *
+ *  @return  error code
+ */
+
+    int Check ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Check links and depth of this node only.
+ *
+ *  @return  error code
+ */
+
+    int CheckLinks ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Print the contents of the subtree like a graphviz dot file.
  *
  *  @param   dump        Dump graphviz dot file
  */
@@ -197,6 +323,80 @@ private:
     void Dump (FILE* dump);
 
 //------------------------------------------------------------------------------
+/*! @brief   Print the contents of the subtree like a graphviz dot file, each
+ *           node is printed once with a short id, edges refer to the ids.
+ *
+ *  @param   out         Output
+ */
+
+    void Dump (TextWriter& out);
+
+//------------------------------------------------------------------------------
+/*! @brief   Print the subtree like a graphviz dot file down to the depth
+ *           limit, cut off children are shown as "...".
+ *
+ *  @param   out         Output
+ *  @param   levels      Number of levels under the node to print
+ *  @param   id          Id of the node
+ *  @param   last        Last id in use, the printed nodes take the next ones
+ */
+
+    void Dump (TextWriter& out, size_t levels, size_t id, size_t& last);
+
+//------------------------------------------------------------------------------
+/*! @brief   Print this node like a graphviz dot node.
+ *
+ *  @param   out         Output
+ *  @param   id          Id of the node
+ *  @param   color       Fill color (nullptr for the default one)
+ */
+
+    void DumpNode (TextWriter& out, size_t id, const char* color = nullptr);
+
+//------------------------------------------------------------------------------
+/*! @brief   Print an edge like a graphviz dot edge.
+ *
+ *  @param   out         Output
+ *  @param   from        Id of the parent
+ *  @param   to          Id of the child
+ *  @param   label       Label of the edge
+ */
+
+    static void DumpEdge (TextWriter& out, size_t from, size_t to, const char* label);
+
+//------------------------------------------------------------------------------
+/*! @brief   Print the mark of the cut off subtree like a graphviz dot node.
+ *
+ *  @param   out         Output
+ *  @param   id          Id of the mark
+ */
+
+    static void DumpCut (TextWriter& out, size_t id);
+
+//------------------------------------------------------------------------------
+};
+
+//------------------------------------------------------------------------------
+/*! @brief   State of splitLeaf, made by the first split of the tree: the leaves
+ *           share SPLIT_LOCK_STRIPES stripes, each with its own lock, node
+ *           arena and string arena. The arenas of the stripes are joined to
+ *           the tree by the next call that is not a split.
+ */
+
+template <typename TYPE>
+struct SplitState
+{
+    struct alignas(64) Stripe
+    {
+        std::mutex      lock_;
+        NodeArena<TYPE> arena_;
+        StringArena     strings_;
+    };
+
+    Stripe     stripes_[SPLIT_LOCK_STRIPES];
+    std::mutex index_;
+    std::mutex dirty_;
+    std::mutex journal_;
 };
 
 
@@ -204,11 +404,27 @@ template <typename TYPE>
 class Tree
 {
     friend class Node<TYPE>;
+    friend class CompactTree<TYPE>;
+    friend class ConcurrentTree<TYPE>;
+    friend class PersistentTree<TYPE>;
 
     int id_ = 0;
     int errCode_ = 0;
 
-    Stack<TYPE> path2badnode_;
+    PathStack<TYPE> path2badnode_;
+
+    NodeArena<TYPE> arena_;
+    LeafIndex<TYPE> index_;
+    StringArena     strings_;
+
+    WalkStack<Node<TYPE>*> dirty_;
+    Node<TYPE>* checked_root_ = nullptr;
+
+    WalkStack<Node<TYPE>*> badpath_;
+
+    TreeJournal* journal_ = nullptr;
+
+    std::atomic<SplitState<TYPE>*> split_state_ { nullptr };
 
 public:
 
@@ -242,11 +458,36 @@ public:
 /*! @brief   Tree constructor with base.
  *
  *  @param   tree_name   Tree variable name
- *  @param   base_name   Base filename
+ *  @param   base_name   Base filename, text or binary base
  */
 
     Tree (char* tree_name, char* base_name);
 
+//------------------------------------------------------------------------------
+/*! @brief   Tree constructor with text base read from the opened file.
+ *
+ *  @param   tree_name   Tree variable name
+ *  @param   base_file   Base file, it is read by chunks and is not closed
+ */
+
+    Tree (char* tree_name, FILE* base_file);
+
+//------------------------------------------------------------------------------
+/*! @brief   Tree constructor with base loaded by several threads.
+ *
+ *  @param   tree_name   Tree variable name
+ *  @param   base_name   Base filename, text or binary base
+ *  @param   threads     Number of threads (0 to use all cores)
+ *
+ *  @note    The whole text base is read to memory. Brackets are matched in
+ *           one pass over the lines, the top levels are built first, then the
+ *           subtrees below them are shared between threads, each thread
+ *           allocates nodes from its own arena. If anything does not match,
+ *           the base is loaded again by one thread to report the error.
+ */
+
+    Tree (char* tree_name, char* base_name, size_t threads);
+
 //------------------------------------------------------------------------------
 /*! @brief   Tree destructor.
  */
@@ -263,6 +504,39 @@ public:
 
     Tree& operator = (const Tree& obj);
 
+//------------------------------------------------------------------------------
+/*! @brief   Tree move constructor, nodes, arena and index are taken in O(1).
+ *
+ *  @param   obj         Source tree, left not constructed
+ */
+
+    Tree (Tree&& obj) noexcept;
+
+    Tree& operator = (Tree&& obj) noexcept;
+
+//------------------------------------------------------------------------------
+/*! @brief   Exchange contents of two trees in O(1).
+ *
+ *  @param   obj         Other tree
+ */
+
+    void Swap (Tree& obj) noexcept;
+
+//------------------------------------------------------------------------------
+/*! @brief   Make a deep copy of the tree.
+ *
+ *  @param   threads     Number of threads (0 to use all cores)
+ *
+ *  @return  copy of the tree
+ *
+ *  @note    Big trees are copied in parallel: the top levels are copied first,
+ *           then the subtrees below them are shared between threads, each
+ *           thread allocates nodes from its own arena. The arenas are merged
+ *           into the arena of the copy at the end.
+ */
+
+    Tree clone (size_t threads = 0) const;
+
 //------------------------------------------------------------------------------
 /*! @brief   Clean tree.
  */
@@ -270,40 +544,254 @@ public:
     void Clean ();
 
 //------------------------------------------------------------------------------
-/*! @brief   Print the contents of the tree like a graphviz dot file.
+/*! @brief   Create a new node in the tree arena.
+ *
+ *  @return  pointer to the new node
+ */
+
+    Node<TYPE>* newNode ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Detach node from its parent and recycle the whole subtree.
+ *
+ *  @param   node        Node of this tree
+ */
+
+    void deleteNode (Node<TYPE>* node);
+
+//------------------------------------------------------------------------------
+/*! @brief   Safe change node data, the leaf index is kept up to date.
+ *
+ *  @param   node        Node of this tree
+ *  @param   data        Data to change (strings are copied to the tree)
+ */
+
+    void setData (Node<TYPE>* node, TYPE data);
+
+//------------------------------------------------------------------------------
+/*! @brief   Create right child of the node.
+ *
+ *  @param   parent      Node of this tree without right child
+ *  @param   data        Data of the new node
+ *
+ *  @return  pointer to the new node
+ */
+
+    Node<TYPE>* addRight (Node<TYPE>* parent, TYPE data);
+
+//------------------------------------------------------------------------------
+/*! @brief   Create left child of the node.
+ *
+ *  @param   parent      Node of this tree without left child
+ *  @param   data        Data of the new node
+ *
+ *  @return  pointer to the new node
+ */
+
+    Node<TYPE>* addLeft (Node<TYPE>* parent, TYPE data);
+
+//------------------------------------------------------------------------------
+/*! @brief   Turn the leaf into a node with the data and two leaves: the old
+ *           data of the leaf and the object. Only the leaf changes, so calls
+ *           for different leaves run in parallel from many threads.
+ *
+ *  @param   leaf        Leaf of this tree
+ *  @param   data        New data of the leaf (strings are copied to the tree)
+ *  @param   object      Data of the new leaf
+ *  @param   right       Put the object to the right, the old data to the left
+ *
+ *  @return  leaf with the object, nullptr if the node is not a leaf anymore
+ *           (another thread split it first)
+ *
+ *  @note    Only splitLeaf calls may run at the same time, and walks that do
+ *           not reach the leaves being split.
+ */
+
+    Node<TYPE>* splitLeaf (Node<TYPE>* leaf, TYPE data, TYPE object, bool right = true);
+
+//------------------------------------------------------------------------------
+/*! @brief   Build hash index from leaf data to leaves, findPath becomes O(depth).
+ *
+ *  @note    While the index is built, the tree must be changed only by
+ *           setData, addRight, addLeft, splitLeaf and deleteNode of the tree.
+ */
+
+    void buildIndex ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Drop the leaf index, findPath searches the whole tree again.
+ */
+
+    void dropIndex ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Print the contents of the tree like a graphviz dot file in UTF-8
+ *           (string data is converted from CP1251).
  *
  *  @param   dumpname    Name of the dump file
  */
 
     void Dump (const char* dumpname = DUMP_NAME);
 
+//------------------------------------------------------------------------------
+/*! @brief   Render the dump to a picture by graphviz dot.
+ *
+ *  @param   dumpname    Name of the dump file
+ *  @param   pictname    Name of the picture file
+ *
+ *  @return  0 if rendered, else error code of dot
+ */
+
+    static int Render (const char* dumpname = DUMP_NAME, const char* pictname = DUMP_PICT_NAME);
+
+//------------------------------------------------------------------------------
+/*! @brief   Print the subtree under the node like a graphviz dot file down to
+ *           the depth limit.
+ *
+ *  @param   node        Node of this tree
+ *  @param   levels      Number of levels under the node to print
+ *  @param   dumpname    Name of the dump file
+ */
+
+    void Dump (Node<TYPE>* node, size_t levels, const char* dumpname = DUMP_NAME);
+
+//------------------------------------------------------------------------------
+/*! @brief   Print the path from the root to the node and the nodes around it
+ *           like a graphviz dot file: the subtrees hanging from the path and
+ *           under the node are printed down to the depth limit.
+ *
+ *  @param   node        Node of this tree
+ *  @param   levels      Number of levels to print around the path
+ *  @param   dumpname    Name of the dump file
+ */
+
+    void DumpAround (Node<TYPE>* node, size_t levels, const char* dumpname = DUMP_NAME);
+
 //------------------------------------------------------------------------------
 /*! @brief   Write the tree data to the base file.
  *
  *  @param   basename    Base file name
+ *  @param   compact     Write lines without indentation, the base is read
+ *                       the same way
+ *
+ *  @note    The base is written to a temporary file and renamed, so writing
+ *           to the base the tree was loaded from is safe. Writing to the base
+ *           of the open journal folds the journal into the base like
+ *           compactJournal.
  */
 
-    void Write (const char* basename = DEFAULT_BASE_NAME);
+    void Write (const char* basename = DEFAULT_BASE_NAME, bool compact = false);
+
+//------------------------------------------------------------------------------
+/*! @brief   Write the tree data to the binary base file.
+ *
+ *  @param   binname     Binary base file name
+ *
+ *  @note    The base is written to a temporary file and renamed, so writing
+ *           to the base the tree was loaded from is safe. Writing to the base
+ *           of the open journal folds the journal into the base like
+ *           compactJournal.
+ */
+
+    void WriteBin (const char* binname = DEFAULT_BIN_NAME);
+
+//------------------------------------------------------------------------------
+/*! @brief   Check if the file is a binary base.
+ *
+ *  @param   filename    File name
+ *
+ *  @return  1 if binary, else 0
+ */
+
+    static bool isBinBase (const char* filename);
+
+//------------------------------------------------------------------------------
+/*! @brief   Start logging changes of the tree to the journal of the base, so
+ *           an edit costs a record instead of a base rewrite.
+ *
+ *  @param   basename    Base file name, the journal is basename + JOURNAL_SUFFIX
+ *
+ *  @note    The tree must be the one loaded from the base (the constructors
+ *           replay its journal). If the journal does not continue the base
+ *           or is bigger than it, the tree is written to the base first.
+ *           setData, addRight, addLeft, splitLeaf, deleteNode and Clean are
+ *           logged.
+ */
+
+    void openJournal (const char* basename = DEFAULT_BASE_NAME);
+
+//------------------------------------------------------------------------------
+/*! @brief   Wait until the logged changes reach the disk. The journal syncs
+ *           itself every JOURNAL_SYNC_RECORDS records, a crash loses only the
+ *           changes after the last sync.
+ */
+
+    void syncJournal ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Fold the journal into the base: the tree is written to the base
+ *           and the journal is started again empty.
+ *
+ *  @note    The base is written to a temporary file and renamed, so a crash
+ *           leaves either the old base with its journal or the new base.
+ */
+
+    void compactJournal ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Sync the journal and stop logging changes.
+ */
+
+    void closeJournal ();
 
 //------------------------------------------------------------------------------
 /*! @brief   Find path in the tree to the element.
  *
- *  @param   path        Path to the element
+ *  @param   path        Path to the element (PathStack keeps usual paths
+ *                       without heap)
  *  @param   elem        Data of node
  *
  *  @return  1 if found, 0 if not
  */
 
-    bool findPath (Stack<size_t>& path, TYPE elem);
+    template <size_t INLINE, typename POLICY>
+    bool findPath (Stack<size_t, INLINE, POLICY>& path, TYPE elem);
 
 //------------------------------------------------------------------------------
 /*! @brief   Check tree for problems.
  *
  *  @return  error code
+ *
+ *  @note    After a successful check only subtrees marked dirty since then
+ *           are checked again. Full checks of big trees run in parallel.
+ *           On error the whole tree is checked again sequentially, so
+ *           path2badnode_ is the same as with a plain full check.
  */
 
     int Check ();
 
+//------------------------------------------------------------------------------
+/*! @brief   Check the whole tree without diagnostics using several threads,
+ *           the subtrees are given to the threads that run out of work.
+ *
+ *  @param   threads     Number of threads
+ *
+ *  @return  error code
+ */
+
+    int CheckParallel (size_t threads);
+
+//------------------------------------------------------------------------------
+/*! @brief   Mark subtree as changed, the next check revalidates it.
+ *
+ *  @param   node        Root of the changed subtree (nullptr for the whole tree)
+ *
+ *  @note    The tree marks changes made by its own functions itself. Call it
+ *           after changing links or depths of the nodes directly.
+ */
+
+    void markDirty (Node<TYPE>* node = nullptr);
+
 //------------------------------------------------------------------------------
 /*! @brief   Get error code of the tree.
  *
@@ -336,12 +824,258 @@ public:
 //------------------------------------------------------------------------------
 /*! @brief   Prints a section of base text with an error to the console and to the log file.
  *
- *  @param   base        Text base
+ *  @param   base        Text base (Text or LineReader)
  *  @param   line        Number of line with an error
  *  @param   logname     Name of the log file
  */
 
-    void PrintBase (Text& base, size_t line, const char* logname);
+    template <typename BASE>
+    void PrintBase (BASE& base, size_t line, const char* logname);
+
+/*------------------------------------------------------------------------------
+                   Private functions                                           *
+*///----------------------------------------------------------------------------
+
+private:
+
+//------------------------------------------------------------------------------
+/*! @brief   Release all nodes of the tree.
+ */
+
+    void freeNodes ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Build the tree from the binary base, the file is mapped to memory.
+ *
+ *  @param   binname     Binary base file name
+ *
+ *  @return  error code
+ */
+
+    int LoadBin (const char* binname);
+
+//------------------------------------------------------------------------------
+/*! @brief   Build the tree from the text base, exit with the error section
+ *           printed if the base is wrong.
+ *
+ *  @param   base        Text base (Text or LineReader)
+ */
+
+    template <typename BASE>
+    void LoadBase (BASE& base);
+
+//------------------------------------------------------------------------------
+/*! @brief   Build the tree from the text base by several threads.
+ *
+ *  @param   base        Text base
+ *  @param   threads     Number of threads
+ *
+ *  @return  error code, the tree has to be freed and loaded again on error
+ */
+
+    int LoadParallel (Text& base, size_t threads);
+
+//------------------------------------------------------------------------------
+/*! @brief   Match brackets of the text base in one pass.
+ *
+ *  @param   base        Text base
+ *  @param   skip        Array to fill: line after the subtree for each line
+ *                       with an opening bracket, 0 for other lines
+ */
+
+    static void MatchBrackets (Text& base, size_t* skip);
+
+//------------------------------------------------------------------------------
+/*! @brief   Print the path like a graphviz dot file with the subtrees hanging
+ *           from it down to the depth limit.
+ *
+ *  @param   path        Nodes from the top of the path to the last one
+ *  @param   len         Number of nodes in the path
+ *  @param   levels      Number of levels to print around the path
+ *  @param   dumpname    Name of the dump file
+ *  @param   mark        Mark the path and its last node by color
+ */
+
+    void DumpPath (Node<TYPE>* const* path, size_t len, size_t levels, const char* dumpname, bool mark);
+
+//------------------------------------------------------------------------------
+/*! @brief   Print the area around the node found by the last failed check, or
+ *           the top of the tree if there is no such node.
+ *
+ *  @param   dumpname    Name of the dump file
+ */
+
+    void DumpError (const char* dumpname);
+
+//------------------------------------------------------------------------------
+/*! @brief   Apply the journal of the base to the tree loaded from the base, if
+ *           the journal continues it.
+ *
+ *  @param   basename    Base file name
+ */
+
+    void ReplayJournal (const char* basename);
+
+//------------------------------------------------------------------------------
+/*! @brief   Check if the file is the base of the open journal.
+ *
+ *  @param   filename    File name
+ *
+ *  @return  1 if it is, else 0
+ */
+
+    bool isJournalBase (const char* filename);
+
+//------------------------------------------------------------------------------
+/*! @brief   Write the tree to the base of the open journal and start the
+ *           journal again empty. The base is written to a temporary file and
+ *           renamed.
+ *
+ *  @param   bin         Write the binary base
+ *  @param   compact     Write text lines without indentation
+ */
+
+    void rewriteBase (bool bin, bool compact);
+
+//------------------------------------------------------------------------------
+/*! @brief   Write the tree to a temporary file and rename it over the base.
+ *
+ *  @param   filename    Base file name
+ *  @param   bin         Write the binary base
+ *  @param   compact     Write text lines without indentation
+ *
+ *  @return  error code
+ *
+ *  @note    Strings of a base loaded by mapping stay in the mapping of the old
+ *           file, so the base the tree was loaded from is never truncated.
+ */
+
+    int replaceBase (const char* filename, bool bin, bool compact);
+
+//------------------------------------------------------------------------------
+/*! @brief   Write the tree to the text file.
+ *
+ *  @param   basename    File name
+ *  @param   compact     Write lines without indentation
+ *
+ *  @return  error code
+ */
+
+    int writeText (const char* basename, bool compact);
+
+//------------------------------------------------------------------------------
+/*! @brief   Write the tree to the binary file.
+ *
+ *  @param   binname     File name
+ *
+ *  @return  error code
+ */
+
+    int writeBin (const char* binname);
+
+//------------------------------------------------------------------------------
+/*! @brief   Log a change of the tree to the journal.
+ *
+ *  @param   op          Operation (TreeJournalOp)
+ *  @param   node        Changed node (parent of the new node for JOURNAL_ADD_*)
+ *  @param   data        New data (nullptr for JOURNAL_DELETE)
+ */
+
+    void logChange (uint8_t op, Node<TYPE>* node, const TYPE* data);
+
+//------------------------------------------------------------------------------
+/*! @brief   Make a record of a change of the tree.
+ *
+ *  @param   journal     Journal to put the record to
+ *  @param   op          Operation (TreeJournalOp)
+ *  @param   node        Changed node (parent of the new node for JOURNAL_ADD_*)
+ *  @param   data        New data (nullptr for JOURNAL_DELETE)
+ *  @param   object      Data of the added leaf for JOURNAL_SPLIT_*
+ */
+
+    void logChange (TreeJournal& journal, uint8_t op, Node<TYPE>* node, const TYPE* data, const TYPE* object = nullptr);
+
+//------------------------------------------------------------------------------
+/*! @brief   Release of the subtree.
+ *
+ *  @param   node        Subtree root
+ *  @param   recycle     Return arena nodes to the free list
+ */
+
+    void freeSubtree (Node<TYPE>* node, bool recycle);
+
+//------------------------------------------------------------------------------
+/*! @brief   Create child of the node.
+ *
+ *  @param   parent      Node of this tree
+ *  @param   data        Data of the new node
+ *  @param   right       Create right child if 1, else left
+ *
+ *  @return  pointer to the new node
+ */
+
+    Node<TYPE>* addChild (Node<TYPE>* parent, TYPE data, bool right);
+
+//------------------------------------------------------------------------------
+/*! @brief   Set node data, strings are copied to the string arena of the tree.
+ *
+ *  @param   node        Node of this tree
+ *  @param   data        Data to set
+ */
+
+    void storeData (Node<TYPE>* node, TYPE data);
+
+//------------------------------------------------------------------------------
+/*! @brief   Set node data, strings are copied to the string arena.
+ *
+ *  @param   node        Node of this tree
+ *  @param   data        Data to set
+ *  @param   strings     String arena
+ */
+
+    void storeData (Node<TYPE>* node, TYPE data, StringArena& strings);
+
+//------------------------------------------------------------------------------
+/*! @brief   Get the state of splitLeaf, it is made by the first call.
+ *
+ *  @return  state
+ */
+
+    SplitState<TYPE>& splitState ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Take the nodes and strings made by splitLeaf to the arenas of the
+ *           tree. Called by functions that cannot run with splits.
+ */
+
+    void joinSplits ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Remove leaf from the index, the next equal leaf of its chain is
+ *           found instead if any.
+ *
+ *  @param   node        Leaf
+ */
+
+    void unindexLeaf (Node<TYPE>* node);
+
+//------------------------------------------------------------------------------
+/*! @brief   Forget dirty marks inside the subtree that is going to be freed.
+ *
+ *  @param   node        Subtree root
+ */
+
+    void dropDirty (Node<TYPE>* node);
+
+//------------------------------------------------------------------------------
+/*! @brief   Run the function in several threads and wait for all of them.
+ *
+ *  @param   threads     Number of threads, the current one is used as the first
+ *  @param   worker      Function taking the thread number
+ */
+
+    template <typename FUNC>
+    static void runThreads (size_t threads, FUNC& worker);
 
 //------------------------------------------------------------------------------
 };
@@ -51,32 +51,97 @@ Tree<TYPE>::Tree (char* tree_name, char* base_filename) :
 {
     TREE_ASSERTOK((tree_name == nullptr), TREE_WRONG_INPUT_TREE_NAME, -1);
 
-    root_ = new Node<TYPE>;
+    root_ = newNode();
 
-    Text base(base_filename);
+    if (isBinBase(base_filename))
+    {
+        int err = LoadBin(base_filename);
+        TREE_ASSERTOK(err, err, -1);
 
-    TREE_ASSERTOK((base.num_ < 2), TREE_WRONG_SYNTAX_INPUT_BASE, -1);
-    TREE_ASSERTOK(CHECK_BRACKET(base.lines_, 0,             OPEN_BRACKET),  TREE_WRONG_SYNTAX_INPUT_BASE, 0);
-    TREE_ASSERTOK(CHECK_BRACKET(base.lines_, base.num_ - 2, CLOSE_BRACKET), TREE_WRONG_SYNTAX_INPUT_BASE, base.num_ - 2);
-    
-    size_t line_cur = 1;
-    if (base.lines_[line_cur].str[0] != CLOSE_BRACKET)
+        TREE_CHECK;
+        ReplayJournal(base_filename);
+        return;
+    }
+
+    LineReader base(base_filename);
+    LoadBase(base);
+
+    ReplayJournal(base_filename);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+Tree<TYPE>::Tree (char* tree_name, FILE* base_file) :
+    name_         (tree_name),
+    id_           (tree_id++),
+    path2badnode_ ((char*)"path to problem node"),
+    errCode_      (TREE_OK)
+{
+    TREE_ASSERTOK((tree_name == nullptr), TREE_WRONG_INPUT_TREE_NAME, -1);
+
+    root_ = newNode();
+
+    LineReader base(base_file);
+    LoadBase(base);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+Tree<TYPE>::Tree (char* tree_name, char* base_filename, size_t threads) :
+    name_         (tree_name),
+    id_           (tree_id++),
+    path2badnode_ ((char*)"path to problem node"),
+    errCode_      (TREE_OK)
+{
+    TREE_ASSERTOK((tree_name == nullptr), TREE_WRONG_INPUT_TREE_NAME, -1);
+
+    root_ = newNode();
+
+    if (isBinBase(base_filename))
     {
-        if (root_->AddFromBase(base, line_cur) != 0)
-        {
-            PrintError(TREE_LOGNAME, __FILE__, __LINE__, __FUNC_NAME__, TREE_WRONG_SYNTAX_INPUT_BASE, line_cur);
-            PrintBase(base, line_cur, TREE_LOGNAME);
-            exit(TREE_WRONG_SYNTAX_INPUT_BASE);
-        };
+        int err = LoadBin(base_filename);
+        TREE_ASSERTOK(err, err, -1);
+
+        TREE_CHECK;
+        ReplayJournal(base_filename);
+        return;
     }
 
-    TREE_CHECK;
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+
+    Text base(base_filename, threads);
+
+    StringArena text;
+    if constexpr (std::is_same<TYPE, char*>::value) text.Adopt(base);
+
+    strings_ = text;
+
+    if ((threads > 1) && (base.num_ >= PARALLEL_MIN_SIZE) && (LoadParallel(base, threads) == 0))
+    {
+        TREE_ASSERTOK(CHECK_BRACKET(base.lines_[base.num_ - 2].str, CLOSE_BRACKET), TREE_WRONG_SYNTAX_INPUT_BASE, base.num_ - 2);
+
+        TREE_CHECK;
+        ReplayJournal(base_filename);
+        return;
+    }
+
+    freeNodes();
+    root_ = newNode();
+
+    strings_ = text;
+
+    LoadBase(base);
+
+    ReplayJournal(base_filename);
 }
 
 //------------------------------------------------------------------------------
 
 template <typename TYPE>
-Tree<TYPE>::Tree (const Tree& obj)
+Tree<TYPE>::Tree (const Tree& obj) :
+    path2badnode_ ((char*)"path to problem node")
 {
     *this = obj;
 }
@@ -86,20 +151,190 @@ Tree<TYPE>::Tree (const Tree& obj)
 template <typename TYPE>
 Tree<TYPE>& Tree<TYPE>::operator = (const Tree& obj)
 {
+    if (this == &obj) return *this;
+
+    closeJournal();
+
     name_ = obj.name_;
 
+    freeNodes();
+
+    // the strings of splits are shared only after they join the tree
+    const_cast<Tree&>(obj).joinSplits();
+
+    strings_ = obj.strings_;
+
     if (obj.root_ != nullptr)
     {
-        if (root_ == nullptr) root_ = new Node<TYPE>;
-        *root_ = *obj.root_;
+        root_ = newNode();
+        root_->CopyFrom(*obj.root_, &arena_);
+    }
+
+    if (obj.index_.isBuilt()) buildIndex();
+    else dropIndex();
+
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+Tree<TYPE>::Tree (Tree&& obj) noexcept : errCode_ (TREE_NOT_CONSTRUCTED)
+{
+    Swap(obj);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+Tree<TYPE>& Tree<TYPE>::operator = (Tree&& obj) noexcept
+{
+    if (this != &obj)
+    {
+        Tree<TYPE> temp(std::move(obj));
+        Swap(temp);
     }
-    else root_ = nullptr;
 
     return *this;
 }
 
 //------------------------------------------------------------------------------
 
+template <typename TYPE>
+void Tree<TYPE>::Swap (Tree& obj) noexcept
+{
+    std::swap(name_,    obj.name_);
+    std::swap(root_,    obj.root_);
+    std::swap(id_,      obj.id_);
+    std::swap(errCode_, obj.errCode_);
+
+    std::swap(checked_root_, obj.checked_root_);
+    std::swap(journal_,      obj.journal_);
+
+    split_state_ = obj.split_state_.exchange(split_state_.load());
+
+    path2badnode_.Swap(obj.path2badnode_);
+    arena_.Swap(obj.arena_);
+    index_.Swap(obj.index_);
+    strings_.Swap(obj.strings_);
+    dirty_.Swap(obj.dirty_);
+    badpath_.Swap(obj.badpath_);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+Tree<TYPE> Tree<TYPE>::clone (size_t threads) const
+{
+    const_cast<Tree*>(this)->joinSplits();
+
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+
+    if ((threads < 2) || (root_ == nullptr) || (arena_.getSize() < PARALLEL_MIN_SIZE))
+        return Tree<TYPE>(*this);
+
+    struct CloneTask
+    {
+        Node<TYPE>* src;
+        Node<TYPE>* dst;
+        Node<TYPE>* right;
+        Node<TYPE>* left;
+    };
+
+    Tree<TYPE> copy(name_);
+
+    copy.strings_ = strings_;
+
+    copy.root_ = copy.newNode();
+    copy.root_->CopyData(*root_, true);
+
+    WalkStack<CloneTask> tasks;
+    tasks.Push({ root_, copy.root_, nullptr, nullptr });
+
+    size_t head = 0;
+    while ((head < tasks.getSize()) && (tasks.getSize() - head < threads * PARALLEL_TASKS_PER_THREAD))
+    {
+        CloneTask task = tasks[head++];
+
+        Node<TYPE>* children[] = { task.src->right_, task.src->left_ };
+
+        for (Node<TYPE>* child : children)
+        {
+            if (child == nullptr) continue;
+
+            Node<TYPE>* node = copy.newNode();
+            node->CopyData(*child, true);
+            node->prev_  = task.dst;
+            node->depth_ = task.dst->depth_ + 1;
+
+            if (child == task.src->right_) task.dst->right_ = node;
+            else                           task.dst->left_  = node;
+
+            tasks.Push({ child, node, nullptr, nullptr });
+        }
+    }
+
+    NodeArena<TYPE>*    arenas = new NodeArena<TYPE>[threads];
+    std::atomic<size_t> next (head);
+
+    auto worker = [&tasks, &next, arenas](size_t id)
+    {
+        for (size_t n = next++; n < tasks.getSize(); n = next++)
+        {
+            CloneTask& task = tasks[n];
+
+            Node<TYPE>* children[] = { task.src->right_, task.src->left_ };
+            Node<TYPE>** copies[]  = { &task.right,      &task.left      };
+
+            for (int i = 0; i < 2; ++i)
+            {
+                if (children[i] == nullptr) continue;
+
+                Node<TYPE>* node = arenas[id].Alloc();
+                assert(node != nullptr);
+
+                node->prev_ = task.dst;
+                node->CopyFrom(*children[i], &arenas[id]);
+
+                *copies[i] = node;
+            }
+        }
+    };
+
+    runThreads(threads, worker);
+
+    for (size_t n = head; n < tasks.getSize(); ++n)
+    {
+        if (tasks[n].right != nullptr) tasks[n].dst->right_ = tasks[n].right;
+        if (tasks[n].left  != nullptr) tasks[n].dst->left_  = tasks[n].left;
+    }
+
+    for (size_t i = 0; i < threads; ++i) copy.arena_.Merge(arenas[i]);
+
+    delete [] arenas;
+
+    if (index_.isBuilt()) copy.buildIndex();
+
+    return copy;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+template <typename FUNC>
+void Tree<TYPE>::runThreads (size_t threads, FUNC& worker)
+{
+    std::thread* workers = new std::thread[threads - 1];
+
+    for (size_t i = 1; i < threads; ++i) workers[i - 1] = std::thread(worker, i);
+    worker(0);
+    for (size_t i = 1; i < threads; ++i) workers[i - 1].join();
+
+    delete [] workers;
+}
+
+//------------------------------------------------------------------------------
+
 template <typename TYPE>
 Tree<TYPE>::~Tree ()
 {
@@ -107,11 +342,11 @@ Tree<TYPE>::~Tree ()
 
     else if (errCode_ != TREE_DESTRUCTED)
     {
-        if (root_ != nullptr)
-        {
-            delete root_;
-            root_ = nullptr;
-        }
+        closeJournal();
+        freeNodes();
+
+        delete split_state_.load();
+        split_state_ = nullptr;
 
         errCode_ = TREE_DESTRUCTED;
     }
@@ -128,306 +363,1632 @@ void Tree<TYPE>::Clean ()
 {
     TREE_CHECK;
 
-    if (root_ != nullptr)
+    if ((journal_ != nullptr) && (root_ != nullptr)) logChange(JOURNAL_DELETE, root_, nullptr);
+
+    freeNodes();
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+Node<TYPE>* Tree<TYPE>::newNode ()
+{
+    Node<TYPE>* node = arena_.Alloc();
+    TREE_ASSERTOK((node == nullptr), TREE_NO_MEMORY, -1);
+
+    return node;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Tree<TYPE>::deleteNode (Node<TYPE>* node)
+{
+    assert(node != nullptr);
+
+    joinSplits();
+
+    if (journal_ != nullptr) logChange(JOURNAL_DELETE, node, nullptr);
+
+    Node<TYPE>* parent = node->prev_;
+
+    if (node == root_) root_ = nullptr;
+
+    if (parent != nullptr)
     {
-        delete root_;
-        root_ = nullptr;
+        if (parent->right_ == node) parent->right_ = nullptr;
+        if (parent->left_  == node) parent->left_  = nullptr;
+    }
+
+    if (index_.isBuilt())
+    {
+        NodeWalk<TYPE> walk(node);
+
+        for (Node<TYPE>* leaf = walk.Next(); leaf != nullptr; leaf = walk.Next())
+            if ((leaf->left_ == nullptr) && (leaf->right_ == nullptr))
+                unindexLeaf(leaf);
+
+        if ((parent != nullptr) && (parent->left_ == nullptr) && (parent->right_ == nullptr) && (not isPOISON(parent->data_)))
+            TREE_ASSERTOK(index_.Insert(parent), TREE_NO_MEMORY, -1);
+    }
+
+    dropDirty(node);
+    if (parent != nullptr) markDirty(parent);
+
+    freeSubtree(node, true);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Tree<TYPE>::setData (Node<TYPE>* node, TYPE data)
+{
+    assert(node != nullptr);
+
+    if (journal_ != nullptr) logChange(JOURNAL_SET, node, &data);
+
+    bool leaf = index_.isBuilt() && (node->left_ == nullptr) && (node->right_ == nullptr);
+
+    if (leaf) unindexLeaf(node);
+
+    storeData(node, data);
+
+    if (leaf) index_.Insert(node);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+Node<TYPE>* Tree<TYPE>::addRight (Node<TYPE>* parent, TYPE data)
+{
+    return addChild(parent, data, true);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+Node<TYPE>* Tree<TYPE>::addLeft (Node<TYPE>* parent, TYPE data)
+{
+    return addChild(parent, data, false);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+Node<TYPE>* Tree<TYPE>::addChild (Node<TYPE>* parent, TYPE data, bool right)
+{
+    assert(parent != nullptr);
+    assert(((right) ? parent->right_ : parent->left_) == nullptr);
+
+    if (journal_ != nullptr) logChange((right) ? JOURNAL_ADD_RIGHT : JOURNAL_ADD_LEFT, parent, &data);
+
+    if (index_.isBuilt() && (parent->left_ == nullptr) && (parent->right_ == nullptr))
+        unindexLeaf(parent);
+
+    Node<TYPE>* node = newNode();
+    storeData(node, data);
+
+    node->prev_  = parent;
+    node->depth_ = parent->depth_ + 1;
+
+    if (right) parent->right_ = node;
+    else       parent->left_  = node;
+
+    markDirty(parent);
+
+    if (index_.isBuilt()) index_.Insert(node);
+
+    return node;
+}
+
+//------------------------------------------------------------------------------
+
+/*------------------------------------------------------------------------------
+    splitLeaf writes only the leaf and its two new children under the lock of
+    the stripe of the leaf. New nodes and strings come from the arenas of the
+    stripe, so splits of leaves in different stripes share no lock unless the
+    index is built or the journal is open. The index lock also guards the
+    data of leaves, because index probes of other threads compare it. The
+    journal records are made before the journal lock is taken, it only keeps
+    the three records of a split in a row. Splits of different leaves
+    commute, so any order of them replays to the same tree.
+*///----------------------------------------------------------------------------
+
+template <typename TYPE>
+Node<TYPE>* Tree<TYPE>::splitLeaf (Node<TYPE>* leaf, TYPE data, TYPE object, bool right)
+{
+    assert(leaf != nullptr);
+
+    TREE_ASSERTOK((isPOISON(data)),   TREE_INPUT_DATA_POISON, -1);
+    TREE_ASSERTOK((isPOISON(object)), TREE_INPUT_DATA_POISON, -1);
+
+    SplitState<TYPE>& state = splitState();
+
+    typename SplitState<TYPE>::Stripe& stripe = state.stripes_[((uintptr_t)leaf / sizeof(Node<TYPE>)) % SPLIT_LOCK_STRIPES];
+
+    std::lock_guard<std::mutex> lock(stripe.lock_);
+
+    if ((leaf->left_ != nullptr) || (leaf->right_ != nullptr)) return nullptr;
+
+    if (journal_ != nullptr)
+    {
+        static thread_local TreeJournal records;
+
+        logChange(records, (right) ? JOURNAL_SPLIT_RIGHT : JOURNAL_SPLIT_LEFT, leaf, &data, &object);
+
+        std::lock_guard<std::mutex> journal_lock(state.journal_);
+
+        int err = journal_->Append(records);
+        TREE_ASSERTOK(err, err, -1);
+    }
+
+    Node<TYPE>* kept  = stripe.arena_.Alloc();
+    Node<TYPE>* added = stripe.arena_.Alloc();
+    TREE_ASSERTOK(((kept == nullptr) || (added == nullptr)), TREE_NO_MEMORY, -1);
+
+    storeData(added, object, stripe.strings_);
+
+    kept->data_      = leaf->data_;
+    kept->is_string_ = leaf->is_string_;
+    kept->in_store_  = leaf->in_store_;
+
+    kept->prev_  = added->prev_  = leaf;
+    kept->depth_ = added->depth_ = leaf->depth_ + 1;
+
+    leaf->is_string_ = false;
+
+    if (index_.isBuilt())
+    {
+        std::lock_guard<std::mutex> index_lock(state.index_);
+
+        index_.Replace(leaf, kept);
+        storeData(leaf, data, stripe.strings_);
+
+        TREE_ASSERTOK(index_.Insert(added), TREE_NO_MEMORY, -1);
+    }
+    else storeData(leaf, data, stripe.strings_);
+
+    {
+        std::lock_guard<std::mutex> dirty_lock(state.dirty_);
+
+        markDirty(leaf);
+    }
+
+    if (right)
+    {
+        leaf->right_ = added;
+        leaf->left_  = kept;
+    }
+    else
+    {
+        leaf->left_  = added;
+        leaf->right_ = kept;
+    }
+
+    return added;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Tree<TYPE>::storeData (Node<TYPE>* node, TYPE data)
+{
+    storeData(node, data, strings_);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Tree<TYPE>::storeData (Node<TYPE>* node, TYPE data, StringArena& strings)
+{
+    if constexpr (std::is_same<TYPE, char*>::value)
+    {
+        node->setData(strings.Copy(data));
+        node->in_store_ = (node->data_ != nullptr);
+    }
+    else node->setData(data);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Tree<TYPE>::buildIndex ()
+{
+    index_.Clean(true);
+
+    NodeWalk<TYPE> walk(root_);
+
+    for (Node<TYPE>* node = walk.Next(); node != nullptr; node = walk.Next())
+        if ((node->left_ == nullptr) && (node->right_ == nullptr) && (not isPOISON(node->data_)))
+            TREE_ASSERTOK(index_.Insert(node), TREE_NO_MEMORY, -1);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Tree<TYPE>::dropIndex ()
+{
+    index_.Clean(false);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+SplitState<TYPE>& Tree<TYPE>::splitState ()
+{
+    SplitState<TYPE>* state = split_state_.load(std::memory_order_acquire);
+    if (state != nullptr) return *state;
+
+    SplitState<TYPE>* made = new (std::nothrow) SplitState<TYPE>;
+    TREE_ASSERTOK((made == nullptr), TREE_NO_MEMORY, -1);
+
+    if (split_state_.compare_exchange_strong(state, made, std::memory_order_acq_rel)) return *made;
+
+    delete made;
+
+    return *state;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Tree<TYPE>::joinSplits ()
+{
+    SplitState<TYPE>* state = split_state_.load(std::memory_order_acquire);
+    if (state == nullptr) return;
+
+    for (typename SplitState<TYPE>::Stripe& stripe : state->stripes_)
+    {
+        arena_.Merge(stripe.arena_);
+        TREE_ASSERTOK(strings_.Merge(stripe.strings_), TREE_NO_MEMORY, -1);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Tree<TYPE>::unindexLeaf (Node<TYPE>* node)
+{
+    if (isPOISON(node->data_)) return;
+
+    index_.Erase(node);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Tree<TYPE>::freeNodes ()
+{
+    joinSplits();
+
+    index_.Clean(index_.isBuilt());
+
+    markDirty();
+
+    if (root_ != nullptr)
+    {
+        freeSubtree(root_, false);
+        root_ = nullptr;
+    }
+
+    arena_.Clean();
+    strings_.Clean();
+    badpath_.Clean();
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Tree<TYPE>::freeSubtree (Node<TYPE>* node, bool recycle)
+{
+    assert(node != nullptr);
+
+    WalkStack<Node<TYPE>*> nodes;
+    nodes.Push(node);
+
+    while (nodes.getSize() > 0)
+    {
+        node = nodes.Pop();
+
+        if (node->right_ != nullptr) nodes.Push(node->right_);
+        if (node->left_  != nullptr) nodes.Push(node->left_);
+
+        node->right_ = nullptr;
+        node->left_  = nullptr;
+
+        if (node->in_arena_)
+        {
+            node->Release();
+            if (recycle) arena_.Free(node);
+        }
+        else delete node;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+Node<TYPE>::Node (const Node& obj)
+{
+    CopyFrom(obj, nullptr);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+Node<TYPE>& Node<TYPE>::operator = (const Node& obj)
+{
+    if (this != &obj) CopyFrom(obj, nullptr);
+
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Node<TYPE>::CopyFrom (const Node& obj, NodeArena<TYPE>* arena)
+{
+    DropChildren();
+    CopyData(obj, arena != nullptr);
+
+    if (prev_ == nullptr) depth_ = 0;
+    else depth_ = prev_->depth_ + 1;
+
+    WalkStack<Node<TYPE>*> copies;
+    copies.Push(this);
+
+    NodeWalk<TYPE> walk((Node<TYPE>*)&obj);
+    walk.Next();
+
+    for (Node<TYPE>* src = walk.Next(); src != nullptr; src = walk.Next())
+    {
+        size_t depth = walk.getDepth();
+        while (copies.getSize() > depth) copies.Pop();
+
+        Node<TYPE>* parent = copies.Top();
+        Node<TYPE>* node   = (arena != nullptr) ? arena->Alloc() : new Node<TYPE>;
+        assert(node != nullptr);
+
+        node->CopyData(*src, arena != nullptr);
+        node->prev_  = parent;
+        node->depth_ = parent->depth_ + 1;
+
+        if (walk.getAncestor(depth - 1)->right_ == src) parent->right_ = node;
+        else                                            parent->left_  = node;
+
+        copies.Push(node);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+Node<TYPE>::Node (Node&& obj) noexcept
+{
+    MoveFrom(obj);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+Node<TYPE>& Node<TYPE>::operator = (Node&& obj) noexcept
+{
+    if (this != &obj) MoveFrom(obj);
+
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Node<TYPE>::MoveFrom (Node& obj)
+{
+    DropChildren();
+    Release();
+
+    data_      = obj.data_;
+    is_string_ = obj.is_string_;
+    in_store_  = obj.in_store_;
+    right_     = obj.right_;
+    left_      = obj.left_;
+
+    obj.data_      = POISON<TYPE>;
+    obj.is_string_ = false;
+    obj.in_store_  = false;
+    obj.right_     = nullptr;
+    obj.left_      = nullptr;
+
+    if (right_ != nullptr) right_->prev_ = this;
+    if (left_  != nullptr) left_->prev_  = this;
+
+    depth_ = (prev_ == nullptr) ? 0 : prev_->depth_ + 1;
+
+    if (depth_ != obj.depth_) recountDepth();
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Node<TYPE>::CopyData (const Node& obj, bool share)
+{
+    Release();
+
+    if constexpr (std::is_same<TYPE, char*>::value)
+    {
+        if (obj.is_string_ || (obj.in_store_ && not share))
+        {
+            data_ = new char[strlen(obj.data_) + 2] {};
+            strcpy(data_, obj.data_);
+
+            is_string_ = true;
+        }
+        else
+        {
+            data_     = obj.data_;
+            in_store_ = obj.in_store_;
+        }
+    }
+    else data_ = obj.data_;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+Node<TYPE>::~Node ()
+{
+    DropChildren();
+
+    prev_ = nullptr;
+
+    Release();
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Node<TYPE>::DropChildren ()
+{
+    WalkStack<Node<TYPE>*> nodes;
+
+    if ((right_ != nullptr) && (not right_->in_arena_)) nodes.Push(right_);
+    if ((left_  != nullptr) && (not left_->in_arena_))  nodes.Push(left_);
+
+    right_ = nullptr;
+    left_  = nullptr;
+
+    while (nodes.getSize() > 0)
+    {
+        Node<TYPE>* node = nodes.Pop();
+
+        if ((node->right_ != nullptr) && (not node->right_->in_arena_)) nodes.Push(node->right_);
+        if ((node->left_  != nullptr) && (not node->left_->in_arena_))  nodes.Push(node->left_);
+
+        node->right_ = nullptr;
+        node->left_  = nullptr;
+
+        delete node;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Node<TYPE>::Release ()
+{
+    if constexpr (std::is_same<TYPE, char*>::value) if (is_string_) delete [] data_;
+
+    is_string_ = false;
+    in_store_  = false;
+
+    data_ = POISON<TYPE>;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+template <typename BASE>
+int Node<TYPE>::AddFromBase (BASE& base, size_t& line_cur, NodeArena<TYPE>& arena, StringArena* strings, BaseSplit<TYPE>* split)
+{
+    struct Frame
+    {
+        Node<TYPE>* node;
+        int         state;
+    };
+
+    auto line = [&base] (size_t n)
+    {
+        Line cur = base.getLine(n);
+        if (cur.str == nullptr) cur.str = (char*)"";
+
+        return cur;
+    };
+
+    WalkStack<Frame> frames;
+    frames.Push({ this, 0 });
+
+    while (frames.getSize() > 0)
+    {
+        Frame& frame = frames.Top();
+        Node<TYPE>* node = frame.node;
+        Node<TYPE>* child = nullptr;
+
+        if (frame.state == 0)
+        {
+            Line cur = line(line_cur);
+
+            if (cur.str[0] == CLOSE_BRACKET)
+            {
+                if (CHECK_BRACKET(cur.str, CLOSE_BRACKET)) return line_cur;
+
+                frames.Pop();
+                if (frames.getSize() > 0) ++line_cur;
+                continue;
+            }
+
+            if constexpr (std::is_same<TYPE, char*>::value)
+            {
+                if (strings != nullptr)
+                {
+                    node->data_ = strings->Keep(cur.str, cur.len);
+                    if (node->data_ == nullptr) return line_cur;
+
+                    node->in_store_ = true;
+                }
+                else
+                {
+                    node->data_ = new char [cur.len + 2];
+                    strcpy(node->data_, cur.str);
+
+                    node->is_string_ = true;
+                }
+
+                ++line_cur;
+            }
+            else
+            {
+                sscanf(cur.str, PRINT_FORMAT<TYPE>, &node->data_);
+                ++line_cur;
+            }
+
+            frame.state = 1;
+
+            cur = line(line_cur);
+
+            if (cur.str[0] == OPEN_BRACKET)
+            {
+                if (CHECK_BRACKET(cur.str, OPEN_BRACKET)) return line_cur;
+
+                child = arena.Alloc();
+                if (child == nullptr) return line_cur;
+
+                node->right_ = child;
+            }
+            else if (CHECK_BRACKET(cur.str, CLOSE_BRACKET)) return line_cur;
+        }
+        else if (frame.state == 1)
+        {
+            frame.state = 2;
+
+            Line cur = line(line_cur);
+
+            if (cur.str[0] == OPEN_BRACKET)
+            {
+                if (CHECK_BRACKET(cur.str, OPEN_BRACKET)) return line_cur;
+
+                child = arena.Alloc();
+                if (child == nullptr) return line_cur;
+
+                node->left_ = child;
+            }
+        }
+        else
+        {
+            frames.Pop();
+            if (frames.getSize() > 0) ++line_cur;
+            continue;
+        }
+
+        if (child != nullptr)
+        {
+            child->prev_  = node;
+            child->depth_ = node->depth_ + 1;
+
+            if ((split != nullptr) && (split->skip_[line_cur] > line_cur) &&
+                (split->skip_[line_cur] - line_cur <= split->limit_))
+            {
+                split->nodes_.Push(child);
+                split->lines_.Push(line_cur);
+
+                line_cur = split->skip_[line_cur];
+                continue;
+            }
+
+            ++line_cur;
+            frames.Push({ child, 0 });
+        }
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Tree<TYPE>::Dump (const char* dumpname)
+{
+    DumpPath(&root_, (root_ != nullptr) ? 1 : 0, SIZE_MAX, dumpname, false);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Tree<TYPE>::Dump (Node<TYPE>* node, size_t levels, const char* dumpname)
+{
+    assert(node != nullptr);
+
+    DumpPath(&node, 1, levels, dumpname, false);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Tree<TYPE>::DumpAround (Node<TYPE>* node, size_t levels, const char* dumpname)
+{
+    assert(node != nullptr);
+
+    WalkStack<Node<TYPE>*> path;
+    for (Node<TYPE>* cur = node; cur != nullptr; cur = cur->prev_) path.Push(cur);
+
+    for (size_t i = 0, k = path.getSize() - 1; i < k; ++i, --k)
+        std::swap(path[i], path[k]);
+
+    DumpPath(&path[0], path.getSize(), levels, dumpname, true);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Tree<TYPE>::DumpPath (Node<TYPE>* const* path, size_t len, size_t levels, const char* dumpname, bool mark)
+{
+    assert(dumpname != nullptr);
+
+    TextWriter dump(dumpname);
+
+    dump.Put("digraph G{\n"
+             "rankdir = HR;\n"
+             " node[shape = box, style = filled, color = black, fillcolor = lightskyblue];\n");
+
+    size_t last = (len > 0) ? len - 1 : 0;
+
+    for (size_t i = 0; i < len; ++i)
+    {
+        Node<TYPE>* node = path[i];
+        Node<TYPE>* next = (i + 1 < len) ? path[i + 1] : nullptr;
+
+        const char* color = nullptr;
+        if (mark) color = (next == nullptr) ? "tomato" : "gold";
+
+        node->DumpNode(dump, i, color);
+
+        if (next != nullptr)
+        {
+            const char* label = (node->left_ == next) ? "left" : (node->right_ == next) ? "right" : "prev";
+            Node<TYPE>::DumpEdge(dump, i, i + 1, label);
+        }
+
+        Node<TYPE>* children[] = { node->left_, node->right_ };
+        const char* labels[]   = { "left",      "right"      };
+
+        for (int k = 0; k < 2; ++k)
+        {
+            if ((children[k] == nullptr) || (children[k] == next)) continue;
+
+            Node<TYPE>::DumpEdge(dump, i, ++last, labels[k]);
+
+            if (levels > 0) children[k]->Dump(dump, levels - 1, last, last);
+            else            Node<TYPE>::DumpCut(dump, last);
+        }
+    }
+
+    dump.Put("\tlabelloc=\"t\";\tlabel=\"Tree name: ");
+    dump.PutCp1251(name_);
+    dump.Put("\\nType is ");
+    dump.Put(PRINT_TYPE<TYPE>);
+    dump.Put("\";}\n");
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Tree<TYPE>::DumpError (const char* dumpname)
+{
+    if (badpath_.getSize() > 0)
+        DumpPath(&badpath_[0], badpath_.getSize(), DUMP_ERROR_LEVELS, dumpname, true);
+
+    else if (root_ != nullptr)
+        Dump(root_, DUMP_ERROR_LEVELS, dumpname);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+int Tree<TYPE>::Render (const char* dumpname, const char* pictname)
+{
+    assert(dumpname != nullptr);
+    assert(pictname != nullptr);
+
+    char* command = (char*)calloc(strlen(dumpname) + strlen(pictname) + 32, sizeof(char));
+    assert(command != nullptr);
+
+    sprintf(command, "dot -Tpng -o \"%s\" \"%s\"", pictname, dumpname);
+
+    int err = system(command);
+
+    free(command);
+
+    return err;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Node<TYPE>::Dump (FILE* dump)
+{
+    assert(dump != nullptr);
+
+    TextWriter out(dump);
+    Dump(out);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Node<TYPE>::Dump (TextWriter& out)
+{
+    size_t last = 0;
+    Dump(out, SIZE_MAX, 0, last);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Node<TYPE>::Dump (TextWriter& out, size_t levels, size_t id, size_t& last)
+{
+    struct DumpTask
+    {
+        Node<TYPE>* node;
+        size_t      id;
+        size_t      level;
+    };
+
+    WalkStack<DumpTask> tasks;
+    tasks.Push({ this, id, 0 });
+
+    while (tasks.getSize() > 0)
+    {
+        DumpTask task = tasks.Pop();
+        task.node->DumpNode(out, task.id);
+
+        Node<TYPE>* children[] = { task.node->left_, task.node->right_ };
+        const char* labels[]   = { "left",           "right"           };
+
+        for (int i = 0; i < 2; ++i)
+        {
+            if (children[i] == nullptr) continue;
+
+            DumpEdge(out, task.id, ++last, labels[i]);
+
+            if (task.level < levels) tasks.Push({ children[i], last, task.level + 1 });
+            else                     DumpCut(out, last);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Node<TYPE>::DumpNode (TextWriter& out, size_t id, const char* color)
+{
+    out.Put("\tn", 2);
+    out.PutUInt(id);
+    out.Put(" [label=\"prev: ");
+    out.PutPtr(prev_);
+    out.Put("\\n this: ");
+    out.PutPtr(this);
+    out.Put("\\n depth: ");
+    out.PutUInt(depth_);
+    out.Put("\\n data: [");
+
+    if constexpr (std::is_same<TYPE, char*>::value) out.PutCp1251(data_);
+    else TypePrint(out, data_);
+
+    out.Put("]\\n left: ");
+    out.PutPtr(left_);
+    out.Put(" | right: ");
+    out.PutPtr(right_);
+    out.Put("\\n\"");
+
+    if (color != nullptr)
+    {
+        out.Put(", fillcolor = ");
+        out.Put(color);
+    }
+
+    out.Put("]\n", 2);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Node<TYPE>::DumpEdge (TextWriter& out, size_t from, size_t to, const char* label)
+{
+    out.Put("\tn", 2);
+    out.PutUInt(from);
+    out.Put(" -> n");
+    out.PutUInt(to);
+    out.Put(" [label=\"");
+    out.Put(label);
+    out.Put("\"]\n");
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Node<TYPE>::DumpCut (TextWriter& out, size_t id)
+{
+    out.Put("\tn", 2);
+    out.PutUInt(id);
+    out.Put(" [label=\"...\", shape = plaintext, style = solid]\n");
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Tree<TYPE>::Write (const char* basename, bool compact)
+{
+    TREE_CHECK;
+
+    if (isJournalBase(basename))
+    {
+        rewriteBase(false, compact);
+        return;
+    }
+
+    int err = replaceBase(basename, false, compact);
+    TREE_ASSERTOK(err, err, -1);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Tree<TYPE>::WriteBin (const char* binname)
+{
+    TREE_CHECK;
+
+    if (isJournalBase(binname))
+    {
+        rewriteBase(true, false);
+        return;
+    }
+
+    int err = replaceBase(binname, true, false);
+    TREE_ASSERTOK(err, err, -1);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+int Tree<TYPE>::writeText (const char* basename, bool compact)
+{
+    TextWriter base(basename);
+
+    base.Put(OPEN_BRACKET);
+    base.Put('\n');
+    if (root_ != nullptr) root_->Write(base, compact);
+    base.Put(CLOSE_BRACKET);
+
+    return (base.Flush()) ? TREE_WRITE_FAILED : TREE_OK;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+int Tree<TYPE>::writeBin (const char* binname)
+{
+    FILE* bin = fopen(binname, "wb");
+    if (bin == nullptr) return TREE_WRITE_FAILED;
+
+    TreeBinHeader header;
+    memcpy(header.magic_, TREE_BIN_MAGIC, sizeof(TREE_BIN_MAGIC));
+
+    header.version_   = TREE_BIN_VERSION;
+    header.type_size_ = (std::is_same<TYPE, char*>::value) ? 0 : sizeof(TYPE);
+
+    WalkStack<unsigned char> shape;
+
+    NodeWalk<TYPE> shape_walk(root_);
+    for (Node<TYPE>* node = shape_walk.Next(); node != nullptr; node = shape_walk.Next())
+    {
+        unsigned char bits = 0;
+
+        if (node->right_ != nullptr) bits |= BIN_HAS_RIGHT;
+        if (node->left_  != nullptr) bits |= BIN_HAS_LEFT;
+
+        if constexpr (std::is_same<TYPE, char*>::value)
+            if (node->data_ == nullptr) bits |= BIN_NO_DATA;
+
+        if (header.nodes_ % 2 == 0) shape.Push(bits);
+        else                        shape.Top() |= bits << 4;
+
+        ++header.nodes_;
+    }
+
+    while (shape.getSize() % TREE_BIN_ALIGN != 0) shape.Push(0);
+
+    header.shape_size_ = shape.getSize();
+
+    BinChecksum checksum;
+    if (header.shape_size_ > 0) checksum.Update((const char*)&shape[0], header.shape_size_);
+
+    fseek(bin, sizeof(TreeBinHeader) + header.shape_size_, SEEK_SET);
+
+    char*  buffer = new char[TREE_BIN_BUFFER_SIZE];
+    size_t filled = 0;
+
+    auto put = [&](const char* data, size_t size)
+    {
+        header.payload_size_ += size;
+
+        while (size > 0)
+        {
+            size_t part = TREE_BIN_BUFFER_SIZE - filled;
+            if (part > size) part = size;
+
+            memcpy(buffer + filled, data, part);
+            filled += part;
+            data   += part;
+            size   -= part;
+
+            if (filled == TREE_BIN_BUFFER_SIZE)
+            {
+                checksum.Update(buffer, filled);
+                fwrite(buffer, 1, filled, bin);
+                filled = 0;
+            }
+        }
+    };
+
+    NodeWalk<TYPE> data_walk(root_);
+    for (Node<TYPE>* node = data_walk.Next(); node != nullptr; node = data_walk.Next())
+    {
+        if constexpr (std::is_same<TYPE, char*>::value)
+        {
+            if (node->data_ != nullptr) put(node->data_, strlen(node->data_) + 1);
+        }
+        else put((const char*)&node->data_, sizeof(TYPE));
+    }
+
+    size_t tail = BinAlign(filled);
+    memset(buffer + filled, 0, tail - filled);
+
+    checksum.Update(buffer, tail);
+    fwrite(buffer, 1, tail, bin);
+
+    delete [] buffer;
+
+    checksum.Update((const char*)&header, sizeof(TreeBinHeader));
+    header.checksum_ = checksum.getResult();
+
+    fseek(bin, 0, SEEK_SET);
+    fwrite(&header, sizeof(TreeBinHeader), 1, bin);
+    if (header.shape_size_ > 0) fwrite(&shape[0], 1, header.shape_size_, bin);
+
+    bool failed = ferror(bin);
+    if (fclose(bin) != 0) failed = true;
+
+    return (failed) ? TREE_WRITE_FAILED : TREE_OK;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+bool Tree<TYPE>::isBinBase (const char* filename)
+{
+    assert(filename != nullptr);
+
+    FILE* fp = fopen(filename, "rb");
+    if (fp == nullptr) return false;
+
+    char magic[sizeof(TREE_BIN_MAGIC)] = {};
+    size_t size = fread(magic, 1, sizeof(magic), fp);
+
+    fclose(fp);
+
+    return (size == sizeof(magic)) && (memcmp(magic, TREE_BIN_MAGIC, sizeof(magic)) == 0);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Tree<TYPE>::openJournal (const char* basename)
+{
+    assert(basename != nullptr);
+
+    closeJournal();
+
+    journal_ = new TreeJournal(basename);
+
+    TreeJournalHeader header;
+    size_t valid = 0;
+
+    struct stat info = {};
+    if ( (stat(journal_->getJournalName(), &info) == 0) &&
+         (TreeJournal::makeHeader(basename, (std::is_same<TYPE, char*>::value) ? 0 : sizeof(TYPE), header) == TREE_OK) )
+    {
+        MappedFile file(journal_->getJournalName());
+
+        const char* body = nullptr;
+        size_t      size = 0;
+
+        valid = TreeJournal::findRecords(file, header);
+        if (valid > 0) while (TreeJournal::nextRecord(file, valid, body, size));
+    }
+
+    if ((valid > 0) && (valid - sizeof(TreeJournalHeader) <= header.base_size_))
+    {
+        int err = journal_->Open(valid);
+        TREE_ASSERTOK(err, err, -1);
+    }
+    else compactJournal();
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Tree<TYPE>::syncJournal ()
+{
+    if (journal_ == nullptr) return;
+
+    int err = journal_->Sync();
+    TREE_ASSERTOK(err, err, -1);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Tree<TYPE>::compactJournal ()
+{
+    assert(journal_ != nullptr);
+
+    rewriteBase(isBinBase(journal_->getBaseName()), false);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+bool Tree<TYPE>::isJournalBase (const char* filename)
+{
+    assert(filename != nullptr);
+
+    if (journal_ == nullptr) return false;
+
+    const char* basename = journal_->getBaseName();
+    if (strcmp(filename, basename) == 0) return true;
+
+    struct stat info1 = {};
+    struct stat info2 = {};
+
+    return (stat(filename, &info1) == 0) && (stat(basename, &info2) == 0) &&
+           (info1.st_dev == info2.st_dev) && (info1.st_ino == info2.st_ino);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Tree<TYPE>::rewriteBase (bool bin, bool compact)
+{
+    assert(journal_ != nullptr);
+
+    syncJournal();
+
+    TREE_CHECK;
+
+    const char* basename = journal_->getBaseName();
+
+    int err = replaceBase(basename, bin, compact);
+
+    TreeJournalHeader header;
+    if (err == TREE_OK) err = TreeJournal::makeHeader(basename, (std::is_same<TYPE, char*>::value) ? 0 : sizeof(TYPE), header);
+    if (err == TREE_OK) err = journal_->Create(header);
+
+    TREE_ASSERTOK(err, err, -1);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+int Tree<TYPE>::replaceBase (const char* filename, bool bin, bool compact)
+{
+    assert(filename != nullptr);
+
+    char* temp = TreeJournal::makeName(filename, TEMP_SUFFIX);
+
+    int err = (bin) ? writeBin(temp) : writeText(temp, compact);
+
+    if (err == TREE_OK) err = TreeJournal::syncFile(temp);
+    if (err == TREE_OK) err = TreeJournal::replaceFile(temp, filename);
+
+    if (err != TREE_OK) remove(temp);
+    free(temp);
+
+    return err;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Tree<TYPE>::closeJournal ()
+{
+    if (journal_ == nullptr) return;
+
+    syncJournal();
+
+    delete journal_;
+    journal_ = nullptr;
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Tree<TYPE>::ReplayJournal (const char* basename)
+{
+    assert(basename != nullptr);
+
+    char* journalname = TreeJournal::makeName(basename, JOURNAL_SUFFIX);
+
+    TreeJournalHeader header;
+
+    struct stat info = {};
+    bool found = (stat(journalname, &info) == 0) &&
+                 (TreeJournal::makeHeader(basename, (std::is_same<TYPE, char*>::value) ? 0 : sizeof(TYPE), header) == TREE_OK);
+
+    if (!found)
+    {
+        free(journalname);
+        return;
+    }
+
+    MappedFile file(journalname);
+    free(journalname);
+
+    size_t pos = TreeJournal::findRecords(file, header);
+    if (pos == 0) return;
+
+    const char* body = nullptr;
+    size_t      size = 0;
+    size_t      num  = 0;
+
+    char* str[2] = {};
+
+    while (TreeJournal::nextRecord(file, pos, body, size))
+    {
+        const char* end = body + size;
+
+        uint8_t  op    = 0;
+        uint64_t depth = 0;
+
+        TREE_ASSERTOK((size < sizeof(op) + sizeof(depth)), TREE_WRONG_JOURNAL, -1);
+
+        memcpy(&op,    body, sizeof(op));    body += sizeof(op);
+        memcpy(&depth, body, sizeof(depth)); body += sizeof(depth);
+
+        TREE_ASSERTOK((depth > (uint64_t)(end - body) * 8), TREE_WRONG_JOURNAL, -1);
+
+        const unsigned char* path = (const unsigned char*)body;
+        body += (depth + 7) / 8;
+
+        if ((root_ == nullptr) && (depth == 0) && (op != JOURNAL_DELETE))
+            root_ = newNode();
+
+        Node<TYPE>* node = root_;
+        for (uint64_t i = 0; (i < depth) && (node != nullptr); ++i)
+            node = ((path[i / 8] >> (i % 8)) & 1) ? node->right_ : node->left_;
+
+        TREE_ASSERTOK((node == nullptr), TREE_WRONG_JOURNAL, -1);
+
+        ++num;
+
+        if (op == JOURNAL_DELETE)
+        {
+            TREE_ASSERTOK((body != end), TREE_WRONG_JOURNAL, -1);
+
+            deleteNode(node);
+            continue;
+        }
+
+        bool split = (op == JOURNAL_SPLIT_RIGHT) || (op == JOURNAL_SPLIT_LEFT);
+
+        TYPE data[2] = { POISON<TYPE>, POISON<TYPE> };
+
+        for (size_t k = 0; k < ((split) ? 2 : 1); ++k)
+        {
+            if constexpr (std::is_same<TYPE, char*>::value)
+            {
+                uint64_t len = 0;
+
+                TREE_ASSERTOK(((size_t)(end - body) < sizeof(len)), TREE_WRONG_JOURNAL, -1);
+                memcpy(&len, body, sizeof(len));
+                body += sizeof(len);
+
+                if (len == UINT64_MAX) continue;
+
+                TREE_ASSERTOK((len > (uint64_t)(end - body)), TREE_WRONG_JOURNAL, -1);
+
+                char* temp = (char*)realloc(str[k], len + 1);
+                TREE_ASSERTOK((temp == nullptr), TREE_NO_MEMORY, -1);
+
+                str[k] = temp;
+                memcpy(str[k], body, len);
+                str[k][len] = '\0';
+
+                body += len;
+                data[k] = str[k];
+            }
+            else
+            {
+                TREE_ASSERTOK(((size_t)(end - body) < sizeof(TYPE)), TREE_WRONG_JOURNAL, -1);
+                memcpy(&data[k], body, sizeof(TYPE));
+                body += sizeof(TYPE);
+            }
+        }
+
+        TREE_ASSERTOK((body != end), TREE_WRONG_JOURNAL, -1);
+
+        switch (op)
+        {
+            case JOURNAL_SET:
+                setData(node, data[0]);
+                break;
+
+            case JOURNAL_ADD_RIGHT:
+                TREE_ASSERTOK((node->right_ != nullptr), TREE_WRONG_JOURNAL, -1);
+                addRight(node, data[0]);
+                break;
+
+            case JOURNAL_ADD_LEFT:
+                TREE_ASSERTOK((node->left_ != nullptr), TREE_WRONG_JOURNAL, -1);
+                addLeft(node, data[0]);
+                break;
+
+            case JOURNAL_SPLIT_RIGHT:
+            case JOURNAL_SPLIT_LEFT:
+                TREE_ASSERTOK(((node->left_ != nullptr) || (node->right_ != nullptr)), TREE_WRONG_JOURNAL, -1);
+                splitLeaf(node, data[0], data[1], (op == JOURNAL_SPLIT_RIGHT));
+                break;
+
+            default:
+                TREE_ASSERTOK(TREE_WRONG_JOURNAL, TREE_WRONG_JOURNAL, -1);
+        }
     }
+
+    free(str[0]);
+    free(str[1]);
+
+    if (num > 0) TREE_CHECK;
 }
 
 //------------------------------------------------------------------------------
 
 template <typename TYPE>
-Node<TYPE>::Node (const Node& obj)
+void Tree<TYPE>::logChange (uint8_t op, Node<TYPE>* node, const TYPE* data)
 {
-    *this = obj;
+    assert(journal_ != nullptr);
+
+    logChange(*journal_, op, node, data);
 }
 
 //------------------------------------------------------------------------------
 
 template <typename TYPE>
-Node<TYPE>& Node<TYPE>::operator = (const Node& obj)
+void Tree<TYPE>::logChange (TreeJournal& journal, uint8_t op, Node<TYPE>* node, const TYPE* data, const TYPE* object)
 {
-    if constexpr (std::is_same<TYPE, char*>::value)
-    {
-        if (is_string_)
-            delete [] data_;
+    assert(node != nullptr);
 
-        if (obj.is_string_)
-            data_ = new char[strlen(obj.data_) + 2] {};
-
-        strcpy(data_, obj.data_);
-    }
-    else data_ = obj.data_;
+    uint64_t depth = 0;
+    for (Node<TYPE>* cur = node; cur->prev_ != nullptr; cur = cur->prev_) ++depth;
 
-    is_string_ = obj.is_string_;
+    journal.Begin(op, depth);
 
-    if (obj.right_ != nullptr)
-    {
-        if (right_ != nullptr) delete right_;
-        right_ = new Node<TYPE>;
+    size_t path_size = (depth + 7) / 8;
+    char*  path      = journal.Reserve(path_size);
+    memset(path, 0, path_size);
 
-        *right_ = *obj.right_;
-        right_->prev_ = this;
-    }
-    else if (right_ != nullptr)
+    uint64_t step = depth;
+    for (Node<TYPE>* cur = node; cur->prev_ != nullptr; cur = cur->prev_)
     {
-        delete right_;
-        right_ = nullptr;
+        --step;
+        if (cur->prev_->right_ == cur) path[step / 8] |= (char)(1 << (step % 8));
     }
-    
-    if (obj.left_ != nullptr)
-    {
-        if (left_ != nullptr) delete left_;
-        left_ = new Node<TYPE>;
 
-        *left_ = *obj.left_;
-        left_->prev_ = this;
-    }
-    else if (left_ != nullptr)
+    for (const TYPE* value : { data, object })
     {
-        delete left_;
-        left_ = nullptr;
-    }
+        if (value == nullptr) continue;
 
-    if (prev_ == nullptr) depth_ = 0;
-    else depth_ = prev_->depth_ + 1;
+        if constexpr (std::is_same<TYPE, char*>::value)
+        {
+            uint64_t len = (*value == nullptr) ? UINT64_MAX : strlen(*value);
 
-    return *this;
+            journal.Put(&len, sizeof(len));
+            if (*value != nullptr) journal.Put(*value, len);
+        }
+        else journal.Put(value, sizeof(TYPE));
+    }
+
+    int err = journal.End();
+    TREE_ASSERTOK(err, err, -1);
 }
 
 //------------------------------------------------------------------------------
 
 template <typename TYPE>
-Node<TYPE>::~Node ()
+template <typename BASE>
+void Tree<TYPE>::LoadBase (BASE& base)
 {
-    if (right_ != nullptr)
-    {
-        delete right_;
-        right_ = nullptr;
-    }
+    TREE_ASSERTOK((base.getLine(1).str == nullptr),                 TREE_WRONG_SYNTAX_INPUT_BASE, -1);
+    TREE_ASSERTOK(CHECK_BRACKET(base.getLine(0).str, OPEN_BRACKET), TREE_WRONG_SYNTAX_INPUT_BASE, 0);
 
-    if (left_ != nullptr)
+    size_t line_cur = 1;
+    if (base.getLine(line_cur).str[0] != CLOSE_BRACKET)
     {
-        delete left_;
-        left_  = nullptr;
+        if (root_->AddFromBase(base, line_cur, arena_, &strings_) != 0)
+        {
+            PrintError(TREE_LOGNAME, __FILE__, __LINE__, __FUNC_NAME__, TREE_WRONG_SYNTAX_INPUT_BASE, line_cur);
+            PrintBase(base, line_cur, TREE_LOGNAME);
+            exit(TREE_WRONG_SYNTAX_INPUT_BASE);
+        };
     }
 
-    prev_ = nullptr;
-
-    if constexpr (std::is_same<TYPE, char*>::value) if (is_string_) delete [] data_;
+    size_t num = base.getLinesNum();
 
-    is_string_ = false;
+    TREE_ASSERTOK(CHECK_BRACKET(base.getLine(num - 2).str, CLOSE_BRACKET), TREE_WRONG_SYNTAX_INPUT_BASE, num - 2);
 
-    data_ = POISON<TYPE>;
+    TREE_CHECK;
 }
 
 //------------------------------------------------------------------------------
 
 template <typename TYPE>
-int Node<TYPE>::AddFromBase (const Text& base, size_t& line_cur)
+int Tree<TYPE>::LoadParallel (Text& base, size_t threads)
 {
-    assert(line_cur < base.num_);
+    if ((base.num_ < 2) || CHECK_BRACKET(base.lines_[0].str, OPEN_BRACKET) || (base.lines_[1].str[0] == CLOSE_BRACKET))
+        return TREE_WRONG_SYNTAX_INPUT_BASE;
 
-    if (base.lines_[line_cur].str[0] == CLOSE_BRACKET)
-    {
-        if (CHECK_BRACKET(base.lines_, line_cur, CLOSE_BRACKET)) return line_cur;
-        else return 0;
-    }
+    size_t* skip = (size_t*)calloc(base.num_, sizeof(size_t));
+    if (skip == nullptr) return TREE_NO_MEMORY;
 
-    if constexpr (std::is_same<TYPE, char*>::value)
-    {
-        data_ = new char [base.lines_[line_cur].len + 2];
-        strcpy(data_, base.lines_[line_cur].str);
-        ++line_cur;
+    MatchBrackets(base, skip);
 
-        is_string_ = true;
-    }
-    else
-        sscanf(base.lines_[line_cur++].str, PRINT_FORMAT<TYPE>, &data_);
+    BaseSplit<TYPE> split;
+    split.skip_  = skip;
+    split.limit_ = base.num_ / (threads * PARALLEL_TASKS_PER_THREAD) + 1;
 
-    if (base.lines_[line_cur].str[0] == OPEN_BRACKET)
+    size_t line_cur = 1;
+    if (root_->AddFromBase(base, line_cur, arena_, &strings_, &split) != 0)
     {
-        if (CHECK_BRACKET(base.lines_, line_cur, OPEN_BRACKET)) return line_cur;
+        free(skip);
+        return TREE_WRONG_SYNTAX_INPUT_BASE;
+    }
 
-        right_ = new Node<TYPE>;
-        right_->prev_ = this;
-        right_->depth_ = depth_ + 1;
+    NodeArena<TYPE>*    arenas = new NodeArena<TYPE>[threads];
+    std::atomic<size_t> next   (0);
+    std::atomic<bool>   failed (false);
 
-        int err = right_->AddFromBase(base, ++line_cur);
-        if (err) return err;
-        ++line_cur;
-    }
-    else if (CHECK_BRACKET(base.lines_, line_cur, CLOSE_BRACKET)) return line_cur;
+    StringArena* strings = &strings_;
 
-    if (base.lines_[line_cur].str[0] == OPEN_BRACKET)
+    auto worker = [&base, &split, &next, &failed, skip, arenas, strings](size_t id)
     {
-        if (CHECK_BRACKET(base.lines_, line_cur, OPEN_BRACKET)) return line_cur;
+        for (size_t n = next++; (n < split.nodes_.getSize()) && (not failed); n = next++)
+        {
+            size_t open = split.lines_[n];
+            size_t line = open + 1;
 
-        left_ = new Node<TYPE>;
-        left_->prev_ = this;
-        left_->depth_ = depth_ + 1;
+            if ((split.nodes_[n]->AddFromBase(base, line, arenas[id], strings) != 0) || (line + 1 != skip[open]))
+                failed = true;
+        }
+    };
 
-        int err = left_->AddFromBase(base, ++line_cur);
-        if (err) return err;
-        ++line_cur;
-    }
+    runThreads(threads, worker);
 
-    return 0;
+    for (size_t i = 0; i < threads; ++i) arena_.Merge(arenas[i]);
+
+    delete [] arenas;
+    free(skip);
+
+    return failed ? TREE_WRONG_SYNTAX_INPUT_BASE : TREE_OK;
 }
 
 //------------------------------------------------------------------------------
 
 template <typename TYPE>
-void Tree<TYPE>::Dump (const char* dumpname)
+void Tree<TYPE>::MatchBrackets (Text& base, size_t* skip)
 {
-    assert(dumpname != nullptr);
+    WalkStack<size_t> opened;
+    opened.Push(0);
 
-    FILE* dump = fopen(dumpname, "w");
-    assert(dump != nullptr);
+    bool data = true;
 
-    fprintf(dump, "digraph G{\n" "rankdir = HR;\n node[shape=box];\n");
+    for (size_t line = 1; (line < base.num_) && (opened.getSize() > 0); ++line)
+    {
+        char c = base.lines_[line].str[0];
 
-    root_->Dump(dump);
+        if (data)
+        {
+            data = false;
+            if (c != CLOSE_BRACKET) continue;
+        }
 
-    fprintf(dump, "\tlabelloc=\"t\";"
-                  "\tlabel=\"Tree name: %s\\nType is %s\";"
-                  "}\n", name_, PRINT_TYPE<TYPE>);
+        if (c == OPEN_BRACKET)
+        {
+            opened.Push(line);
+            data = true;
+        }
+        else if (c == CLOSE_BRACKET)
+            skip[opened.Pop()] = line + 1;
+    }
+}
 
-    fclose(dump);
+//------------------------------------------------------------------------------
 
-    char command[128] = "";
+template <typename TYPE>
+int Tree<TYPE>::LoadBin (const char* binname)
+{
+    MappedFile file(binname);
+    if (file.size_ < sizeof(TreeBinHeader)) return TREE_WRONG_BIN_BASE;
 
-#if defined(WIN32)
+    char*  data = file.data_;
+    size_t size = file.size_;
 
-    sprintf(command, "win_iconv -f 1251 -t UTF8 \"%s\" > \"new%s\"", dumpname, dumpname);
+    if constexpr (std::is_same<TYPE, char*>::value)
+        if (strings_.Adopt(file) == nullptr) return TREE_NO_MEMORY;
 
-#elif defined(__linux__)
+    TreeBinHeader header;
+    memcpy(&header, data, sizeof(TreeBinHeader));
 
-    sprintf(command, "iconv -f CP1251 -t UTF8 \"%s\" -o \"new%s\"", dumpname, dumpname);
+    if ((memcmp(header.magic_, TREE_BIN_MAGIC, sizeof(TREE_BIN_MAGIC)) != 0) ||
+        (header.version_   != TREE_BIN_VERSION) ||
+        (header.type_size_ != ((std::is_same<TYPE, char*>::value) ? 0 : sizeof(TYPE))) ||
+        (header.shape_size_ != BinAlign((header.nodes_ + 1) / 2)) ||
+        (size != sizeof(TreeBinHeader) + header.shape_size_ + BinAlign(header.payload_size_)))
+        return TREE_WRONG_BIN_BASE;
 
-#else
-#error Program is only supported by linux or windows platforms
-#endif
+    const unsigned char* shape   = (const unsigned char*)data + sizeof(TreeBinHeader);
+    const char*          payload = data + sizeof(TreeBinHeader) + header.shape_size_;
+    const char*          end     = payload + header.payload_size_;
 
-    int err = system(command);
+    BinChecksum checksum;
+    checksum.Update(data + sizeof(TreeBinHeader), size - sizeof(TreeBinHeader));
 
-    sprintf(command, "dot -Tpng -o %s new%s", DUMP_PICT_NAME, dumpname);
-    if (!err) err = system(command);
+    TreeBinHeader zeroed = header;
+    zeroed.checksum_ = 0;
 
-#if defined(WIN32)
+    checksum.Update((const char*)&zeroed, sizeof(TreeBinHeader));
 
-    sprintf(command, "del new%s", dumpname);
+    if (checksum.getResult() != header.checksum_) return TREE_WRONG_BIN_BASE;
 
-#elif defined(__linux__)
+    WalkStack<Node<TYPE>*> pending;
 
-    sprintf(command, "rm new%s", dumpname);
+    Node<TYPE>* parent = nullptr;
+    bool        right  = false;
 
-#else
-#error Program is only supported by linux or windows platforms
-#endif
+    for (uint64_t i = 0; i < header.nodes_; ++i)
+    {
+        Node<TYPE>* node = root_;
 
-    if (!err) err = system(command);
-}
+        if (i > 0)
+        {
+            if (parent == nullptr) return TREE_WRONG_BIN_BASE;
 
-//------------------------------------------------------------------------------
+            node = arena_.Alloc();
+            if (node == nullptr) return TREE_NO_MEMORY;
 
-template <typename TYPE>
-void Node<TYPE>::Dump (FILE* dump)
-{
-    assert(dump != nullptr);
-    
-    fprintf(dump, "\t \"prev: " PRINT_PTR "\\n", prev_);
-    fprintf(dump, " this: " PRINT_PTR "\\n depth: %lu\\n data: [", this, depth_);
-    TypePrint(dump, data_);
-    fprintf(dump, "]\\n left: " PRINT_PTR " | right: " PRINT_PTR "\\n", left_, right_);
-    fprintf(dump, "\" [shape = box, style = filled, color = black, fillcolor = lightskyblue]\n");
+            node->prev_  = parent;
+            node->depth_ = parent->depth_ + 1;
 
-    if (left_ != nullptr)
-    {
-        fprintf(dump, "\t \"prev: " PRINT_PTR "\\n", prev_);
-        fprintf(dump, " this: " PRINT_PTR "\\n depth: %lu\\n data: [", this, depth_);
-        TypePrint(dump, data_);
-        fprintf(dump, "]\\n left: " PRINT_PTR " | right: " PRINT_PTR "\\n", left_, right_);
+            if (right) parent->right_ = node;
+            else       parent->left_  = node;
+        }
 
-        fprintf(dump, "\" -> \"");
+        unsigned char bits = (shape[i / 2] >> (4 * (i % 2))) & 0xF;
 
-        fprintf(dump, "prev: " PRINT_PTR "\\n", left_->prev_);
-        fprintf(dump, " this: " PRINT_PTR "\\n depth: %lu\\n data: [", left_, left_->depth_);
-        TypePrint(dump, left_->data_);
-        fprintf(dump, "]\\n left: " PRINT_PTR " | right: " PRINT_PTR "\\n", left_->left_, left_->right_);
-        fprintf(dump, "\" [label=\"left\"]\n");
-    }
+        if constexpr (std::is_same<TYPE, char*>::value)
+        {
+            if (not (bits & BIN_NO_DATA))
+            {
+                size_t len = strnlen(payload, end - payload);
+                if (payload + len == end) return TREE_WRONG_BIN_BASE;
 
-    if (right_ != nullptr)
-    {
-        fprintf(dump, "\t \"prev: " PRINT_PTR "\\n", prev_);
-        fprintf(dump, " this: " PRINT_PTR "\\n depth: %lu\\n data: [", this, depth_);
-        TypePrint(dump, data_);
-        fprintf(dump, "]\\n left: " PRINT_PTR " | right: " PRINT_PTR "\\n", left_, right_);
+                node->data_     = (char*)payload;
+                node->in_store_ = true;
+
+                payload += len + 1;
+            }
+        }
+        else
+        {
+            if ((size_t)(end - payload) < sizeof(TYPE)) return TREE_WRONG_BIN_BASE;
+
+            memcpy(&node->data_, payload, sizeof(TYPE));
+            payload += sizeof(TYPE);
+        }
 
-        fprintf(dump, "\" -> \"");
+        if (bits & BIN_HAS_LEFT) pending.Push(node);
 
-        fprintf(dump, "prev: " PRINT_PTR "\\n", right_->prev_);
-        fprintf(dump, " this: " PRINT_PTR "\\n depth: %lu\\n data: [", right_, right_->depth_);
-        TypePrint(dump, right_->data_);
-        fprintf(dump, "]\\n left: " PRINT_PTR " | right: " PRINT_PTR "\\n", right_->left_, right_->right_);
-        fprintf(dump, "\" [label=\"right\"]\n");
+        if (bits & BIN_HAS_RIGHT)
+        {
+            parent = node;
+            right  = true;
+        }
+        else if (pending.getSize() > 0)
+        {
+            parent = pending.Pop();
+            right  = false;
+        }
+        else parent = nullptr;
     }
 
+    if ((parent != nullptr) || (payload != end)) return TREE_WRONG_BIN_BASE;
 
-    if (left_  != nullptr) left_->Dump(dump);
-    if (right_ != nullptr) right_->Dump(dump);
+    return TREE_OK;
 }
 
 //------------------------------------------------------------------------------
 
 template <typename TYPE>
-void Tree<TYPE>::Write (const char* basename)
+void Node<TYPE>::Write (FILE* base)
 {
-    TREE_CHECK;
-
-    FILE* base = fopen(basename, "w");
     assert(base != nullptr);
 
-    fprintf(base, "%c\n", OPEN_BRACKET);
-    if (root_ != nullptr) root_->Write(base);
-    fprintf(base, "%c", CLOSE_BRACKET);
-
-    fclose(base);
+    TextWriter out(base);
+    Write(out);
 }
 
 //------------------------------------------------------------------------------
 
 template <typename TYPE>
-void Node<TYPE>::Write (FILE* base)
+void Node<TYPE>::Write (TextWriter& out, bool compact)
 {
-    assert(base != nullptr);
+    const size_t indent = compact ? 0 : 4;
 
-    for (int i = 0; i <= depth_; ++i) fprintf(base, "    ");
-    TypePrint(base, data_);
-    fprintf(base, "\n");
+    NodeWalk<TYPE> walk(this);
 
-    if (right_ != nullptr)
+    size_t opened = 0;
+    for (Node<TYPE>* node = walk.Next(); node != nullptr; node = walk.Next())
     {
-        for (int i = 0; i <= depth_; ++i) fprintf(base, "    ");
-        fprintf(base, "[\n");
+        size_t level = walk.getDepth();
 
-        right_->Write(base);
-        
-        for (int i = 0; i <= depth_; ++i) fprintf(base, "    ");
-        fprintf(base, "]\n");
-    }
+        for (; (opened >= level) && (opened > 0); --opened)
+        {
+            out.Fill(' ', indent * (depth_ + opened));
+            out.Put("]\n", 2);
+        }
 
-    if (left_ != nullptr)
-    {
-        for (int i = 0; i <= depth_; ++i) fprintf(base, "    ");
-        fprintf(base, "[\n");
+        if (level > 0)
+        {
+            out.Fill(' ', indent * (depth_ + level));
+            out.Put("[\n", 2);
+
+            opened = level;
+        }
 
-        if (left_ != nullptr) left_->Write(base);
+        out.Fill(' ', indent * (node->depth_ + 1));
+        TypePrint(out, node->data_);
+        out.Put('\n');
+    }
 
-        for (int i = 0; i <= depth_; ++i) fprintf(base, "    ");
-        fprintf(base, "]\n");
+    for (; opened > 0; --opened)
+    {
+        out.Fill(' ', indent * (depth_ + opened));
+        out.Put("]\n", 2);
     }
 }
 
@@ -438,6 +1999,7 @@ void Node<TYPE>::setData (TYPE data)
 {
     if constexpr (std::is_same<TYPE, char*>::value) if (is_string_) delete [] data_;
     is_string_ = false;
+    in_store_  = false;
 
     data_ = data;
 }
@@ -457,13 +2019,15 @@ void Node<TYPE>::recountDepth ()
 {
     assert(this != nullptr);
 
-    if (prev_ == nullptr)
-        depth_ = 0;
-    else
-        depth_ = prev_->depth_ + 1;
+    NodeWalk<TYPE> walk(this);
 
-    if (right_ != nullptr) right_->recountDepth();
-    if (left_  != nullptr) left_->recountDepth();
+    for (Node<TYPE>* node = walk.Next(); node != nullptr; node = walk.Next())
+    {
+        if (node->prev_ == nullptr)
+            node->depth_ = 0;
+        else
+            node->depth_ = node->prev_->depth_ + 1;
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -473,27 +2037,41 @@ void Node<TYPE>::recountPrev ()
 {
     assert(this != nullptr);
 
-    if (right_ != nullptr)
-    {
-        right_->prev_ = this;
-        right_->recountPrev();
-    }
-    if (left_  != nullptr)
+    NodeWalk<TYPE> walk(this);
+
+    for (Node<TYPE>* node = walk.Next(); node != nullptr; node = walk.Next())
     {
-        left_->prev_ = this;
-        left_->recountPrev();
+        if (node->right_ != nullptr) node->right_->prev_ = node;
+        if (node->left_  != nullptr) node->left_->prev_  = node;
     }
 }
 
 //------------------------------------------------------------------------------
 
 template <typename TYPE>
-bool Tree<TYPE>::findPath (Stack<size_t>& path, TYPE elem)
+template <size_t INLINE, typename POLICY>
+bool Tree<TYPE>::findPath (Stack<size_t, INLINE, POLICY>& path, TYPE elem)
 {
     TREE_CHECK;
 
     TREE_ASSERTOK((isPOISON(elem)), TREE_INPUT_DATA_POISON, -1);
 
+    if (index_.isBuilt())
+    {
+        Node<TYPE>* leaf = index_.Find(elem);
+        if (leaf == nullptr) return false;
+
+        size_t base = path.getSize();
+        path.Reserve(base + leaf->depth_ + 1);
+
+        for (size_t i = 0; i <= leaf->depth_; ++i) path.Push(0);
+
+        for (Node<TYPE>* node = leaf; node != nullptr; node = node->prev_)
+            path.Set(base + node->depth_, (size_t)node);
+
+        return true;
+    }
+
     bool found = root_->findPath(path, elem);
 
     return found;
@@ -502,34 +2080,35 @@ bool Tree<TYPE>::findPath (Stack<size_t>& path, TYPE elem)
 //------------------------------------------------------------------------------
 
 template <typename TYPE>
-bool Node<TYPE>::findPath (Stack<size_t>& path, TYPE elem)
+template <size_t INLINE, typename POLICY>
+bool Node<TYPE>::findPath (Stack<size_t, INLINE, POLICY>& path, TYPE elem)
 {
-    path.Push((size_t)this);
-    
-    bool found = false;
+    NodeWalk<TYPE> walk(this);
 
-    if (right_ != nullptr)
-    {
-        found = right_->findPath(path, elem);
-        if (found) return found;
-    }
-    if (left_ != nullptr)
+    for (Node<TYPE>* node = walk.Next(); node != nullptr; node = walk.Next())
     {
-        found = left_->findPath(path, elem);
-        if (found) return found;
-    }
+        if ((node->left_ != nullptr) || (node->right_ != nullptr)) continue;
 
-    if ((left_ == nullptr) && (right_ == nullptr))
-    {
+        bool found = false;
         if constexpr (std::is_same<TYPE, char*>::value)
-            found = (strcmp(elem, data_) == 0);
+            found = (strcmp(elem, node->data_) == 0);
         else
-            found = (elem == data_);
-    }
+            found = (elem == node->data_);
 
-    if (not found) path.Pop();
+        if (found)
+        {
+            path.Reserve(path.getSize() + walk.getDepth() + 1);
 
-    return found;
+            for (size_t i = 0; i < walk.getDepth(); ++i)
+                path.Push((size_t)walk.getAncestor(i));
+
+            path.Push((size_t)node);
+
+            return true;
+        }
+    }
+
+    return false;
 }
 
 //------------------------------------------------------------------------------
@@ -553,13 +2132,84 @@ void TypePrint (FILE* fp, const Tree<TYPE>& tree)
 
 //------------------------------------------------------------------------------
 
+template<typename TYPE>
+void TypePrint (TextWriter& out, const TYPE& value)
+{
+    if constexpr (std::is_same<TYPE, char*>::value)
+        out.Put(value);
+
+    else if constexpr (std::is_same<TYPE, char>::value || std::is_same<TYPE, unsigned char>::value)
+        out.Put((char)value);
+
+    else if constexpr (std::is_integral<TYPE>::value && std::is_signed<TYPE>::value)
+        out.PutInt(value);
+
+    else if constexpr (std::is_integral<TYPE>::value)
+        out.PutUInt(value);
+
+    else
+        out.Print(PRINT_FORMAT<TYPE>, value);
+}
+
+//------------------------------------------------------------------------------
+
+template<typename TYPE>
+void swap (Tree<TYPE>& tree1, Tree<TYPE>& tree2) noexcept
+{
+    tree1.Swap(tree2);
+}
+
+//------------------------------------------------------------------------------
+
+template<typename TYPE>
+void BaseToBin (const char* basename, const char* binname)
+{
+    Tree<TYPE> tree((char*)"base", (char*)basename);
+    tree.WriteBin(binname);
+}
+
+//------------------------------------------------------------------------------
+
+template<typename TYPE>
+void BinToBase (const char* binname, const char* basename)
+{
+    Tree<TYPE> tree((char*)"base", (char*)binname);
+    tree.Write(basename);
+}
+
+//------------------------------------------------------------------------------
+
 template <typename TYPE>
 int Tree<TYPE>::Check ()
 {
     int err = TREE_OK;
 
-    if (root_ != nullptr)
-        err = root_->Check(*this);
+    joinSplits();
+
+    badpath_.Clean();
+
+    if (root_ == nullptr) {}
+
+    else if (checked_root_ == root_)
+    {
+        for (size_t i = 0; (i < dirty_.getSize()) && (err == TREE_OK); ++i)
+            err = dirty_[i]->Check();
+
+        if (err) err = root_->Check(*this);
+    }
+    else
+    {
+        size_t threads = std::thread::hardware_concurrency();
+
+        if ((threads > 1) && (arena_.getSize() >= PARALLEL_MIN_SIZE))
+            err = CheckParallel(threads);
+
+        if (err || (threads < 2) || (arena_.getSize() < PARALLEL_MIN_SIZE))
+            err = root_->Check(*this);
+    }
+
+    dirty_.Clean();
+    checked_root_ = (err == TREE_OK) ? root_ : nullptr;
 
     errCode_ = err;
 
@@ -569,54 +2219,155 @@ int Tree<TYPE>::Check ()
 //------------------------------------------------------------------------------
 
 template <typename TYPE>
-int Node<TYPE>::Check (Tree<TYPE>& tree)
+int Tree<TYPE>::CheckParallel (size_t threads)
 {
-    if (((prev_ == nullptr) && (depth_ != 0)) ||
-        ((prev_ != nullptr) && (depth_ != prev_->depth_ + 1)))
+    TaskPool<Node<TYPE>*> pool(threads);
+    std::atomic<int>      error (TREE_OK);
+
+    auto job = [&pool, &error](Node<TYPE>* task, size_t thread)
     {
-        tree.path2badnode_.Push(data_);
-        return TREE_WRONG_DEPTH;
+        WalkStack<Node<TYPE>*> nodes;
+        nodes.Push(task);
+
+        for (size_t step = 0; nodes.getSize() != 0; ++step)
+        {
+            if (step % PARALLEL_SPLIT_STEPS == 0)
+            {
+                if (error.load(std::memory_order_relaxed) != TREE_OK) return;
+
+                if ((nodes.getSize() > 1) && pool.isHungry(thread))
+                {
+                    pool.Spawn(thread, nodes[0]);
+                    nodes.Shift(1);
+                }
+            }
+
+            Node<TYPE>* node = nodes.Pop();
+
+            int err = node->CheckLinks();
+            if (err) error.store(err);
+
+            if (node->left_  != nullptr) nodes.Push(node->left_);
+            if (node->right_ != nullptr) nodes.Push(node->right_);
+        }
+    };
+
+    pool.Run(root_, job);
+
+    return error.load();
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Tree<TYPE>::markDirty (Node<TYPE>* node)
+{
+    if ((node == nullptr) || (checked_root_ != root_) || (dirty_.getSize() == DIRTY_MAX_SIZE))
+    {
+        dirty_.Clean();
+        checked_root_ = nullptr;
+
+        return;
     }
 
-    if (prev_ != nullptr)
-        if ((prev_->right_ != this) &&
-            (prev_->left_  != this))
+    dirty_.Push(node);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+void Tree<TYPE>::dropDirty (Node<TYPE>* node)
+{
+    size_t kept = 0;
+
+    for (size_t i = 0; i < dirty_.getSize(); ++i)
+    {
+        Node<TYPE>* cur   = dirty_[i];
+        size_t      steps = cur->depth_ + 1;
+
+        while ((cur != nullptr) && (cur != node) && (steps > 0))
         {
-            tree.path2badnode_.Push(data_);
-            return TREE_WRONG_PREV_NODE;
+            cur = cur->prev_;
+            --steps;
         }
 
-    if (right_ != nullptr)
-        if (right_->prev_ != this)
+        if (cur == nullptr) dirty_[kept++] = dirty_[i];
+
+        else if (cur != node)
         {
-            tree.path2badnode_.Push(data_);
-            return TREE_WRONG_PREV_NODE;
+            markDirty();
+            return;
         }
+    }
+
+    dirty_.Cut(kept);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename TYPE>
+int Node<TYPE>::Check (Tree<TYPE>& tree)
+{
+    NodeWalk<TYPE> walk(this);
+
+    for (Node<TYPE>* node = walk.Next(); node != nullptr; node = walk.Next())
+    {
+        int err = node->CheckLinks();
 
-    if (left_ != nullptr)
-        if (left_->prev_ != this)
+        if (err)
         {
-            tree.path2badnode_.Push(data_);
-            return TREE_WRONG_PREV_NODE;
+            tree.path2badnode_.Push(node->data_);
+
+            for (size_t i = walk.getDepth(); i > 0; --i)
+                tree.path2badnode_.Push(walk.getAncestor(i - 1)->data_);
+
+            for (size_t i = 0; i < walk.getDepth(); ++i)
+                tree.badpath_.Push(walk.getAncestor(i));
+
+            tree.badpath_.Push(node);
+
+            return err;
         }
+    }
 
-    int err = TREE_OK;
+    return TREE_OK;
+}
+
+//------------------------------------------------------------------------------
 
-    if (right_ != nullptr)
-        err = right_->Check(tree);
+template <typename TYPE>
+int Node<TYPE>::Check ()
+{
+    NodeWalk<TYPE> walk(this);
 
-    if (err)
+    for (Node<TYPE>* node = walk.Next(); node != nullptr; node = walk.Next())
     {
-        tree.path2badnode_.Push(data_);
-        return err;
+        int err = node->CheckLinks();
+        if (err) return err;
     }
 
-    if (left_ != nullptr)
-        err = left_->Check(tree);
+    return TREE_OK;
+}
 
-    if (err) tree.path2badnode_.Push(data_);
+//------------------------------------------------------------------------------
 
-    return err;
+template <typename TYPE>
+int Node<TYPE>::CheckLinks ()
+{
+    if (((prev_ == nullptr) && (depth_ != 0)) ||
+        ((prev_ != nullptr) && (depth_ != prev_->depth_ + 1)))
+        return TREE_WRONG_DEPTH;
+
+    if ((prev_ != nullptr) && (prev_->right_ != this) && (prev_->left_ != this))
+        return TREE_WRONG_PREV_NODE;
+
+    if ((right_ != nullptr) && (right_->prev_ != this))
+        return TREE_WRONG_PREV_NODE;
+
+    if ((left_ != nullptr) && (left_->prev_ != this))
+        return TREE_WRONG_PREV_NODE;
+
+    return TREE_OK;
 }
 
 //------------------------------------------------------------------------------
@@ -675,7 +2426,7 @@ void Tree<TYPE>::PrintError (const char* logname, const char* file, int line, co
 
         fprintf(log, "\n");
     }
-    if (err != TREE_WRONG_SYNTAX_INPUT_BASE) fprintf(log, "You can look tree dump in %s\n\n", DUMP_PICT_NAME);
+    if (err != TREE_WRONG_SYNTAX_INPUT_BASE) fprintf(log, "You can look tree dump in %s\n\n", DUMP_NAME);
     fclose(log);
 
     ////
@@ -696,13 +2447,14 @@ void Tree<TYPE>::PrintError (const char* logname, const char* file, int line, co
 
         printf("\n");
     }
-    if (err != TREE_WRONG_SYNTAX_INPUT_BASE) printf (     "You can look tree dump in %s\n\n", DUMP_PICT_NAME);
+    if (err != TREE_WRONG_SYNTAX_INPUT_BASE) printf (     "You can look tree dump in %s\n\n", DUMP_NAME);
 }
 
 //------------------------------------------------------------------------------
 
 template <typename TYPE>
-void Tree<TYPE>::PrintBase (Text& base, size_t line, const char* logname)
+template <typename BASE>
+void Tree<TYPE>::PrintBase (BASE& base, size_t line, const char* logname)
 {
     assert(logname != nullptr);
 
@@ -719,10 +2471,13 @@ void Tree<TYPE>::PrintBase (Text& base, size_t line, const char* logname)
     
     for (int i = -2; i <= 2; ++i)
     {
-        if ((true_line + i > 0) && (true_line + i <= base.num_))
+        if (true_line + i == 0) continue;
+
+        Line cur = base.getLine(true_line + i - 1);
+        if (cur.str != nullptr)
         {
-            fprintf(log, "%s%5ld: %s\n", ((i == 0)? "=>" : "  "), true_line + i, base.lines_[true_line + i - 1].str);
-            printf (     "%s%5ld: %s\n", ((i == 0)? "=>" : "  "), true_line + i, base.lines_[true_line + i - 1].str);
+            fprintf(log, "%s%5ld: %s\n", ((i == 0)? "=>" : "  "), true_line + i, cur.str);
+            printf (     "%s%5ld: %s\n", ((i == 0)? "=>" : "  "), true_line + i, cur.str);
         }
     }
 
@@ -0,0 +1,132 @@
+/*------------------------------------------------------------------------------
+    * File:        TreeBin.h                                                   *
+    * Description: Declaration of the binary base file format.                 *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+#ifndef TREEBIN_H_INCLUDED
+#define TREEBIN_H_INCLUDED
+
+#define _CRT_SECURE_NO_WARNINGS
+
+
+#include <stdint.h>
+#include <string.h>
+
+
+/*------------------------------------------------------------------------------
+    Binary base layout (all numbers in the byte order of the machine):
+
+    TreeBinHeader                   64 bytes
+    shape                           4 bits per node in pre-order (right child
+                                    first, as in the text base), two nodes per
+                                    byte, padded to TREE_BIN_ALIGN
+    payload                         node data in the same order: sizeof(TYPE)
+                                    bytes per node, or '\0' terminated strings
+                                    for char* trees, padded to TREE_BIN_ALIGN
+
+    The checksum covers the padded shape and payload, then the header with
+    the checksum taken as 0.
+*///----------------------------------------------------------------------------
+
+const char     TREE_BIN_MAGIC[8]    = { 'T', 'R', 'E', 'E', 'B', 'I', 'N', '\0' };
+const uint32_t TREE_BIN_VERSION     = 2;
+const size_t   TREE_BIN_ALIGN       = 32;
+const size_t   TREE_BIN_BUFFER_SIZE = 65536;
+
+enum TreeBinShape
+{
+    BIN_HAS_RIGHT = 1                                               ,
+    BIN_HAS_LEFT  = 2                                               ,
+    BIN_NO_DATA   = 4                                               ,
+};
+
+
+struct TreeBinHeader
+{
+    char     magic_[8]     = {};
+    uint32_t version_      = 0;
+    uint32_t type_size_    = 0;
+    uint64_t nodes_        = 0;
+    uint64_t shape_size_   = 0;
+    uint64_t payload_size_ = 0;
+    uint64_t checksum_     = 0;
+    uint64_t reserved_[2]  = {};
+};
+
+static_assert(sizeof(TreeBinHeader) % TREE_BIN_ALIGN == 0, "binary base header must keep the data aligned");
+
+//------------------------------------------------------------------------------
+/*! @brief   Round the size up to TREE_BIN_ALIGN.
+ *
+ *  @param   size        Size
+ *
+ *  @return  aligned size
+ */
+
+inline size_t BinAlign (size_t size)
+{
+    return (size + TREE_BIN_ALIGN - 1) / TREE_BIN_ALIGN * TREE_BIN_ALIGN;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Checksum of the binary base. The data is processed by 8 byte words
+ *           in four independent lanes, so it runs close to memory speed.
+ */
+
+class BinChecksum
+{
+    uint64_t lanes_[4] = { 0x9e3779b97f4a7c15ULL, 0xc2b2ae3d27d4eb4fULL,
+                           0x165667b19e3779f9ULL, 0x27d4eb2f165667c5ULL };
+
+public:
+
+//------------------------------------------------------------------------------
+/*! @brief   Add data to the checksum.
+ *
+ *  @param   data        Data
+ *  @param   size        Size of the data, multiple of TREE_BIN_ALIGN
+ */
+
+    void Update (const char* data, size_t size)
+    {
+        for (size_t i = 0; i < size; i += TREE_BIN_ALIGN)
+        {
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                uint64_t word = 0;
+                memcpy(&word, data + i + lane * sizeof(uint64_t), sizeof(uint64_t));
+
+                lanes_[lane] = (lanes_[lane] ^ word) * 0x9fb21c651e98df25ULL;
+                lanes_[lane] = (lanes_[lane] << 31) | (lanes_[lane] >> 33);
+            }
+        }
+    }
+
+//------------------------------------------------------------------------------
+/*! @brief   Get checksum of all the data added.
+ *
+ *  @return  checksum
+ */
+
+    uint64_t getResult () const
+    {
+        uint64_t hsh = 0;
+
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            hsh = (hsh ^ lanes_[lane]) * 0x9fb21c651e98df25ULL;
+            hsh ^= hsh >> 29;
+        }
+
+        return hsh;
+    }
+
+//------------------------------------------------------------------------------
+};
+
+#endif // TREEBIN_H_INCLUDED
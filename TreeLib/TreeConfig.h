@@ -33,11 +33,27 @@
 #endif
 
 
+#define TREE_ASSERTOK(cond, err, line) if (cond)                                                                  \
+                                       {                                                                          \
+                                         PrintError(TREE_LOGNAME , __FILE__, __LINE__, __FUNC_NAME__, err, line); \
+                                         exit(err);                                                               \
+                                       } //
+
+
 char const * const DUMP_NAME         = "graph.dot";
 char const * const DUMP_PICT_NAME    = "graph.png";
 char const * const DEFAULT_BASE_NAME = "Base.dat";
+char const * const DEFAULT_BIN_NAME  = "Base.bin";
 char const * const TREE_LOGNAME      = "tree.log";
 
+const size_t PARALLEL_MIN_SIZE         = 65536;
+const size_t PARALLEL_TASKS_PER_THREAD = 8;
+const size_t PARALLEL_SPLIT_STEPS      = 64;       // nodes walked between offers of work to idle threads
+const size_t DIRTY_MAX_SIZE            = 64;
+const size_t SPLIT_LOCK_STRIPES        = 64;       // locks and arenas shared by leaves split in parallel
+const size_t DUMP_ERROR_LEVELS         = 3;
+const size_t PATH_INLINE_SIZE          = 32;
+
 const char OPEN_BRACKET  = '[';
 const char CLOSE_BRACKET = ']';
 
@@ -60,6 +76,10 @@ enum TreeErrors
     TREE_WRONG_INPUT_TREE_NAME                                      ,
     TREE_WRONG_PREV_NODE                                            ,
     TREE_WRONG_SYNTAX_INPUT_BASE                                    ,
+    TREE_WRONG_BIN_BASE                                             ,
+    TREE_WRONG_JOURNAL                                              ,
+    TREE_WRITE_FAILED                                               ,
+    TREE_WRONG_PATH                                                 ,
 };
 
 char const * const tree_errstr[] =
@@ -80,6 +100,10 @@ char const * const tree_errstr[] =
     "Wrong input tree name"                                         ,
     "Wrong pointer to previous node found"                          ,
     "Wrong syntax of input base"                                    ,
+    "Binary base is damaged or has another data type"               ,
+    "Journal does not match the base"                               ,
+    "Failed to write the file"                                      ,
+    "Path does not lead through the current version of the tree"    ,
 };
 
 
@@ -0,0 +1,348 @@
+/*------------------------------------------------------------------------------
+    * File:        TreeJournal.h                                               *
+    * Description: Declaration of the journal of tree changes.                 *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+#ifndef TREEJOURNAL_H_INCLUDED
+#define TREEJOURNAL_H_INCLUDED
+
+#define _CRT_SECURE_NO_WARNINGS
+
+
+#include "../StringLib/StringLib.h"
+#include "TreeConfig.h"
+#include "TreeBin.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <fcntl.h>
+
+
+/*------------------------------------------------------------------------------
+    Journal layout (all numbers in the byte order of the machine):
+
+    TreeJournalHeader               64 bytes, names the base file (snapshot)
+                                    the journal continues by its size and
+                                    checksum
+    records                         JournalRecord and the record body
+
+    Record body:
+
+    op                              1 byte, TreeJournalOp
+    depth                           8 bytes, length of the path to the node
+    path                            (depth + 7) / 8 bytes, bit i is set if the
+                                    step i from the root goes to the right
+    data                            for JOURNAL_SET and JOURNAL_ADD_*:
+                                    sizeof(TYPE) bytes, or for char* trees
+                                    8 bytes of length (UINT64_MAX for nullptr)
+                                    and the string without '\0'
+                                    for JOURNAL_SPLIT_*: new data of the leaf,
+                                    then data of the added leaf, so a split is
+                                    replayed whole or not at all
+
+    A record with an empty path on a tree without root first makes an empty
+    root: a root added after the old one was deleted is not logged itself,
+    its first change is.
+
+    A journal of another base is ignored: the base was written after it. A
+    record that is cut or damaged ends the journal, it is the tail of a write
+    interrupted by a crash.
+*///----------------------------------------------------------------------------
+
+const char     TREE_JOURNAL_MAGIC[8]  = { 'T', 'R', 'E', 'E', 'J', 'N', 'L', '\0' };
+const uint32_t TREE_JOURNAL_VERSION   = 1;
+const size_t   JOURNAL_SYNC_RECORDS   = 64;
+const size_t   JOURNAL_BUFFER_SIZE    = 65536;
+
+char const * const JOURNAL_SUFFIX = ".jnl";
+char const * const TEMP_SUFFIX    = ".tmp";
+
+enum TreeJournalOp
+{
+    JOURNAL_SET         = 1                                         ,
+    JOURNAL_ADD_RIGHT   = 2                                         ,
+    JOURNAL_ADD_LEFT    = 3                                         ,
+    JOURNAL_DELETE      = 4                                         ,
+    JOURNAL_SPLIT_RIGHT = 5                                         ,
+    JOURNAL_SPLIT_LEFT  = 6                                         ,
+};
+
+
+struct TreeJournalHeader
+{
+    char     magic_[8]      = {};
+    uint32_t version_       = 0;
+    uint32_t type_size_     = 0;
+    uint64_t base_size_     = 0;
+    uint64_t base_checksum_ = 0;
+    uint64_t reserved_[4]   = {};
+};
+
+struct JournalRecord
+{
+    uint32_t size_     = 0;
+    uint32_t checksum_ = 0;
+};
+
+static_assert(sizeof(TreeJournalHeader) == 64, "journal header must keep its size");
+
+
+class TreeJournal
+{
+    int    fd_       = -1;
+    bool   failed_   = false;
+
+    char*  buffer_   = nullptr;
+    size_t capacity_ = 0;
+    size_t used_     = 0;
+    size_t record_   = 0;
+    size_t records_  = 0;
+    size_t size_     = 0;
+
+    char*  basename_    = nullptr;
+    char*  journalname_ = nullptr;
+
+public:
+
+//------------------------------------------------------------------------------
+/*! @brief   Journal constructor, the files are not touched.
+ *
+ *  @param   basename    Name of the base file the journal continues
+ */
+
+    TreeJournal (const char* basename);
+
+//------------------------------------------------------------------------------
+/*! @brief   Journal without a file, its records are made apart and moved to a
+ *           journal with a file by Append.
+ */
+
+    TreeJournal ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Journal copy constructor (deleted).
+ *
+ *  @param   obj         Source journal
+ */
+
+    TreeJournal (const TreeJournal& obj) = delete;
+
+    TreeJournal& operator = (const TreeJournal& obj) = delete;
+
+//------------------------------------------------------------------------------
+/*! @brief   Journal destructor, the records are synced.
+ */
+
+   ~TreeJournal ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Open the journal file for appending.
+ *
+ *  @param   size        Size of the valid part of the file, the rest is cut
+ *
+ *  @return  error code
+ */
+
+    int Open (size_t size);
+
+//------------------------------------------------------------------------------
+/*! @brief   Create a new empty journal file in place of the old one, the
+ *           file is written to a temporary file and renamed.
+ *
+ *  @param   header      Header of the journal
+ *
+ *  @return  error code
+ */
+
+    int Create (const TreeJournalHeader& header);
+
+//------------------------------------------------------------------------------
+/*! @brief   Start a new record.
+ *
+ *  @param   op          Operation
+ *  @param   depth       Length of the path to the node
+ */
+
+    void Begin (uint8_t op, uint64_t depth);
+
+//------------------------------------------------------------------------------
+/*! @brief   Add data to the record.
+ *
+ *  @param   data        Data
+ *  @param   size        Size of the data
+ */
+
+    void Put (const void* data, size_t size);
+
+//------------------------------------------------------------------------------
+/*! @brief   Get place for the data of the record.
+ *
+ *  @param   size        Size of the data
+ *
+ *  @return  pointer to the place, valid until the next Put or Reserve
+ */
+
+    char* Reserve (size_t size);
+
+//------------------------------------------------------------------------------
+/*! @brief   Finish the record, every JOURNAL_SYNC_RECORDS records are synced.
+ *
+ *  @return  error code
+ */
+
+    int End ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Move the finished records of another journal to the end of this
+ *           one, every JOURNAL_SYNC_RECORDS records are synced.
+ *
+ *  @param   records     Journal without a file, left empty
+ *
+ *  @return  error code
+ */
+
+    int Append (TreeJournal& records);
+
+//------------------------------------------------------------------------------
+/*! @brief   Write the records to the file and wait until they reach the disk.
+ *
+ *  @return  error code
+ */
+
+    int Sync ();
+
+//------------------------------------------------------------------------------
+/*! @brief   Get size of the journal file with the records not synced yet.
+ *
+ *  @return  size in bytes
+ */
+
+    size_t getSize () const;
+
+//------------------------------------------------------------------------------
+/*! @brief   Get name of the base file.
+ *
+ *  @return  name of the base file
+ */
+
+    const char* getBaseName () const;
+
+//------------------------------------------------------------------------------
+/*! @brief   Get name of the journal file.
+ *
+ *  @return  name of the journal file
+ */
+
+    const char* getJournalName () const;
+
+//------------------------------------------------------------------------------
+/*! @brief   Fill the header of the journal that continues the base file.
+ *
+ *  @param   basename    Name of the base file
+ *  @param   type_size   Size of the tree data type, 0 for char*
+ *  @param   header      Header to fill
+ *
+ *  @return  error code
+ */
+
+    static int makeHeader (const char* basename, uint32_t type_size, TreeJournalHeader& header);
+
+//------------------------------------------------------------------------------
+/*! @brief   Find the records of the journal.
+ *
+ *  @param   file        Mapped journal file
+ *  @param   header      Expected header
+ *
+ *  @return  offset of the first record, 0 if the journal is of another base
+ */
+
+    static size_t findRecords (const MappedFile& file, const TreeJournalHeader& header);
+
+//------------------------------------------------------------------------------
+/*! @brief   Get the next record of the journal.
+ *
+ *  @param   file        Mapped journal file
+ *  @param   pos         Offset of the record, moved to the next one
+ *  @param   body        Body of the record
+ *  @param   size        Size of the body
+ *
+ *  @return  1 if the record is complete and not damaged, else 0
+ */
+
+    static bool nextRecord (const MappedFile& file, size_t& pos, const char*& body, size_t& size);
+
+//------------------------------------------------------------------------------
+/*! @brief   Wait until the written file reaches the disk.
+ *
+ *  @param   filename    File name
+ *
+ *  @return  error code
+ */
+
+    static int syncFile (const char* filename);
+
+//------------------------------------------------------------------------------
+/*! @brief   Replace the file by another one, the replace is atomic where the
+ *           system allows it.
+ *
+ *  @param   from        Name of the new file
+ *  @param   to          Name of the replaced file
+ *
+ *  @return  error code
+ */
+
+    static int replaceFile (const char* from, const char* to);
+
+//------------------------------------------------------------------------------
+/*! @brief   Make a file name from the name and the suffix.
+ *
+ *  @param   name        Name
+ *  @param   suffix      Suffix
+ *
+ *  @return  new string, free it with free()
+ */
+
+    static char* makeName (const char* name, const char* suffix);
+
+/*------------------------------------------------------------------------------
+                   Private functions                                           *
+*///----------------------------------------------------------------------------
+
+private:
+
+//------------------------------------------------------------------------------
+/*! @brief   Checksum of a record body.
+ *
+ *  @param   data        Body
+ *  @param   size        Size of the body
+ *
+ *  @return  checksum
+ */
+
+    static uint32_t getChecksum (const char* data, size_t size);
+
+//------------------------------------------------------------------------------
+/*! @brief   Write the data to the file.
+ *
+ *  @param   fd          File descriptor
+ *  @param   data        Data
+ *  @param   size        Size of the data
+ *
+ *  @return  error code
+ */
+
+    static int writeAll (int fd, const char* data, size_t size);
+
+//------------------------------------------------------------------------------
+};
+
+#include "TreeJournal.ipp"
+
+#endif // TREEJOURNAL_H_INCLUDED
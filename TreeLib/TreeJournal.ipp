@@ -0,0 +1,410 @@
+/*------------------------------------------------------------------------------
+    * File:        TreeJournal.ipp                                             *
+    * Description: Functions of the journal of tree changes.                   *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+#if !defined (_WIN32)
+#define JOURNAL_BINARY 0
+#else
+#define JOURNAL_BINARY _O_BINARY
+#endif // _WIN32
+
+//------------------------------------------------------------------------------
+
+inline TreeJournal::TreeJournal () { }
+
+//------------------------------------------------------------------------------
+
+inline TreeJournal::TreeJournal (const char* basename)
+{
+    assert(basename != nullptr);
+
+    basename_    = makeName(basename, "");
+    journalname_ = makeName(basename, JOURNAL_SUFFIX);
+}
+
+//------------------------------------------------------------------------------
+
+inline TreeJournal::~TreeJournal ()
+{
+    Sync();
+
+    if (fd_ >= 0) close(fd_);
+
+    free(buffer_);
+    free(basename_);
+    free(journalname_);
+
+    fd_     = -1;
+    buffer_ = nullptr;
+}
+
+//------------------------------------------------------------------------------
+
+inline int TreeJournal::Open (size_t size)
+{
+    if (fd_ >= 0) close(fd_);
+
+    used_    = 0;
+    records_ = 0;
+    failed_  = false;
+
+    fd_ = open(journalname_, O_WRONLY | JOURNAL_BINARY);
+    if (fd_ < 0) return TREE_WRITE_FAILED;
+
+#if !defined (_WIN32)
+    if (ftruncate(fd_, size) != 0) return TREE_WRITE_FAILED;
+#else
+    if (_chsize_s(fd_, size) != 0) return TREE_WRITE_FAILED;
+#endif // _WIN32
+
+    if (lseek(fd_, 0, SEEK_END) < 0) return TREE_WRITE_FAILED;
+
+    size_ = size;
+
+    return TREE_OK;
+}
+
+//------------------------------------------------------------------------------
+
+inline int TreeJournal::Create (const TreeJournalHeader& header)
+{
+    char* temp = makeName(journalname_, TEMP_SUFFIX);
+
+    int fd  = open(temp, O_WRONLY | O_CREAT | O_TRUNC | JOURNAL_BINARY, 0644);
+    int err = (fd < 0) ? TREE_WRITE_FAILED : writeAll(fd, (const char*)&header, sizeof(header));
+
+    if (fd >= 0) close(fd);
+
+    if (err == TREE_OK) err = syncFile(temp);
+    if (err == TREE_OK) err = replaceFile(temp, journalname_);
+    if (err == TREE_OK) err = Open(sizeof(header));
+
+    free(temp);
+
+    return err;
+}
+
+//------------------------------------------------------------------------------
+
+inline void TreeJournal::Begin (uint8_t op, uint64_t depth)
+{
+    record_ = used_;
+
+    Reserve(sizeof(JournalRecord));
+    Put(&op,    sizeof(op));
+    Put(&depth, sizeof(depth));
+}
+
+//------------------------------------------------------------------------------
+
+inline void TreeJournal::Put (const void* data, size_t size)
+{
+    if (size > 0) memcpy(Reserve(size), data, size);
+}
+
+//------------------------------------------------------------------------------
+
+inline char* TreeJournal::Reserve (size_t size)
+{
+    if (used_ + size > capacity_)
+    {
+        size_t capacity = (capacity_ == 0) ? JOURNAL_BUFFER_SIZE : capacity_;
+        while (capacity < used_ + size) capacity *= 2;
+
+        char* temp = (char*)realloc(buffer_, capacity);
+        assert(temp != nullptr);
+
+        buffer_   = temp;
+        capacity_ = capacity;
+    }
+
+    char* place = buffer_ + used_;
+    used_ += size;
+
+    return place;
+}
+
+//------------------------------------------------------------------------------
+
+inline int TreeJournal::End ()
+{
+    JournalRecord record;
+
+    const char* body = buffer_ + record_ + sizeof(JournalRecord);
+
+    record.size_     = (uint32_t)(used_ - record_ - sizeof(JournalRecord));
+    record.checksum_ = getChecksum(body, record.size_);
+
+    memcpy(buffer_ + record_, &record, sizeof(record));
+
+    ++records_;
+
+    if ((journalname_ != nullptr) && ((records_ >= JOURNAL_SYNC_RECORDS) || (used_ >= JOURNAL_BUFFER_SIZE))) return Sync();
+
+    return failed_ ? TREE_WRITE_FAILED : TREE_OK;
+}
+
+//------------------------------------------------------------------------------
+
+inline int TreeJournal::Append (TreeJournal& records)
+{
+    assert(records.journalname_ == nullptr);
+
+    Put(records.buffer_, records.used_);
+
+    records_ += records.records_;
+
+    records.used_    = 0;
+    records.records_ = 0;
+
+    if ((records_ >= JOURNAL_SYNC_RECORDS) || (used_ >= JOURNAL_BUFFER_SIZE)) return Sync();
+
+    return failed_ ? TREE_WRITE_FAILED : TREE_OK;
+}
+
+//------------------------------------------------------------------------------
+
+inline int TreeJournal::Sync ()
+{
+    if ((fd_ < 0) || failed_) return (used_ == 0) && !failed_ ? TREE_OK : TREE_WRITE_FAILED;
+
+    if (used_ > 0)
+    {
+        if (writeAll(fd_, buffer_, used_) != TREE_OK) failed_ = true;
+        else
+        {
+            size_   += used_;
+            used_    = 0;
+            records_ = 0;
+        }
+    }
+
+#if !defined (_WIN32)
+    if (!failed_ && (fsync(fd_) != 0)) failed_ = true;
+#else
+    if (!failed_ && (_commit(fd_) != 0)) failed_ = true;
+#endif // _WIN32
+
+    return failed_ ? TREE_WRITE_FAILED : TREE_OK;
+}
+
+//------------------------------------------------------------------------------
+
+inline size_t TreeJournal::getSize () const
+{
+    return size_ + used_;
+}
+
+//------------------------------------------------------------------------------
+
+inline const char* TreeJournal::getBaseName () const
+{
+    return basename_;
+}
+
+//------------------------------------------------------------------------------
+
+inline const char* TreeJournal::getJournalName () const
+{
+    return journalname_;
+}
+
+//------------------------------------------------------------------------------
+
+inline int TreeJournal::makeHeader (const char* basename, uint32_t type_size, TreeJournalHeader& header)
+{
+    assert(basename != nullptr);
+
+    struct stat info = {};
+    if (stat(basename, &info) != 0) return TREE_WRITE_FAILED;
+
+    memcpy(header.magic_, TREE_JOURNAL_MAGIC, sizeof(TREE_JOURNAL_MAGIC));
+
+    header.version_   = TREE_JOURNAL_VERSION;
+    header.type_size_ = type_size;
+    header.base_size_ = info.st_size;
+
+    BinChecksum checksum;
+
+    if (info.st_size > 0)
+    {
+        MappedFile file(basename);
+        if (file.data_ == nullptr) return TREE_WRITE_FAILED;
+
+        size_t aligned = file.size_ / TREE_BIN_ALIGN * TREE_BIN_ALIGN;
+        checksum.Update(file.data_, aligned);
+
+        char tail[TREE_BIN_ALIGN] = {};
+        memcpy(tail, file.data_ + aligned, file.size_ - aligned);
+        checksum.Update(tail, TREE_BIN_ALIGN);
+
+        header.base_size_ = file.size_;
+    }
+
+    header.base_checksum_ = checksum.getResult();
+
+    return TREE_OK;
+}
+
+//------------------------------------------------------------------------------
+
+inline size_t TreeJournal::findRecords (const MappedFile& file, const TreeJournalHeader& header)
+{
+    if ((file.data_ == nullptr) || (file.size_ < sizeof(TreeJournalHeader))) return 0;
+
+    TreeJournalHeader found;
+    memcpy(&found, file.data_, sizeof(found));
+
+    if ( (memcmp(found.magic_, header.magic_, sizeof(found.magic_)) != 0) ||
+         (found.version_       != header.version_)                        ||
+         (found.type_size_     != header.type_size_)                      ||
+         (found.base_size_     != header.base_size_)                      ||
+         (found.base_checksum_ != header.base_checksum_) )
+        return 0;
+
+    return sizeof(TreeJournalHeader);
+}
+
+//------------------------------------------------------------------------------
+
+inline bool TreeJournal::nextRecord (const MappedFile& file, size_t& pos, const char*& body, size_t& size)
+{
+    if ((file.data_ == nullptr) || (pos + sizeof(JournalRecord) > file.size_)) return 0;
+
+    JournalRecord record;
+    memcpy(&record, file.data_ + pos, sizeof(record));
+
+    if (record.size_ > file.size_ - pos - sizeof(JournalRecord)) return 0;
+
+    const char* data = file.data_ + pos + sizeof(JournalRecord);
+    if (getChecksum(data, record.size_) != record.checksum_) return 0;
+
+    body = data;
+    size = record.size_;
+    pos += sizeof(JournalRecord) + record.size_;
+
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+
+inline int TreeJournal::syncFile (const char* filename)
+{
+    assert(filename != nullptr);
+
+    int fd = open(filename, O_RDWR | JOURNAL_BINARY);
+    if (fd < 0) return TREE_WRITE_FAILED;
+
+#if !defined (_WIN32)
+    int err = fsync(fd);
+#else
+    int err = _commit(fd);
+#endif // _WIN32
+
+    close(fd);
+
+    return (err == 0) ? TREE_OK : TREE_WRITE_FAILED;
+}
+
+//------------------------------------------------------------------------------
+
+inline int TreeJournal::replaceFile (const char* from, const char* to)
+{
+    assert(from != nullptr);
+    assert(to   != nullptr);
+
+#if defined (_WIN32)
+    remove(to);
+#endif // _WIN32
+
+    if (rename(from, to) != 0) return TREE_WRITE_FAILED;
+
+#if !defined (_WIN32)
+    const char* slash = strrchr(to, '/');
+
+    char* dirname = (slash == nullptr) ? makeName(".", "") : makeName(to, "");
+    if (slash != nullptr) dirname[(slash == to) ? 1 : slash - to] = '\0';
+
+    int fd = open(dirname, O_RDONLY);
+    free(dirname);
+
+    if (fd >= 0)
+    {
+        fsync(fd);
+        close(fd);
+    }
+#endif // _WIN32
+
+    return TREE_OK;
+}
+
+//------------------------------------------------------------------------------
+
+inline char* TreeJournal::makeName (const char* name, const char* suffix)
+{
+    assert(name   != nullptr);
+    assert(suffix != nullptr);
+
+    size_t name_len   = strlen(name);
+    size_t suffix_len = strlen(suffix);
+
+    char* result = (char*)malloc(name_len + suffix_len + 1);
+    assert(result != nullptr);
+
+    memcpy(result, name, name_len);
+    memcpy(result + name_len, suffix, suffix_len + 1);
+
+    return result;
+}
+
+//------------------------------------------------------------------------------
+
+inline uint32_t TreeJournal::getChecksum (const char* data, size_t size)
+{
+    BinChecksum checksum;
+
+    size_t aligned = size / TREE_BIN_ALIGN * TREE_BIN_ALIGN;
+    checksum.Update(data, aligned);
+
+    char tail[2 * TREE_BIN_ALIGN] = {};
+    memcpy(tail, data + aligned, size - aligned);
+
+    uint64_t size64 = size;
+    memcpy(tail + TREE_BIN_ALIGN, &size64, sizeof(size64));
+
+    checksum.Update(tail, 2 * TREE_BIN_ALIGN);
+
+    uint64_t result = checksum.getResult();
+
+    return (uint32_t)(result ^ (result >> 32));
+}
+
+//------------------------------------------------------------------------------
+
+inline int TreeJournal::writeAll (int fd, const char* data, size_t size)
+{
+    while (size > 0)
+    {
+#if !defined (_WIN32)
+        ssize_t done = write(fd, data, size);
+#else
+        int done = _write(fd, data, (unsigned)size);
+#endif // _WIN32
+
+        if ((done < 0) && (errno == EINTR)) continue;
+        if (done <= 0) return TREE_WRITE_FAILED;
+
+        data += done;
+        size -= done;
+    }
+
+    return TREE_OK;
+}
+
+//------------------------------------------------------------------------------
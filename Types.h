@@ -77,13 +77,8 @@ template<typename TYPE> const char* const PRINT_FORMAT;
 template <typename TYPE>
 bool isPOISON (TYPE value)
 {
-    if (value == POISON<TYPE>) return 1;
-
-    if (isnan(*(double*)&POISON<TYPE>))
-        if (isnan(*(double*)&value))
-            return 1;
-        else
-            return 0;
+    if constexpr (std::is_floating_point<TYPE>::value)
+        return isnan(value);
 
     else return (value == POISON<TYPE>);
 }
@@ -44,6 +44,7 @@ int main(int argc, char* argv[])
 
     newTree_root(newtr, newnd, int);
     newtr.Dump();
+    newtr.Render();
 
     return 0;
 }
\ No newline at end of file
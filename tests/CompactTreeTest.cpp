@@ -0,0 +1,273 @@
+/*------------------------------------------------------------------------------
+    * File:        CompactTreeTest.cpp                                         *
+    * Description: Tests of the compact tree: it is written the same as the    *
+                   linked tree it was made from, turns back into the same      *
+                   tree and finds the same paths to the leaves.                *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+#include "../TreeLib/CompactTree.h"
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+char const * const BASE_NAME = ".bin/CompactTreeTest.dat";
+char const * const REF_NAME  = ".bin/CompactTreeTest.ref";
+char const * const OUT_NAME  = ".bin/CompactTreeTest.out";
+
+const size_t TEST_LEAVES = 1000;
+
+//------------------------------------------------------------------------------
+/*! @brief   Read the whole file.
+ *
+ *  @param   filename    File name
+ *
+ *  @return  contents of the file
+ */
+
+static std::string ReadFile (const char* filename)
+{
+    std::string text;
+
+    FILE* fp = fopen(filename, "rb");
+    if (fp == nullptr) return text;
+
+    char buf[4096] = {};
+    for (size_t size = 0; (size = fread(buf, 1, sizeof(buf), fp)) > 0;) text.append(buf, size);
+
+    fclose(fp);
+
+    return text;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Make the data of a node.
+ *
+ *  @param   i           Number of the node
+ *  @param   buf         Buffer for strings
+ *
+ *  @return  data
+ */
+
+template <typename TYPE>
+static TYPE MakeData (size_t i, char* buf)
+{
+    if constexpr (std::is_same<TYPE, char*>::value)
+    {
+        sprintf(buf, "node %zu", i);
+        return buf;
+    }
+    else return (TYPE)i;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Build a tree of TEST_LEAVES leaves numbered from 0, splitting
+ *           the leaves to both sides so the tree is not balanced.
+ *
+ *  @param   tree        Tree with the root only
+ *  @param   leaves      Data of the leaves
+ */
+
+template <typename TYPE>
+static void BuildTree (Tree<TYPE>& tree, std::vector<TYPE>& leaves)
+{
+    char buf[64] = "";
+
+    tree.setData(tree.root_, MakeData<TYPE>(0, buf));
+
+    std::vector<Node<TYPE>*> nodes = { tree.root_ };
+
+    for (size_t i = 1; i < TEST_LEAVES; ++i)
+    {
+        size_t k = (i * 7919) % nodes.size();
+
+        Node<TYPE>* leaf  = nodes[k];
+        Node<TYPE>* added = tree.splitLeaf(leaf, MakeData<TYPE>(TEST_LEAVES + i, buf), MakeData<TYPE>(i, buf + 32), i % 2);
+
+        nodes[k] = (added == leaf->right_) ? leaf->left_ : leaf->right_;
+        nodes.push_back(added);
+    }
+
+    leaves.clear();
+
+    NodeWalk<TYPE> walk(tree.root_);
+    for (Node<TYPE>* node = walk.Next(); node != nullptr; node = walk.Next())
+        if ((node->left_ == nullptr) && (node->right_ == nullptr)) leaves.push_back(node->getData());
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   The compact tree and the tree made back from it have to be written
+ *           the same as the linked tree.
+ *
+ *  @param   tree        Linked tree
+ *  @param   compact     Compact tree made from it
+ *
+ *  @return  0 if ok, else 1
+ */
+
+template <typename TYPE>
+static int CompareWrite (Tree<TYPE>& tree, CompactTree<TYPE>& compact)
+{
+    for (bool short_form : { false, true })
+    {
+        tree.Write(REF_NAME, short_form);
+        std::string ref = ReadFile(REF_NAME);
+
+        compact.Write(OUT_NAME, short_form);
+        if (ReadFile(OUT_NAME) != ref)
+        {
+            printf("write: the compact tree is written differently\n");
+            return 1;
+        }
+
+        Tree<TYPE> back((char*)"back");
+        compact.toTree(back);
+
+        if (back.Check())
+        {
+            printf("write: check of the tree made back failed with error %d\n", back.getErrCode());
+            return 1;
+        }
+
+        back.Write(OUT_NAME, short_form);
+        if (ReadFile(OUT_NAME) != ref)
+        {
+            printf("write: the tree made back is written differently\n");
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Every leaf has to be found by a path going from the root down to
+ *           it with the same length as in the linked tree.
+ *
+ *  @param   tree        Linked tree
+ *  @param   compact     Compact tree made from it
+ *  @param   leaves      Data of the leaves
+ *
+ *  @return  0 if ok, else 1
+ */
+
+template <typename TYPE>
+static int CompareFind (Tree<TYPE>& tree, CompactTree<TYPE>& compact, const std::vector<TYPE>& leaves)
+{
+    for (const TYPE& leaf : leaves)
+    {
+        PathStack<size_t> path((char*)"path");
+        PathStack<size_t> linked_path((char*)"linked_path");
+
+        if ((not compact.findPath(path, leaf)) || (not tree.findPath(linked_path, leaf)))
+        {
+            printf("find: a leaf is not found\n");
+            return 1;
+        }
+
+        if ((path.getSize() != linked_path.getSize()) || (path[0] != 0))
+        {
+            printf("find: path of %zu nodes, expected %zu from the root\n", path.getSize(), linked_path.getSize());
+            return 1;
+        }
+
+        for (size_t i = 1; i < path.getSize(); ++i)
+        {
+            const CompactNode<TYPE>& node   = compact[(link_t)path[i]];
+            const CompactNode<TYPE>& parent = compact[(link_t)path[i - 1]];
+
+            if ((node.prev_ != path[i - 1]) || (node.depth_ != i) ||
+                ((parent.left_ != path[i]) && (parent.right_ != path[i])))
+            {
+                printf("find: the path is broken at depth %zu\n", i);
+                return 1;
+            }
+        }
+
+        Node<TYPE>* linked = (Node<TYPE>*)linked_path[linked_path.getSize() - 1];
+        const CompactNode<TYPE>& found = compact[(link_t)path[path.getSize() - 1]];
+
+        bool same = false;
+        if constexpr (std::is_same<TYPE, char*>::value)
+            same = (strcmp(found.data_, linked->getData()) == 0);
+        else
+            same = (found.data_ == linked->getData());
+
+        if (not same)
+        {
+            printf("find: the path leads to another leaf\n");
+            return 1;
+        }
+    }
+
+    char buf[64] = "";
+
+    PathStack<size_t> path((char*)"path");
+    if (compact.findPath(path, MakeData<TYPE>(TEST_LEAVES + 1, buf)) || compact.findPath(path, MakeData<TYPE>(3 * TEST_LEAVES, buf)))
+    {
+        printf("find: a question or a missing element is found\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Make the compact tree from a built tree and from the same tree
+ *           loaded from its base, compare them with the linked tree.
+ *
+ *  @return  0 if ok, else 1
+ */
+
+template <typename TYPE>
+static int CompareAll ()
+{
+    std::vector<TYPE> leaves;
+
+    Tree<TYPE> tree((char*)"tree");
+    tree.root_ = tree.newNode();
+    BuildTree(tree, leaves);
+
+    CompactTree<TYPE> compact((char*)"compact", tree);
+
+    if (compact.getSize() != 2 * TEST_LEAVES - 1)
+    {
+        printf("compact: %zu nodes, expected %zu\n", compact.getSize(), 2 * TEST_LEAVES - 1);
+        return 1;
+    }
+
+    if (CompareWrite(tree, compact) || CompareFind(tree, compact, leaves)) return 1;
+
+    if constexpr (std::is_same<TYPE, char*>::value)
+    {
+        tree.Write(BASE_NAME);
+
+        Tree<TYPE> loaded((char*)"loaded", (char*)BASE_NAME);
+        CompactTree<TYPE> from_base((char*)"from_base", loaded);
+
+        if (CompareWrite(loaded, from_base) || CompareFind(loaded, from_base, leaves)) return 1;
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int main ()
+{
+    int err = CompareAll<int>() || CompareAll<char*>();
+
+    remove(BASE_NAME);
+    remove(REF_NAME);
+    remove(OUT_NAME);
+
+    if (err) return 1;
+
+    printf("compact tree ok\n");
+
+    return 0;
+}
@@ -0,0 +1,151 @@
+/*------------------------------------------------------------------------------
+    * File:        ConcurrentTreeBench.cpp                                     *
+    * Description: Scaling of lookups with the number of reader threads while  *
+                   one writer changes the tree, the concurrent tree against   *
+                   the linked tree under a reader-writer lock.                 *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+#include "../TreeLib/ConcurrentTree.h"
+#include <stdio.h>
+#include <chrono>
+#include <random>
+#include <shared_mutex>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+const int BENCH_LEAVES = 1024;
+
+//------------------------------------------------------------------------------
+/*! @brief   Build a tree with the leaves 0 .. BENCH_LEAVES - 1 and the leaf
+ *           changed by the writer.
+ *
+ *  @param   tree        Tree with the root only
+ */
+
+static void BuildTree (Tree<int>& tree)
+{
+    tree.setData(tree.root_, 0);
+
+    std::vector<Node<int>*> leaves = { tree.root_ };
+
+    size_t head = 0;
+    for (int data = 1; data < BENCH_LEAVES; ++data, ++head)
+    {
+        Node<int>* leaf = leaves[head];
+
+        leaves.push_back(tree.splitLeaf(leaf, -data, data));
+        leaves.push_back(leaf->left_);
+    }
+
+    tree.splitLeaf(leaves[head], -BENCH_LEAVES, BENCH_LEAVES);
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Time of the lookups by several readers while the writer changes
+ *           one leaf again and again.
+ *
+ *  @param   readers     Number of reader threads
+ *  @param   lookups     Number of lookups
+ *  @param   concurrent  Read the concurrent tree, else the linked tree under
+ *                       a reader-writer lock
+ *
+ *  @return  time in milliseconds
+ */
+
+static double TimeLookups (size_t readers, size_t lookups, bool concurrent)
+{
+    Tree<int> linked((char*)"linked");
+    linked.root_ = linked.newNode();
+    BuildTree(linked);
+
+    ConcurrentTree<int> tree((char*)"tree", linked);
+
+    std::shared_mutex lock;
+    std::atomic<bool> stop(false);
+
+    std::thread writer([&linked, &tree, &lock, &stop, concurrent]
+    {
+        for (int data = BENCH_LEAVES; not stop.load(); ++data)
+        {
+            if (concurrent)
+            {
+                PathStack<size_t> path((char*)"path");
+                {
+                    ConcurrentTree<int>::Reader reader(tree);
+                    reader.findPath(path, data);
+                }
+
+                tree.setData(path, data + 1);
+                tree.Collect();
+            }
+            else
+            {
+                std::unique_lock<std::shared_mutex> guard(lock);
+
+                PathStack<size_t> path((char*)"path");
+                linked.findPath(path, data);
+                linked.setData((Node<int>*)path[path.getSize() - 1], data + 1);
+            }
+        }
+    });
+
+    Clock::time_point start = Clock::now();
+
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < readers; ++t)
+        workers.emplace_back([&linked, &tree, &lock, readers, lookups, concurrent, t]
+        {
+            std::mt19937 rng(t);
+
+            for (size_t i = t; i < lookups; i += readers)
+            {
+                PathStack<size_t> path((char*)"path");
+                int data = (int)(rng() % BENCH_LEAVES);
+
+                if (concurrent)
+                {
+                    ConcurrentTree<int>::Reader reader(tree);
+                    reader.findPath(path, data);
+                }
+                else
+                {
+                    std::shared_lock<std::shared_mutex> guard(lock);
+                    linked.findPath(path, data);
+                }
+            }
+        });
+
+    for (auto& worker : workers) worker.join();
+
+    double time = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    stop.store(true);
+    writer.join();
+
+    return time;
+}
+
+//------------------------------------------------------------------------------
+
+int main (int argc, char* argv[])
+{
+    size_t lookups = (argc > 1) ? (size_t)atol(argv[1]) : 20000;
+
+    printf("%zu lookups in %d leaves, %u hardware threads\n", lookups, BENCH_LEAVES, std::thread::hardware_concurrency());
+
+    for (size_t readers : { 1, 2, 4, 8 })
+    {
+        double locked = TimeLookups(readers, lookups, false);
+        double time   = TimeLookups(readers, lookups, true);
+
+        printf("%zu readers  rwlock %8.2f ms  concurrent %8.2f ms  x%.2f\n", readers, locked, time, locked / time);
+    }
+
+    return 0;
+}
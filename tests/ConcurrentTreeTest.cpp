@@ -0,0 +1,208 @@
+/*------------------------------------------------------------------------------
+    * File:        ConcurrentTreeTest.cpp                                      *
+    * Description: Stress test of readers walking and searching the tree      *
+                   while one writer changes it and frees the old versions.     *
+                   Build it with -fsanitize=thread (make tsan) to look for     *
+                   data races, with -fsanitize=address for freed nodes.        *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+#include "../TreeLib/ConcurrentTree.h"
+#include <stdio.h>
+#include <random>
+#include <string>
+#include <vector>
+
+const size_t TEST_READERS = 4;
+const size_t TEST_CHANGES = 5000;
+const size_t TEST_LEAVES  = 200;
+
+//------------------------------------------------------------------------------
+/*! @brief   Find path to the leaf with the data in the current version.
+ *
+ *  @param   tree        Tree
+ *  @param   path        Path to the leaf
+ *  @param   data        Data of the leaf
+ *
+ *  @return  1 if found, 0 if not
+ */
+
+static bool FindLeaf (ConcurrentTree<char*>& tree, PathStack<size_t>& path, const std::string& data)
+{
+    ConcurrentTree<char*>::Reader reader(tree);
+
+    return reader.findPath(path, (char*)data.c_str());
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Change the tree by all kinds of changes, the leaves are named by
+ *           the order they were made in, the anchor leaf is never changed.
+ *
+ *  @param   tree        Tree with the anchor leaf
+ *  @param   leaves      Data of the changeable leaves
+ *
+ *  @return  0 if ok, else 1
+ */
+
+static int Write (ConcurrentTree<char*>& tree, std::vector<std::string>& leaves)
+{
+    std::mt19937 rng(0);
+
+    char buf[64] = "";
+
+    for (size_t i = 0; i < TEST_CHANGES; ++i)
+    {
+        size_t k = rng() % leaves.size();
+
+        PathStack<size_t> path((char*)"path");
+        if (not FindLeaf(tree, path, leaves[k]))
+        {
+            printf("writer: leaf \"%s\" is not found\n", leaves[k].c_str());
+            return 1;
+        }
+
+        int err = TREE_OK;
+        size_t op = rng() % 5;
+
+        if (((op == 0) || (leaves.size() > TEST_LEAVES)) && (leaves.size() > 1))
+        {
+            err = tree.deleteNode(path);
+
+            leaves[k] = leaves.back();
+            leaves.pop_back();
+        }
+        else if (op == 1)
+        {
+            sprintf(buf, "leaf %zu", i);
+            err = tree.setData(path, buf);
+
+            leaves[k] = buf;
+        }
+        else if (op == 2)
+        {
+            sprintf(buf, "leaf %zu", i);
+            err = (rng() % 2) ? tree.addRight(path, buf) : tree.addLeft(path, buf);
+
+            leaves[k] = buf;
+        }
+        else
+        {
+            sprintf(buf, "leaf %zu", i);
+            err = tree.splitLeaf(path, (char*)"question", buf, rng() % 2);
+
+            leaves.push_back(buf);
+        }
+
+        if (err)
+        {
+            printf("writer: change %zu failed with error %d\n", i, err);
+            return 1;
+        }
+
+        if (i % 64 == 0) tree.Collect();
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Walk and search the versions until the writer stops, every
+ *           version has to keep all its strings and the anchor leaf.
+ *
+ *  @param   tree        Tree
+ *  @param   stop        Writer stopped
+ *
+ *  @return  0 if ok, else 1
+ */
+
+static int Read (ConcurrentTree<char*>& tree, std::atomic<bool>& stop)
+{
+    while (not stop.load())
+    {
+        ConcurrentTree<char*>::Reader reader(tree);
+
+        bool bad = false;
+
+        reader.Walk([&bad] (const SharedNode<char*>* node, size_t)
+        {
+            const char* data = node->data_;
+
+            if ((data == nullptr) || ((strncmp(data, "leaf ", 5) != 0) && (strcmp(data, "question") != 0) &&
+                                      (strcmp(data, "anchor") != 0)    && (strcmp(data, "root")     != 0)))
+                bad = true;
+        });
+
+        if (bad)
+        {
+            printf("reader: a node has wrong data\n");
+            return 1;
+        }
+
+        PathStack<size_t> path((char*)"path");
+        if (not reader.findPath(path, (char*)"anchor"))
+        {
+            printf("reader: the anchor leaf is not found\n");
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int main ()
+{
+    ConcurrentTree<char*> tree((char*)"tree");
+
+    PathStack<size_t> path((char*)"path");
+    tree.addRight(path, (char*)"root");
+
+    FindLeaf(tree, path, "root");
+    tree.splitLeaf(path, (char*)"question", (char*)"anchor");
+
+    std::vector<std::string> leaves = { "root" };
+
+    std::atomic<bool> stop(false);
+    std::atomic<int>  errors(0);
+
+    std::vector<std::thread> readers;
+    for (size_t t = 0; t < TEST_READERS; ++t)
+        readers.emplace_back([&tree, &stop, &errors] { errors += Read(tree, stop); });
+
+    int err = Write(tree, leaves);
+
+    stop.store(true);
+    for (auto& reader : readers) reader.join();
+
+    if (err || errors.load()) return 1;
+
+    size_t nodes = 0;
+    {
+        ConcurrentTree<char*>::Reader reader(tree);
+        reader.Walk([&nodes] (const SharedNode<char*>*, size_t) { ++nodes; });
+    }
+
+    if (nodes != tree.getSize())
+    {
+        printf("tree: %zu nodes, size is %zu\n", nodes, tree.getSize());
+        return 1;
+    }
+
+    Tree<char*> linked((char*)"linked");
+    tree.toTree(linked);
+
+    if (linked.Check())
+    {
+        printf("tree: check failed with error %d\n", linked.getErrCode());
+        return 1;
+    }
+
+    printf("readers with one writer ok\n");
+
+    return 0;
+}
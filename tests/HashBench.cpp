@@ -0,0 +1,84 @@
+/*------------------------------------------------------------------------------
+    * File:        HashBench.cpp                                               *
+    * Description: Speed of the hash function on keys and blocks of different  *
+                   sizes, SSE2 and scalar paths.                               *
+    * Created:     1 dec 2020                                                  *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+#include "../StackLib/hash.h"
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+// The same source built without SSE2, linked with the usual hash.cpp.
+#define HASH_NO_SIMD
+#define hash       hash_scalar
+#define hash_at    hash_at_scalar
+#define bit_rotate bit_rotate_scalar
+#include "../StackLib/hash.cpp"
+#undef  hash
+#undef  hash_at
+#undef  bit_rotate
+
+typedef std::chrono::steady_clock Clock;
+
+const size_t BENCH_BYTES = 1 << 28;
+const int    BENCH_RUNS  = 3;
+
+//------------------------------------------------------------------------------
+/*! @brief   Best time of hashing BENCH_BYTES bytes by blocks of the size over
+ *           BENCH_RUNS runs.
+ *
+ *  @param   func        Hash function
+ *  @param   buf         Data, at least 2 * size bytes
+ *  @param   size        Size of a block
+ *
+ *  @return  time of one hash in nanoseconds
+ */
+
+static double TimeHash (hash_t (*func) (const void*, size_t), const unsigned char* buf, size_t size)
+{
+    size_t calls = std::max(BENCH_BYTES / std::max(size, (size_t)32), (size_t)1);
+    double best  = 1e300;
+
+    hash_t sum = 0;
+
+    for (int run = 0; run < BENCH_RUNS; ++run)
+    {
+        Clock::time_point start = Clock::now();
+
+        for (size_t i = 0; i < calls; ++i) sum += func(buf + (i + sum) % size, size);
+
+        double time = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / calls;
+        if (time < best) best = time;
+    }
+
+    if (sum == 1) printf(" ");
+
+    return best;
+}
+
+//------------------------------------------------------------------------------
+
+int main ()
+{
+    std::vector<unsigned char> buf(2 << 20);
+    for (size_t i = 0; i < buf.size(); ++i) buf[i] = (unsigned char)(i * 0x9E3779B1u >> 13);
+
+    printf("   bytes       SSE2 ns   GB/s     scalar ns   GB/s\n");
+
+    for (size_t size : { 4, 8, 16, 32, 64, 65, 256, 1024, 4096, 65536, 1 << 20 })
+    {
+        double fast = TimeHash(hash,        buf.data(), size);
+        double slow = TimeHash(hash_scalar, buf.data(), size);
+
+        printf("%8zu  %12.1f %6.2f  %12.1f %6.2f\n", size, fast, size / fast, slow, size / slow);
+    }
+
+    return 0;
+}
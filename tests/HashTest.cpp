@@ -0,0 +1,179 @@
+/*------------------------------------------------------------------------------
+    * File:        HashTest.cpp                                                *
+    * Description: Tests of the hash function: the SSE2 and the scalar paths   *
+                   give the same hash, every input bit changes every output    *
+                   bit with probability 1/2, keys spread evenly over buckets.  *
+    * Created:     1 dec 2020                                                  *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+#include "../StackLib/hash.h"
+#include <math.h>
+#include <stdint.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+// The same source built without SSE2, linked with the usual hash.cpp.
+#define HASH_NO_SIMD
+#define hash       hash_scalar
+#define hash_at    hash_at_scalar
+#define bit_rotate bit_rotate_scalar
+#include "../StackLib/hash.cpp"
+#undef  hash
+#undef  hash_at
+#undef  bit_rotate
+
+const size_t AVALANCHE_FLIPS    = 40000;
+const size_t BUCKETS_BITS       = 16;
+const size_t BUCKETS_KEYS       = 1 << 20;
+
+//------------------------------------------------------------------------------
+/*! @brief   Compare hashes of the SSE2 and the scalar paths on random data of
+ *           all sizes up to 5000 bytes at all alignments and some big sizes.
+ *
+ *  @return  0 if ok, else 1
+ */
+
+static int TestScalar ()
+{
+    std::mt19937_64 rng(1);
+
+    std::vector<unsigned char> buf(70000);
+    for (auto& byte : buf) byte = (unsigned char)rng();
+
+    for (size_t size = 0; size < 70000 - 8; size = (size < 5000) ? size + 1 : size + 997)
+        for (size_t shift = 0; shift < ((size < 5000) ? 8 : 1); ++shift)
+            if (hash(buf.data() + shift, size) != hash_scalar(buf.data() + shift, size))
+            {
+                printf("scalar: hashes of %zu bytes at offset %zu differ\n", size, shift);
+                return 1;
+            }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Flip every bit of random inputs (of all inputs up to 2 bytes) and
+ *           count how often every output bit changes, it has to be within 6
+ *           deviations of 1/2.
+ *
+ *  @param   size        Size of the input
+ *
+ *  @return  0 if ok, else 1
+ */
+
+static int TestAvalanche (size_t size)
+{
+    std::mt19937_64 rng(size);
+
+    std::vector<unsigned char> in(size);
+    std::vector<size_t> changed(64);
+
+    bool   every  = (size <= 2);
+    size_t inputs = (every) ? (size_t)1 << (size * 8) : std::max(AVALANCHE_FLIPS / (size * 8), (size_t)20);
+    size_t flips  = 0;
+
+    for (size_t input = 0; input < inputs; ++input)
+    {
+        if (every) memcpy(in.data(), &input, size);
+        else       for (auto& byte : in) byte = (unsigned char)rng();
+
+        hash_t first = hash(in.data(), size);
+
+        for (size_t bit = 0; bit < size * 8; ++bit)
+        {
+            in[bit / 8] ^= (unsigned char)(1 << (bit % 8));
+            hash_t diff = first ^ hash(in.data(), size);
+            in[bit / 8] ^= (unsigned char)(1 << (bit % 8));
+
+            for (size_t out = 0; out < 64; ++out) changed[out] += (diff >> out) & 1;
+            ++flips;
+        }
+    }
+
+    double worst = 0;
+    for (size_t out = 0; out < 64; ++out)
+        worst = std::max(worst, fabs((double)changed[out] / flips - 0.5));
+
+    // Flips of all inputs meet every pair of inputs twice.
+    double limit = 6 * 0.5 / sqrt((every) ? flips / 2.0 : (double)flips);
+
+    printf("avalanche %5zu bytes: worst bias %.4f over %zu flips, limit %.4f\n", size, worst, flips, limit);
+
+    return (worst > limit);
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Chi-square of the keys over the buckets by the low and by the
+ *           high bits of the hash, it has to be within 6 deviations of the
+ *           expected value.
+ *
+ *  @param   name        Name of the key set
+ *  @param   key         Function writing the key i to the buffer and
+ *                       returning its size
+ *
+ *  @return  0 if ok, else 1
+ */
+
+template <typename KEY>
+static int TestBuckets (const char* name, KEY key)
+{
+    size_t buckets = (size_t)1 << BUCKETS_BITS;
+
+    std::vector<size_t> low (buckets);
+    std::vector<size_t> high(buckets);
+
+    unsigned char buf[64] = {};
+
+    for (size_t i = 0; i < BUCKETS_KEYS; ++i)
+    {
+        hash_t hsh = hash(buf, key(i, buf));
+
+        ++low [hsh & (buckets - 1)];
+        ++high[hsh >> (64 - BUCKETS_BITS)];
+    }
+
+    double expect = (double)BUCKETS_KEYS / buckets;
+    double limit  = 6 * sqrt(2.0 * (buckets - 1));
+
+    int err = 0;
+
+    for (std::vector<size_t>* count : { &low, &high })
+    {
+        double chi2 = 0;
+        for (size_t bucket = 0; bucket < buckets; ++bucket)
+            chi2 += ((*count)[bucket] - expect) * ((*count)[bucket] - expect) / expect;
+
+        printf("buckets %-8s %4s bits: chi2 %.0f, expected %zu +- %.0f\n", name, (count == &low) ? "low" : "high", chi2, buckets - 1, limit);
+
+        if (fabs(chi2 - (buckets - 1)) > limit) err = 1;
+    }
+
+    return err;
+}
+
+//------------------------------------------------------------------------------
+
+int main ()
+{
+    if (TestScalar()) return 1;
+
+    printf("scalar ok\n");
+
+    for (size_t size : { 1, 2, 3, 4, 8, 13, 16, 36, 64, 65, 200, 4096 })
+        if (TestAvalanche(size)) return 1;
+
+    auto text = [](size_t i, unsigned char* buf) { return (size_t)sprintf((char*)buf, "key%zu", i); };
+    auto word = [](size_t i, unsigned char* buf) { memcpy(buf, &i, sizeof(i)); return sizeof(i); };
+    auto wide = [](size_t i, unsigned char* buf) { memcpy(buf + 40, &i, sizeof(i)); return (size_t)64; };
+
+    if (TestBuckets("text", text) || TestBuckets("word", word) || TestBuckets("64 bytes", wide)) return 1;
+
+    printf("hash ok\n");
+
+    return 0;
+}
@@ -0,0 +1,145 @@
+/*------------------------------------------------------------------------------
+    * File:        LeafIndexBench.cpp                                          *
+    * Description: Time of findPath with and without the leaf index on trees   *
+                   of 1e3 to 1e7 nodes, and of changing leaves of equal data.  *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+#include "../TreeLib/Tree.h"
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+const size_t BENCH_LOOKUPS = 100000;
+const size_t BENCH_WALKS   = 1000000;
+const size_t BENCH_EQUAL   = 1000;
+
+//------------------------------------------------------------------------------
+/*! @brief   Build a tree of the number of nodes, its leaves are numbered from
+ *           0, the last leaves have equal data.
+ *
+ *  @param   tree        Tree with the root only
+ *  @param   nodes       Number of nodes, odd
+ *  @param   equal       Number of leaves with equal data
+ *  @param   leaves      Leaves of the tree
+ */
+
+static void BuildTree (Tree<int>& tree, size_t nodes, size_t equal, std::vector<Node<int>*>& leaves)
+{
+    tree.setData(tree.root_, 0);
+
+    leaves = { tree.root_ };
+    leaves.reserve(nodes / 2 + 1);
+
+    size_t head  = 0;
+    size_t count = (nodes - 1) / 2;
+
+    for (size_t i = 1; i <= count; ++i, ++head)
+    {
+        Node<int>* leaf = leaves[head];
+        int        data = (i + equal > count) ? (int)count : (int)i;
+
+        leaves.push_back(tree.splitLeaf(leaf, -(int)i, data));
+        leaves.push_back(leaf->left_);
+    }
+
+    leaves.erase(leaves.begin(), leaves.begin() + head);
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Time of one findPath to a random leaf.
+ *
+ *  @param   tree        Tree
+ *  @param   leaves      Leaves of the tree
+ *  @param   lookups     Number of lookups
+ *
+ *  @return  time in microseconds
+ */
+
+static double TimeLookups (Tree<int>& tree, const std::vector<Node<int>*>& leaves, size_t lookups)
+{
+    std::mt19937 rng(0);
+
+    size_t found = 0;
+
+    Clock::time_point start = Clock::now();
+
+    for (size_t i = 0; i < lookups; ++i)
+    {
+        PathStack<size_t> path((char*)"path");
+        found += tree.findPath(path, leaves[rng() % leaves.size()]->getData());
+    }
+
+    double time = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+    if (found != lookups)
+    {
+        printf("%zu of %zu leaves are not found\n", lookups - found, lookups);
+        exit(1);
+    }
+
+    return time / lookups;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Time of changing the data of a leaf among the leaves of equal
+ *           data, the index has to drop the leaf from the chain of the data.
+ *
+ *  @param   tree        Tree with the index
+ *  @param   equal       Number of leaves with equal data
+ *  @param   leaves      Leaves of the tree
+ *
+ *  @return  time in microseconds
+ */
+
+static double TimeEqual (Tree<int>& tree, size_t equal, const std::vector<Node<int>*>& leaves)
+{
+    Clock::time_point start = Clock::now();
+
+    for (size_t i = leaves.size() - equal; i < leaves.size(); ++i)
+        tree.setData(leaves[i], -(int)leaves.size() - (int)i);
+
+    double time = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+    return time / equal;
+}
+
+//------------------------------------------------------------------------------
+
+int main (int argc, char* argv[])
+{
+    size_t max_nodes = (argc > 1) ? (size_t)atol(argv[1]) : 10000000;
+
+    printf("%-10s %14s %14s %14s %14s\n", "nodes", "walk, us", "index, us", "build, ms", "equal, us");
+
+    for (size_t nodes = 1000; nodes <= max_nodes; nodes *= 10)
+    {
+        std::vector<Node<int>*> leaves;
+        size_t equal = std::min(BENCH_EQUAL, nodes / 4);
+
+        Tree<int> tree((char*)"tree");
+        tree.root_ = tree.newNode();
+        BuildTree(tree, nodes + 1, equal, leaves);
+
+        double walk = TimeLookups(tree, leaves, std::max<size_t>(BENCH_WALKS / nodes, 3));
+
+        Clock::time_point start = Clock::now();
+        tree.buildIndex();
+        double build = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        double index = TimeLookups(tree, leaves, BENCH_LOOKUPS);
+        double change = TimeEqual(tree, equal, leaves);
+
+        printf("%-10zu %14.3f %14.3f %14.2f %14.3f\n", nodes, walk, index, build, change);
+    }
+
+    return 0;
+}
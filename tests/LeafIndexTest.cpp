@@ -0,0 +1,136 @@
+/*------------------------------------------------------------------------------
+    * File:        LeafIndexTest.cpp                                           *
+    * Description: Test of the leaf index on a tree with many leaves of equal  *
+                   data: after every change findPath has to find a leaf for    *
+                   all data of the leaves and only for them.                   *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+#include "../TreeLib/Tree.h"
+#include <stdio.h>
+#include <map>
+#include <random>
+#include <vector>
+
+const size_t TEST_LEAVES  = 1000;
+const size_t TEST_CHANGES = 2000;
+const int    TEST_VALUES  = 40;
+
+//------------------------------------------------------------------------------
+/*! @brief   Every data of the tree has to be found by the index if a leaf has
+ *           it, the found node has to be a leaf with the data on its path.
+ *
+ *  @param   tree        Tree with the index
+ *  @param   leaves      Leaves of the tree
+ *
+ *  @return  0 if ok, else 1
+ */
+
+static int CheckIndex (Tree<int>& tree, std::vector<Node<int>*>& leaves)
+{
+    std::map<int, bool> data;
+    leaves.clear();
+
+    NodeWalk<int> walk(tree.root_);
+    for (Node<int>* node = walk.Next(); node != nullptr; node = walk.Next())
+    {
+        bool leaf = (node->left_ == nullptr) && (node->right_ == nullptr);
+
+        data[node->getData()] |= leaf;
+        if (leaf) leaves.push_back(node);
+    }
+
+    for (const auto& [value, leaf] : data)
+    {
+        PathStack<size_t> path((char*)"path");
+
+        if (tree.findPath(path, value) != leaf)
+        {
+            printf("index: data %d %s\n", value, (leaf) ? "of a leaf is not found" : "of no leaf is found");
+            return 1;
+        }
+
+        if (not leaf) continue;
+
+        Node<int>* node = (Node<int>*)path[path.getSize() - 1];
+
+        if ((node->left_ != nullptr) || (node->right_ != nullptr) || (node->getData() != value) ||
+            ((Node<int>*)path[0] != tree.root_))
+        {
+            printf("index: data %d leads to a wrong node\n", value);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int main ()
+{
+    Tree<int> tree((char*)"tree");
+    tree.root_ = tree.newNode();
+    tree.setData(tree.root_, 0);
+
+    tree.buildIndex();
+
+    std::mt19937 rng(0);
+
+    int question = -1;
+
+    std::vector<Node<int>*> leaves = { tree.root_ };
+    while (leaves.size() < TEST_LEAVES)
+    {
+        size_t k = rng() % leaves.size();
+
+        Node<int>* leaf  = leaves[k];
+        Node<int>* added = tree.splitLeaf(leaf, question--, (int)(rng() % TEST_VALUES), rng() % 2);
+
+        leaves[k] = (added == leaf->right_) ? leaf->left_ : leaf->right_;
+        leaves.push_back(added);
+    }
+
+    if (CheckIndex(tree, leaves)) return 1;
+
+    for (size_t i = 0; i < TEST_CHANGES; ++i)
+    {
+        Node<int>* leaf  = leaves[rng() % leaves.size()];
+        int        value = (int)(rng() % TEST_VALUES);
+
+        switch (rng() % 4)
+        {
+        case 0:
+            if (leaf != tree.root_) tree.deleteNode(leaf);
+            break;
+
+        case 1:
+            tree.setData(leaf, value);
+            break;
+
+        case 2:
+            tree.setData(leaf, question--);
+            tree.addRight(leaf, value);
+            break;
+
+        default:
+            tree.splitLeaf(leaf, question--, value, rng() % 2);
+        }
+
+        if (CheckIndex(tree, leaves)) return 1;
+    }
+
+    if (tree.Check())
+    {
+        printf("index: check failed with error %d\n", tree.getErrCode());
+        return 1;
+    }
+
+    printf("leaf index with equal leaves ok\n");
+
+    return 0;
+}
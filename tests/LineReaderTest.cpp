@@ -0,0 +1,257 @@
+/*------------------------------------------------------------------------------
+    * File:        LineReaderTest.cpp                                          *
+    * Description: Test of the line reader: lines ending at and crossing the   *
+                   chunk boundaries, lines and runs of spaces longer than a    *
+                   chunk, read from a file, a stream, a descriptor and a pipe  *
+                   filled by random pieces.                                    *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+#include "../StringLib/StringLib.h"
+#include <ctype.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+char const * const TEXT_NAME = ".bin/LineReaderTest.txt";
+
+const size_t TEST_SHORT_LINES = 20000;
+
+//------------------------------------------------------------------------------
+/*! @brief   Split the text to lines the simple way: spaces at the start of a
+ *           line are skipped, the part after the last newline is a line too.
+ *
+ *  @param   text        Text
+ *
+ *  @return  lines
+ */
+
+static std::vector<std::string> Split (const std::string& text)
+{
+    std::vector<std::string> lines;
+
+    size_t start = 0;
+    while (true)
+    {
+        while ((start < text.size()) && isspace(text[start]) && (text[start] != '\n')) ++start;
+
+        size_t nl = text.find('\n', start);
+        if (nl == std::string::npos)
+        {
+            lines.push_back(text.substr(start));
+            break;
+        }
+
+        lines.push_back(text.substr(start, nl - start));
+        start = nl + 1;
+    }
+
+    return lines;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Add a line of random letters.
+ *
+ *  @param   text        Text
+ *  @param   rng         Random numbers
+ *  @param   len         Length of the line without the newline
+ */
+
+static void AddLine (std::string& text, std::mt19937& rng, size_t len)
+{
+    for (size_t i = 0; i < len; ++i) text += (char)('a' + rng() % 26);
+    text += '\n';
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Make the texts of the test.
+ *
+ *  @param   rng         Random numbers
+ *
+ *  @return  texts
+ */
+
+static std::vector<std::string> MakeTexts (std::mt19937& rng)
+{
+    std::vector<std::string> texts;
+
+    std::string text;
+    for (size_t chunk = 1; chunk <= 4; ++chunk)
+    for (size_t end = chunk * LINE_READER_CHUNK - 3; end <= chunk * LINE_READER_CHUNK + 3; ++end)
+        AddLine(text, rng, end - text.size());
+
+    texts.push_back(text);
+
+    text.clear();
+    for (size_t i = 0; i < TEST_SHORT_LINES; ++i)
+    {
+        text.append(rng() % 8, (rng() % 2) ? ' ' : '\t');
+        AddLine(text, rng, rng() % 200);
+
+        if (rng() % 16 == 0) text.insert(text.size() - 1, "\r");
+    }
+
+    texts.push_back(text);
+
+    text.clear();
+    for (size_t len : { LINE_READER_CHUNK, 5 * LINE_READER_CHUNK / 2, (size_t)1, 3 * LINE_READER_CHUNK })
+    {
+        AddLine(text, rng, len);
+        text.append(2 * LINE_READER_CHUNK + 1, ' ');
+        AddLine(text, rng, 10);
+    }
+
+    text.append(3 * LINE_READER_CHUNK / 2, ' ');
+    texts.push_back(text);
+
+    for (const char* small : { "\n", "x", "   x", "x\n", "\n\n\n  \n" })
+        texts.push_back(small);
+
+    return texts;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   The reader has to give the same lines as the simple split, the
+ *           last LINE_READER_HISTORY lines have to stay the same after the
+ *           following ones are read.
+ *
+ *  @param   reader      Reader of the text
+ *  @param   expect      Lines of the text
+ *  @param   how         Name of the way the text is read
+ *
+ *  @return  0 if ok, else 1
+ */
+
+static int Compare (LineReader& reader, const std::vector<std::string>& expect, const char* how)
+{
+    for (size_t n = 0; n < expect.size(); ++n)
+    {
+        for (size_t back = 0; (back < LINE_READER_HISTORY) && (back <= n); ++back)
+        {
+            Line line = reader.getLine(n - back);
+
+            if ((line.str == nullptr) || (line.len != expect[n - back].size()) ||
+                (memcmp(line.str, expect[n - back].data(), line.len) != 0) || (line.str[line.len] != '\0'))
+            {
+                printf("%s: line %zu of %zu (%zu bytes) differs after line %zu is read\n",
+                       how, n - back, expect.size(), expect[n - back].size(), n);
+                return 1;
+            }
+        }
+
+        if ((n >= LINE_READER_HISTORY) && (reader.getLine(n - LINE_READER_HISTORY).str != nullptr))
+        {
+            printf("%s: line %zu is given after %zu lines more are read\n", how, n - LINE_READER_HISTORY, LINE_READER_HISTORY);
+            return 1;
+        }
+    }
+
+    if ((reader.getLine(expect.size()).str != nullptr) || (reader.getLinesNum() != expect.size()))
+    {
+        printf("%s: %zu lines, expected %zu\n", how, reader.getLinesNum(), expect.size());
+        return 1;
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Read the text in all ways.
+ *
+ *  @param   text        Text
+ *  @param   rng         Random numbers
+ *
+ *  @return  0 if ok, else 1
+ */
+
+static int ReadAll (const std::string& text, std::mt19937& rng)
+{
+    std::vector<std::string> expect = Split(text);
+
+    FILE* fp = fopen(TEXT_NAME, "wb");
+    fwrite(text.data(), 1, text.size(), fp);
+    fclose(fp);
+
+    {
+        LineReader reader(TEXT_NAME);
+        if (Compare(reader, expect, "file name")) return 1;
+    }
+
+    fp = fopen(TEXT_NAME, "r");
+    {
+        LineReader reader(fp);
+        if (Compare(reader, expect, "file")) return 1;
+    }
+    fclose(fp);
+
+    int fd = open(TEXT_NAME, O_RDONLY);
+    {
+        LineReader reader(fd);
+        if (Compare(reader, expect, "descriptor")) return 1;
+    }
+    close(fd);
+
+    int fds[2] = {};
+    if (pipe(fds) != 0) return 1;
+
+    unsigned seed = rng();
+
+    std::thread writer([&text, fds, seed]
+    {
+        std::mt19937 pieces(seed);
+
+        for (size_t pos = 0; pos < text.size();)
+        {
+            size_t size = 1 + pieces() % ((pieces() % 2) ? 16 : 2 * LINE_READER_CHUNK);
+            if (size > text.size() - pos) size = text.size() - pos;
+
+            ssize_t put = write(fds[1], text.data() + pos, size);
+            if (put <= 0) break;
+
+            pos += put;
+        }
+
+        close(fds[1]);
+    });
+
+    int err = 0;
+    {
+        LineReader reader(fds[0]);
+        err = Compare(reader, expect, "pipe");
+
+        if (err) reader.getLinesNum();
+    }
+
+    writer.join();
+    close(fds[0]);
+
+    return err;
+}
+
+//------------------------------------------------------------------------------
+
+int main ()
+{
+    std::mt19937 rng(0);
+
+    int err = 0;
+    for (const std::string& text : MakeTexts(rng))
+        if ((err = ReadAll(text, rng)) != 0) break;
+
+    remove(TEXT_NAME);
+
+    if (err) return 1;
+
+    printf("line reader ok\n");
+
+    return 0;
+}
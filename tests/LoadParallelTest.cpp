@@ -0,0 +1,236 @@
+/*------------------------------------------------------------------------------
+    * File:        LoadParallelTest.cpp                                        *
+    * Description: Tests of the parallel load of text bases: the text split to *
+                   lines and the tree loaded by 1 to 8 threads have to be the  *
+                   same as by one thread.                                      *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+#include "../TreeLib/Tree.h"
+#include <stdio.h>
+#include <random>
+#include <string>
+#include <vector>
+
+char const * const BASE_NAME = ".bin/LoadParallelTest.dat";
+char const * const REF_NAME  = ".bin/LoadParallelTest.ref";
+char const * const OUT_NAME  = ".bin/LoadParallelTest.out";
+
+const size_t TEST_THREADS = 8;
+const size_t TEST_LEAVES  = 40000;
+
+//------------------------------------------------------------------------------
+/*! @brief   Read the whole file.
+ *
+ *  @param   filename    File name
+ *
+ *  @return  contents of the file
+ */
+
+static std::string ReadFile (const char* filename)
+{
+    std::string text;
+
+    FILE* fp = fopen(filename, "rb");
+    if (fp == nullptr) return text;
+
+    char buf[4096] = {};
+    for (size_t size = 0; (size = fread(buf, 1, sizeof(buf), fp)) > 0;) text.append(buf, size);
+
+    fclose(fp);
+
+    return text;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Lines of the text split by the threads have to be the same as
+ *           split by one thread.
+ *
+ *  @param   text        Text, longer than TEXT_PARALLEL_MIN_SIZE
+ *  @param   name        Name of the text
+ *
+ *  @return  0 if ok, else 1
+ */
+
+static int CompareSplit (const std::string& text, const char* name)
+{
+    std::string ref_text = text;
+
+    size_t ref_num = 0;
+    Line*  ref     = SplitLines(&ref_text[0], ref_text.size(), ref_num);
+
+    for (size_t threads = 1; threads <= TEST_THREADS; ++threads)
+    {
+        std::string split_text = text;
+
+        size_t num   = 0;
+        Line*  lines = SplitLines(&split_text[0], split_text.size(), num, threads);
+
+        bool same = (lines != nullptr) && (num == ref_num) && (split_text == ref_text);
+
+        for (size_t i = 0; same && (i < num + 2); ++i)
+        {
+            if ((lines[i].len != ref[i].len) || ((lines[i].str == nullptr) != (ref[i].str == nullptr)) ||
+                ((lines[i].str != nullptr) && (lines[i].str - &split_text[0] != ref[i].str - &ref_text[0])))
+                same = false;
+        }
+
+        free(lines);
+
+        if (not same)
+        {
+            printf("split: %s is split by %zu threads differently\n", name, threads);
+            free(ref);
+            return 1;
+        }
+    }
+
+    free(ref);
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Split texts with the lines cut by the threads in all places: lines
+ *           of random length, lines longer than the part of a thread, a text
+ *           without newlines and a text ending with a newline.
+ *
+ *  @return  0 if ok, else 1
+ */
+
+static int Split ()
+{
+    std::mt19937 rng(0);
+
+    std::string text;
+    while (text.size() <= TEXT_PARALLEL_MIN_SIZE)
+    {
+        text.append(rng() % 4, ' ');
+        text.append(rng() % 100, (char)('a' + rng() % 26));
+        text += '\n';
+    }
+
+    if (CompareSplit(text, "text ending with a newline")) return 1;
+
+    text.pop_back();
+    if (CompareSplit(text, "text of random lines")) return 1;
+
+    std::string longest(TEXT_PARALLEL_MIN_SIZE / 2, 'x');
+    if (CompareSplit(longest + '\n' + longest + "\n\n" + longest, "text of long lines")) return 1;
+
+    if (CompareSplit(std::string(TEXT_PARALLEL_MIN_SIZE + 1, 'x'), "text without newlines")) return 1;
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Make the data of a node.
+ *
+ *  @param   i           Number of the node
+ *  @param   buf         Buffer for strings
+ *
+ *  @return  data
+ */
+
+template <typename TYPE>
+static TYPE MakeData (size_t i, char* buf)
+{
+    if constexpr (std::is_same<TYPE, char*>::value)
+    {
+        sprintf(buf, "node %zu", i);
+        return buf;
+    }
+    else return (TYPE)i;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Build a tree of TEST_LEAVES leaves numbered from 0, splitting
+ *           the leaves in the order they were made, so the base is not
+ *           too deep for its indents.
+ *
+ *  @param   tree        Tree with the root only
+ */
+
+template <typename TYPE>
+static void BuildTree (Tree<TYPE>& tree)
+{
+    char buf[64] = "";
+
+    tree.setData(tree.root_, MakeData<TYPE>(0, buf));
+
+    std::vector<Node<TYPE>*> leaves = { tree.root_ };
+
+    for (size_t head = 0; leaves.size() - head < TEST_LEAVES; ++head)
+    {
+        Node<TYPE>* leaf  = leaves[head];
+        size_t      made  = leaves.size() - head;
+        Node<TYPE>* added = tree.splitLeaf(leaf, MakeData<TYPE>(TEST_LEAVES + head, buf), MakeData<TYPE>(made, buf + 32), head % 2);
+
+        leaves.push_back(added);
+        leaves.push_back((added == leaf->right_) ? leaf->left_ : leaf->right_);
+    }
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   The base loaded by 1 to TEST_THREADS threads has to be written the
+ *           same as the tree it was written from, in both forms of the base.
+ *
+ *  @return  0 if ok, else 1
+ */
+
+template <typename TYPE>
+static int Load ()
+{
+    Tree<TYPE> tree((char*)"tree");
+    tree.root_ = tree.newNode();
+    BuildTree(tree);
+
+    for (bool compact : { false, true })
+    {
+        tree.Write(BASE_NAME, compact);
+        tree.Write(REF_NAME);
+
+        std::string ref = ReadFile(REF_NAME);
+
+        for (size_t threads = 1; threads <= TEST_THREADS; ++threads)
+        {
+            Tree<TYPE> loaded((char*)"loaded", (char*)BASE_NAME, threads);
+
+            if (loaded.Check())
+            {
+                printf("load: check of the tree loaded by %zu threads failed with error %d\n", threads, loaded.getErrCode());
+                return 1;
+            }
+
+            loaded.Write(OUT_NAME);
+            if (ReadFile(OUT_NAME) != ref)
+            {
+                printf("load: the %s base loaded by %zu threads differs\n", (compact) ? "compact" : "indented", threads);
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int main ()
+{
+    int err = Split() || Load<int>() || Load<char*>();
+
+    remove(BASE_NAME);
+    remove(REF_NAME);
+    remove(OUT_NAME);
+
+    if (err) return 1;
+
+    printf("parallel load ok\n");
+
+    return 0;
+}
@@ -0,0 +1,303 @@
+/*------------------------------------------------------------------------------
+    * File:        NodeWalkTest.cpp                                            *
+    * Description: Tests of the iterative walks: pre-order, post-order and     *
+                   level-order give the nodes, depths and ancestors of the     *
+                   recursive walks, and the tree works on a chain of 1e7 nodes *
+                   deep without growing the native stack.                      *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+#include "../TreeLib/Tree.h"
+#include <stdio.h>
+#include <deque>
+#include <random>
+#include <vector>
+
+char const * const BASE_NAME = ".bin/NodeWalkTest.dat";
+
+const size_t TEST_NODES  = 2000;
+const size_t CHAIN_NODES = 10000000;
+
+struct Visit
+{
+    Node<int>* node;
+    size_t     depth;
+};
+
+//------------------------------------------------------------------------------
+/*! @brief   Recursive pre-order or post-order walk.
+ *
+ *  @param   node        Root of the subtree
+ *  @param   depth       Depth of the node
+ *  @param   post        Post-order
+ *  @param   right_first Visit right child before the left one
+ *  @param   skip        Node whose children are not visited (may be nullptr)
+ *  @param   visits      Visited nodes
+ */
+
+static void Recursive (Node<int>* node, size_t depth, bool post, bool right_first, Node<int>* skip, std::vector<Visit>& visits)
+{
+    if (node == nullptr) return;
+
+    if (not post) visits.push_back({ node, depth });
+
+    if (node != skip)
+    {
+        Recursive((right_first) ? node->right_ : node->left_,  depth + 1, post, right_first, skip, visits);
+        Recursive((right_first) ? node->left_  : node->right_, depth + 1, post, right_first, skip, visits);
+    }
+
+    if (post) visits.push_back({ node, depth });
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Level-order walk by a queue.
+ *
+ *  @param   root        Root of the subtree
+ *  @param   right_first Visit right child before the left one
+ *  @param   visits      Visited nodes
+ */
+
+static void Levels (Node<int>* root, bool right_first, std::vector<Visit>& visits)
+{
+    std::deque<Visit> queue = { { root, 0 } };
+
+    while (not queue.empty())
+    {
+        Visit visit = queue.front();
+        queue.pop_front();
+
+        visits.push_back(visit);
+
+        Node<int>* first  = (right_first) ? visit.node->right_ : visit.node->left_;
+        Node<int>* second = (right_first) ? visit.node->left_  : visit.node->right_;
+
+        if (first  != nullptr) queue.push_back({ first,  visit.depth + 1 });
+        if (second != nullptr) queue.push_back({ second, visit.depth + 1 });
+    }
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   The walk has to give the nodes of the reference walk with their
+ *           depths, and the ancestors of every node in pre- and post-order.
+ *
+ *  @param   root        Root of the subtree
+ *  @param   order       Walk order (WalkOrder)
+ *  @param   right_first Visit right child before the left one
+ *  @param   skip        Node whose children are skipped in pre-order (may be nullptr)
+ *
+ *  @return  0 if ok, else 1
+ */
+
+static int Compare (Node<int>* root, int order, bool right_first, Node<int>* skip)
+{
+    std::vector<Visit> expect;
+
+    if (order == WALK_LEVEL_ORDER) Levels(root, right_first, expect);
+    else Recursive(root, 0, (order == WALK_POST_ORDER), right_first, skip, expect);
+
+    NodeWalk<int> walk(root, order, right_first);
+
+    for (const Visit& visit : expect)
+    {
+        Node<int>* node = walk.Next();
+
+        if ((node != visit.node) || (walk.getDepth() != visit.depth))
+        {
+            printf("order %d: node %d at depth %zu, expected %d at depth %zu\n", order,
+                   (node == nullptr) ? -1 : node->getData(), walk.getDepth(), visit.node->getData(), visit.depth);
+            return 1;
+        }
+
+        if (node == skip) walk.Skip();
+
+        if (order == WALK_LEVEL_ORDER) continue;
+
+        Node<int>* ancestor = node->prev_;
+        for (size_t depth = visit.depth; depth-- > 0; ancestor = ancestor->prev_)
+        {
+            if (walk.getAncestor(depth) != ancestor)
+            {
+                printf("order %d: ancestor at depth %zu of node %d is wrong\n", order, depth, node->getData());
+                return 1;
+            }
+        }
+    }
+
+    if (walk.Next() != nullptr)
+    {
+        printf("order %d: more nodes than %zu\n", order, expect.size());
+        return 1;
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Walk a random tree with nodes of one and two children, and its
+ *           subtrees, in all orders.
+ *
+ *  @return  0 if ok, else 1
+ */
+
+static int Orders ()
+{
+    Tree<int> tree((char*)"tree");
+    tree.root_ = tree.newNode();
+    tree.setData(tree.root_, 0);
+
+    std::mt19937 rng(0);
+
+    std::vector<Node<int>*> nodes = { tree.root_ };
+    while (nodes.size() < TEST_NODES)
+    {
+        Node<int>* parent = nodes[rng() % nodes.size()];
+        int        data   = (int)nodes.size();
+
+        if      (parent->right_ == nullptr) nodes.push_back(tree.addRight(parent, data));
+        else if (parent->left_  == nullptr) nodes.push_back(tree.addLeft (parent, data));
+    }
+
+    for (int order : { WALK_PRE_ORDER, WALK_POST_ORDER, WALK_LEVEL_ORDER })
+    for (bool right_first : { true, false })
+    for (size_t i = 0; i < nodes.size(); i += 97)
+    {
+        if (Compare(nodes[i], order, right_first, nullptr)) return 1;
+    }
+
+    for (bool right_first : { true, false })
+    for (size_t i = 0; i < nodes.size(); i += 97)
+    {
+        if (Compare(tree.root_, WALK_PRE_ORDER, right_first, nodes[i])) return 1;
+    }
+
+    Node<int>* empty = nullptr;
+    for (int order : { WALK_PRE_ORDER, WALK_POST_ORDER, WALK_LEVEL_ORDER })
+    {
+        NodeWalk<int> walk(empty, order);
+        if (walk.Next() != nullptr)
+        {
+            printf("order %d: a node in an empty walk\n", order);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Walk the chain in all orders: every node is given once at its
+ *           depth, the deepest node knows all its ancestors.
+ *
+ *  @param   tree        Tree of one chain
+ *
+ *  @return  0 if ok, else 1
+ */
+
+static int WalkChain (Tree<int>& tree)
+{
+    for (int order : { WALK_PRE_ORDER, WALK_POST_ORDER, WALK_LEVEL_ORDER })
+    {
+        NodeWalk<int> walk(tree.root_, order);
+
+        size_t count = 0;
+        for (Node<int>* node = walk.Next(); node != nullptr; node = walk.Next(), ++count)
+        {
+            size_t depth = (order == WALK_POST_ORDER) ? CHAIN_NODES - 1 - count : count;
+
+            if ((node->getData() != (int)depth) || (walk.getDepth() != depth))
+            {
+                printf("chain: order %d gives node %d at depth %zu as node %zu\n", order, node->getData(), walk.getDepth(), count);
+                return 1;
+            }
+
+            if ((order != WALK_LEVEL_ORDER) && (depth == CHAIN_NODES - 1) &&
+                ((walk.getAncestor(0) != tree.root_) || (walk.getAncestor(depth - 1) != node->prev_) ||
+                 (walk.getAncestor(depth / 2)->getData() != (int)(depth / 2))))
+            {
+                printf("chain: order %d gives wrong ancestors of the deepest node\n", order);
+                return 1;
+            }
+        }
+
+        if (count != CHAIN_NODES)
+        {
+            printf("chain: order %d gives %zu nodes of %zu\n", order, count, CHAIN_NODES);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Walk, check, copy, write and load back a chain of CHAIN_NODES
+ *           nodes turning left and right, then release it. The recursive
+ *           code ran out of the native stack on it.
+ *
+ *  @return  0 if ok, else 1
+ */
+
+static int DeepChain ()
+{
+    Tree<int> tree((char*)"chain");
+    tree.root_ = tree.newNode();
+    tree.setData(tree.root_, 0);
+
+    Node<int>* node = tree.root_;
+    for (size_t i = 1; i < CHAIN_NODES; ++i)
+        node = (i % 3) ? tree.addRight(node, (int)i) : tree.addLeft(node, (int)i);
+
+    if (WalkChain(tree)) return 1;
+
+    if (tree.Check())
+    {
+        printf("chain: check failed with error %d\n", tree.getErrCode());
+        return 1;
+    }
+
+    {
+        Tree<int> copy(tree);
+
+        if (copy.Check() || WalkChain(copy))
+        {
+            printf("chain: the copy differs\n");
+            return 1;
+        }
+    }
+
+    tree.Write(BASE_NAME, true);
+
+    Tree<int> loaded((char*)"loaded", (char*)BASE_NAME);
+
+    if (loaded.Check() || WalkChain(loaded))
+    {
+        printf("chain: the loaded chain differs\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int main ()
+{
+    if (Orders()) return 1;
+
+    printf("walk orders ok\n");
+
+    int err = DeepChain();
+
+    remove(BASE_NAME);
+
+    if (err) return 1;
+
+    printf("deep chain ok\n");
+
+    return 0;
+}
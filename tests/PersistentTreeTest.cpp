@@ -0,0 +1,319 @@
+/*------------------------------------------------------------------------------
+    * File:        PersistentTreeTest.cpp                                      *
+    * Description: Tests of persistent tree snapshots: a change of one version *
+                   is not seen by the other, and the shared nodes are held    *
+                   and released by their counters. Build it with              *
+                   -fsanitize=address (make asan) to look for leaked and      *
+                   double freed nodes.                                         *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+#include "../TreeLib/PersistentTree.h"
+#include <stdio.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+const size_t TEST_LEAVES   = 64;
+const size_t TEST_VERSIONS = 256;
+const size_t TEST_THREADS  = 4;
+
+enum Change
+{
+    CHANGE_SET_DATA,
+    CHANGE_ADD_CHILD,
+    CHANGE_SPLIT_LEAF,
+    CHANGE_DELETE_NODE,
+    CHANGE_COUNT,
+};
+
+char const * const CHANGE_NAMES[] = { "setData", "addChild", "splitLeaf", "deleteNode" };
+
+//------------------------------------------------------------------------------
+/*! @brief   Make the data of a node.
+ *
+ *  @param   i           Number of the node
+ *  @param   buf         Buffer for strings
+ *
+ *  @return  data
+ */
+
+template <typename TYPE>
+static TYPE MakeData (size_t i, char* buf)
+{
+    if constexpr (std::is_same<TYPE, char*>::value)
+    {
+        sprintf(buf, "node %zu", i);
+        return buf;
+    }
+    else return (TYPE)i;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Build a linked tree of TEST_LEAVES leaves numbered from 0.
+ *
+ *  @param   tree        Tree with the root only
+ */
+
+template <typename TYPE>
+static void BuildTree (Tree<TYPE>& tree)
+{
+    char buf[64] = "";
+
+    tree.setData(tree.root_, MakeData<TYPE>(0, buf));
+
+    std::vector<Node<TYPE>*> leaves = { tree.root_ };
+
+    for (size_t head = 0; leaves.size() - head < TEST_LEAVES; ++head)
+    {
+        Node<TYPE>* leaf = leaves[head];
+        size_t      made = leaves.size() - head;
+
+        leaves.push_back(tree.splitLeaf(leaf, MakeData<TYPE>(1000 + head, buf), MakeData<TYPE>(made, buf + 32)));
+        leaves.push_back(leaf->left_);
+    }
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Write the version as text, pre-order with depths.
+ *
+ *  @param   tree        Tree
+ *
+ *  @return  text of the version
+ */
+
+template <typename TYPE>
+static std::string Print (const PersistentTree<TYPE>& tree)
+{
+    std::string text;
+    char buf[64] = "";
+
+    tree.Walk([&text, &buf] (const PersistentNode<TYPE>* node, size_t depth)
+    {
+        if constexpr (std::is_same<TYPE, char*>::value)
+            sprintf(buf, "%zu %s\n", depth, node->data_);
+        else
+            sprintf(buf, "%zu %d\n", depth, (int)node->data_);
+
+        text += buf;
+    });
+
+    return text + std::to_string(tree.getSize());
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Make the change on a version of the tree and the same change on
+ *           the linked tree.
+ *
+ *  @param   tree        Version of the tree
+ *  @param   linked      Linked tree
+ *  @param   change      Kind of the change
+ *  @param   leaf        Number of the changed leaf
+ *
+ *  @return  0 if ok, else error of the version
+ */
+
+template <typename TYPE>
+static int Apply (PersistentTree<TYPE>& tree, Tree<TYPE>& linked, Change change, size_t leaf)
+{
+    char buf[64] = "";
+
+    PathStack<size_t> path((char*)"path");
+    PathStack<size_t> linked_path((char*)"linked_path");
+
+    TYPE data = MakeData<TYPE>(leaf, buf);
+    if ((not tree.findPath(path, data)) || (not linked.findPath(linked_path, data))) return TREE_WRONG_PATH;
+
+    Node<TYPE>* node = (Node<TYPE>*)linked_path[linked_path.getSize() - 1];
+
+    switch (change)
+    {
+    case CHANGE_SET_DATA:
+        linked.setData(node, MakeData<TYPE>(2000, buf));
+        return tree.setData(path, MakeData<TYPE>(2000, buf));
+
+    case CHANGE_ADD_CHILD:
+        linked.addRight(node, MakeData<TYPE>(2001, buf));
+        return tree.addRight(path, MakeData<TYPE>(2001, buf));
+
+    case CHANGE_SPLIT_LEAF:
+        linked.splitLeaf(node, MakeData<TYPE>(2002, buf), MakeData<TYPE>(2003, buf + 32), false);
+        return tree.splitLeaf(path, MakeData<TYPE>(2002, buf), MakeData<TYPE>(2003, buf + 32), false);
+
+    case CHANGE_DELETE_NODE:
+        linked.deleteNode(node);
+        return tree.deleteNode(path);
+
+    default:
+        return TREE_OK;
+    }
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Change one of two versions by every kind of change, the changed
+ *           version has to be the same as the changed linked tree, the other
+ *           one has to stay as it was.
+ *
+ *  @return  0 if ok, else 1
+ */
+
+template <typename TYPE>
+static int Isolation ()
+{
+    for (int change = 0; change < CHANGE_COUNT; ++change)
+    for (bool snapshot : { false, true })
+    {
+        Tree<TYPE> linked((char*)"linked");
+        linked.root_ = linked.newNode();
+        BuildTree(linked);
+
+        PersistentTree<TYPE> tree((char*)"tree", linked);
+        PersistentTree<TYPE> copy(tree);
+
+        std::string before = Print(tree);
+
+        PersistentTree<TYPE>& changed = (snapshot) ? copy : tree;
+        PersistentTree<TYPE>& kept    = (snapshot) ? tree : copy;
+
+        if (Apply(changed, linked, (Change)change, TEST_LEAVES / 2))
+        {
+            printf("%s: the change failed\n", CHANGE_NAMES[change]);
+            return 1;
+        }
+
+        PersistentTree<TYPE> expect((char*)"expect", linked);
+
+        if (Print(kept) != before)
+        {
+            printf("%s: the %s sees the change\n", CHANGE_NAMES[change], (snapshot) ? "tree" : "snapshot");
+            return 1;
+        }
+
+        if (Print(changed) != Print(expect))
+        {
+            printf("%s: the changed %s differs from the linked tree\n", CHANGE_NAMES[change], (snapshot) ? "snapshot" : "tree");
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Counters of the roots and their children follow the versions
+ *           holding them.
+ *
+ *  @return  0 if ok, else 1
+ */
+
+static int Counters ()
+{
+    Tree<int> linked((char*)"linked");
+    linked.root_ = linked.newNode();
+    BuildTree(linked);
+
+    PersistentTree<int> tree((char*)"tree", linked);
+
+    const PersistentNode<int>* root   = tree.getRoot();
+    const PersistentNode<int>* shared = nullptr;
+
+    {
+        PersistentTree<int> copy(tree);
+        PersistentTree<int> other((char*)"other");
+        other = copy;
+
+        if (root->refs_.load() != 3)
+        {
+            printf("counters: root held %zu times, expected 3\n", root->refs_.load());
+            return 1;
+        }
+
+        Apply(copy, linked, CHANGE_SET_DATA, TEST_LEAVES - 1);
+
+        shared = (copy.getRoot()->left_ == root->left_) ? root->left_ : root->right_;
+
+        if ((root->refs_.load() != 2) || (shared->refs_.load() != 2))
+        {
+            printf("counters: root held %zu times and its unchanged child %zu times, expected 2 and 2\n",
+                   root->refs_.load(), shared->refs_.load());
+            return 1;
+        }
+    }
+
+    if ((root->refs_.load() != 1) || (shared->refs_.load() != 1))
+    {
+        printf("counters: root held %zu times and its unchanged child %zu times, expected 1 and 1\n",
+               root->refs_.load(), shared->refs_.load());
+        return 1;
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Make many versions by random changes, each made from a random
+ *           older one, and release them by several threads in random order.
+ *           Every node has to be freed once.
+ *
+ *  @return  0 if ok, else 1
+ */
+
+template <typename TYPE>
+static int Release ()
+{
+    Tree<TYPE> linked((char*)"linked");
+    linked.root_ = linked.newNode();
+    BuildTree(linked);
+
+    std::vector<PersistentTree<TYPE>> versions;
+    versions.reserve(TEST_VERSIONS);
+    versions.emplace_back((char*)"tree", linked);
+
+    std::mt19937 rng(0);
+
+    for (size_t i = 1; i < TEST_VERSIONS; ++i)
+    {
+        versions.push_back(versions[rng() % versions.size()]);
+
+        Tree<TYPE> scratch((char*)"scratch");
+        versions.back().toTree(scratch);
+
+        Change change = (Change)(rng() % CHANGE_COUNT);
+        size_t leaf   = rng() % TEST_LEAVES;
+
+        Apply(versions.back(), scratch, change, leaf);
+    }
+
+    std::shuffle(versions.begin(), versions.end(), rng);
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < TEST_THREADS; ++t)
+        threads.emplace_back([&versions, t]
+        {
+            for (size_t i = t; i < versions.size(); i += TEST_THREADS) versions[i].Clean();
+        });
+
+    for (auto& thread : threads) thread.join();
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int main ()
+{
+    if (Isolation<int>() || Isolation<char*>()) return 1;
+
+    printf("snapshot isolation ok\n");
+
+    if (Counters() || Release<int>() || Release<char*>()) return 1;
+
+    printf("snapshot release ok\n");
+
+    return 0;
+}
@@ -0,0 +1,127 @@
+/*------------------------------------------------------------------------------
+    * File:        SplitLeafBench.cpp                                          *
+    * Description: Scaling of splitLeaf with the number of threads, without    *
+                   and with the leaf index, against edits of the tree under    *
+                   one global mutex.                                           *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+#include "../TreeLib/Tree.h"
+#include <stdio.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+const size_t BENCH_FIRST = 4096;
+
+//------------------------------------------------------------------------------
+/*! @brief   Time of the splits by several threads, each thread splits the
+ *           leaves it made.
+ *
+ *  @param   threads     Number of threads
+ *  @param   splits      Number of splits
+ *  @param   index       Build the leaf index
+ *  @param   global      Split by addLeft, addRight and setData under one mutex
+ *
+ *  @return  time in milliseconds
+ */
+
+static double TimeSplits (size_t threads, size_t splits, bool index, bool global)
+{
+    Tree<int> tree((char*)"tree");
+    tree.root_ = tree.newNode();
+    tree.setData(tree.root_, 0);
+
+    std::vector<Node<int>*> first = { tree.root_ };
+
+    size_t head = 0;
+    for (; first.size() - head < BENCH_FIRST; ++head)
+    {
+        Node<int>* leaf = first[head];
+        first.push_back(tree.splitLeaf(leaf, -(int)head - 1, (int)first.size()));
+        first.push_back(leaf->left_);
+    }
+
+    first.erase(first.begin(), first.begin() + head);
+
+    if (index) tree.buildIndex();
+
+    std::mutex lock;
+
+    Clock::time_point start = Clock::now();
+
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t)
+        workers.emplace_back([&tree, &first, &lock, threads, splits, global, t]
+        {
+            std::vector<Node<int>*> own;
+            for (size_t i = t; i < BENCH_FIRST; i += threads) own.push_back(first[i]);
+
+            std::mt19937 rng(t);
+
+            int data = (int)((t + 1) * (splits + BENCH_FIRST) * 2);
+
+            for (size_t i = t; i < splits; i += threads)
+            {
+                size_t k = rng() % own.size();
+
+                Node<int>* leaf = own[k];
+
+                if (global)
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+
+                    own[k] = tree.addRight(leaf, data++);
+                    own.push_back(tree.addLeft(leaf, leaf->getData()));
+                    tree.setData(leaf, data++);
+                }
+                else
+                {
+                    own[k] = tree.splitLeaf(leaf, data, data + 1);
+                    own.push_back(leaf->left_);
+                    data += 2;
+                }
+            }
+        });
+
+    for (auto& worker : workers) worker.join();
+
+    double time = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    if (tree.Check())
+    {
+        printf("check failed with error %d\n", tree.getErrCode());
+        exit(tree.getErrCode());
+    }
+
+    return time;
+}
+
+//------------------------------------------------------------------------------
+
+int main (int argc, char* argv[])
+{
+    size_t splits = (argc > 1) ? (size_t)atol(argv[1]) : 1000000;
+
+    printf("%zu splits, %u hardware threads\n", splits, std::thread::hardware_concurrency());
+
+    for (bool index : { false, true })
+    {
+        double global = TimeSplits(1, splits, index, true);
+        printf("%-8s one mutex          %8.2f ms\n", (index) ? "index" : "no index", global);
+
+        for (size_t threads : { 1, 2, 4, 8 })
+        {
+            double time = TimeSplits(threads, splits, index, false);
+            printf("         splitLeaf %zu threads %8.2f ms  x%.2f\n", threads, time, global / time);
+        }
+    }
+
+    return 0;
+}
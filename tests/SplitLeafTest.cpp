@@ -0,0 +1,304 @@
+/*------------------------------------------------------------------------------
+    * File:        SplitLeafTest.cpp                                           *
+    * Description: Stress test of leaves split by several threads with the    *
+                   leaf index and the journal on and off. Build it with        *
+                   -fsanitize=thread (make tsan) to look for data races.       *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+#include "../TreeLib/Tree.h"
+#include <stdio.h>
+#include <random>
+#include <string>
+#include <vector>
+
+char const * const BASE_NAME = ".bin/SplitLeafTest.dat";
+char const * const OUT1_NAME = ".bin/SplitLeafTest.out1";
+char const * const OUT2_NAME = ".bin/SplitLeafTest.out2";
+
+const size_t TEST_THREADS   = 4;
+const size_t TEST_FIRST     = 256;
+const size_t TEST_CONTESTED = 64;
+const size_t TEST_SPLITS    = 3000;
+
+//------------------------------------------------------------------------------
+/*! @brief   Read the whole file.
+ *
+ *  @param   filename    File name
+ *
+ *  @return  contents of the file
+ */
+
+static std::string ReadFile (const char* filename)
+{
+    std::string text;
+
+    FILE* fp = fopen(filename, "rb");
+    if (fp == nullptr) return text;
+
+    char buf[4096] = {};
+    for (size_t size = 0; (size = fread(buf, 1, sizeof(buf), fp)) > 0;) text.append(buf, size);
+
+    fclose(fp);
+
+    return text;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Make the data of a node.
+ *
+ *  @param   kind        Kind of the node
+ *  @param   thread      Thread that made it
+ *  @param   i           Number of the node in the thread
+ *  @param   buf         Buffer for strings
+ *
+ *  @return  data
+ */
+
+template <typename TYPE>
+static TYPE MakeData (int kind, size_t thread, size_t i, char* buf)
+{
+    if constexpr (std::is_same<TYPE, char*>::value)
+    {
+        sprintf(buf, "%s %zu %zu", (kind == 0) ? "question" : "object", thread, i);
+        return buf;
+    }
+    else return (TYPE)(((thread + 1) * 1000000 + i) * 2 + kind);
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Split the first leaves, then let all threads split the contested
+ *           leaves at once and then the leaves of their own, each thread
+ *           splits the leaves it made.
+ *
+ *  @param   tree        Tree
+ *  @param   start       Leaf to start from
+ *  @param   objects     Data of all leaves of the tree at the end
+ *
+ *  @return  0 if ok, else 1
+ */
+
+template <typename TYPE>
+static int SplitStress (Tree<TYPE>& tree, Node<TYPE>* start, std::vector<TYPE>& objects)
+{
+    char buf[64] = "";
+
+    size_t nodes = 0;
+
+    NodeWalk<TYPE> before(tree.root_);
+    while (before.Next() != nullptr) ++nodes;
+
+    std::vector<Node<TYPE>*> first = { start };
+
+    size_t head = 0;
+    for (; first.size() - head < TEST_FIRST; ++head)
+    {
+        Node<TYPE>* leaf = first[head];
+
+        Node<TYPE>* added = tree.splitLeaf(leaf, MakeData<TYPE>(0, 0, head, buf), MakeData<TYPE>(1, 0, head, buf + 32), head % 2);
+        first.push_back(added);
+        first.push_back((added == leaf->right_) ? leaf->left_ : leaf->right_);
+    }
+
+    first.erase(first.begin(), first.begin() + head);
+
+    std::atomic<size_t> won(0);
+    std::atomic<size_t> lost(0);
+
+    std::vector<std::vector<Node<TYPE>*>> leaves(TEST_THREADS);
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < TEST_THREADS; ++t)
+        threads.emplace_back([&tree, &first, &won, &lost, &leaves, t]
+        {
+            char buf[64] = "";
+            size_t made = 0;
+
+            std::vector<Node<TYPE>*>& own = leaves[t];
+
+            for (size_t i = 0; i < TEST_CONTESTED; ++i)
+            {
+                Node<TYPE>* added = tree.splitLeaf(first[i], MakeData<TYPE>(0, t + 1, made, buf), MakeData<TYPE>(1, t + 1, made, buf + 32));
+                ++made;
+
+                if (added == nullptr) ++lost;
+                else
+                {
+                    ++won;
+                    own.push_back(added);
+                    own.push_back(first[i]->left_);
+                }
+            }
+
+            for (size_t i = TEST_CONTESTED + t; i < TEST_FIRST; i += TEST_THREADS) own.push_back(first[i]);
+
+            std::mt19937 rng(t);
+
+            for (size_t i = 0; i < TEST_SPLITS; ++i)
+            {
+                size_t k = rng() % own.size();
+
+                Node<TYPE>* leaf  = own[k];
+                Node<TYPE>* added = tree.splitLeaf(leaf, MakeData<TYPE>(0, t + 1, made, buf), MakeData<TYPE>(1, t + 1, made, buf + 32), rng() % 2);
+                ++made;
+
+                own[k] = added;
+                own.push_back((added == leaf->right_) ? leaf->left_ : leaf->right_);
+            }
+        });
+
+    for (auto& thread : threads) thread.join();
+
+    if ((won.load() != TEST_CONTESTED) || (lost.load() != TEST_CONTESTED * (TEST_THREADS - 1)))
+    {
+        printf("split: %zu contested splits won and %zu lost\n", won.load(), lost.load());
+        return 1;
+    }
+
+    objects.clear();
+
+    size_t splits = TEST_FIRST - 1 + TEST_CONTESTED + TEST_THREADS * TEST_SPLITS;
+    size_t expect = nodes + 2 * splits;
+
+    nodes = 0;
+
+    NodeWalk<TYPE> walk(tree.root_);
+    for (Node<TYPE>* node = walk.Next(); node != nullptr; node = walk.Next())
+    {
+        ++nodes;
+        if ((node->left_ == nullptr) && (node->right_ == nullptr)) objects.push_back(node->getData());
+    }
+
+    if (nodes != expect)
+    {
+        printf("split: %zu nodes after %zu splits, expected %zu\n", nodes, splits, expect);
+        return 1;
+    }
+
+    if (tree.Check())
+    {
+        printf("split: check failed with error %d\n", tree.getErrCode());
+        return 1;
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Every leaf has to be found.
+ *
+ *  @param   tree        Tree
+ *  @param   objects     Data of all leaves
+ *
+ *  @return  0 if ok, else 1
+ */
+
+template <typename TYPE>
+static int FindAll (Tree<TYPE>& tree, const std::vector<TYPE>& objects)
+{
+    for (const TYPE& object : objects)
+    {
+        PathStack<size_t> path((char*)"path");
+
+        if (not tree.findPath(path, object))
+        {
+            printf("split: a leaf is not found\n");
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Split a tree of strings with the index and the journal, then load
+ *           the base with the journal again, it has to be the same tree.
+ *
+ *  @return  0 if ok, else 1
+ */
+
+static int JournalStress ()
+{
+    {
+        Tree<char*> tree((char*)"tree");
+        tree.root_ = tree.newNode();
+        tree.setData(tree.root_, (char*)"first");
+        tree.splitLeaf(tree.root_, (char*)"question", (char*)"second");
+        tree.Write(BASE_NAME);
+    }
+
+    std::vector<char*> objects;
+
+    Tree<char*> tree((char*)"tree", (char*)BASE_NAME);
+    tree.openJournal(BASE_NAME);
+    tree.buildIndex();
+
+    if (SplitStress(tree, tree.root_->left_, objects) || FindAll(tree, objects)) return 1;
+
+    tree.syncJournal();
+    tree.Write(OUT1_NAME);
+
+    Tree<char*> replayed((char*)"replayed", (char*)BASE_NAME);
+    replayed.Write(OUT2_NAME);
+
+    tree.closeJournal();
+
+    int err = (ReadFile(OUT1_NAME) != ReadFile(OUT2_NAME));
+    if (err) printf("split: the journal replays to another tree\n");
+
+    char* journalname = TreeJournal::makeName(BASE_NAME, JOURNAL_SUFFIX);
+    remove(journalname);
+    free(journalname);
+
+    remove(BASE_NAME);
+    remove(OUT1_NAME);
+    remove(OUT2_NAME);
+
+    return err;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Split a tree of numbers without and with the index.
+ *
+ *  @return  0 if ok, else 1
+ */
+
+static int PlainStress ()
+{
+    for (bool index : { false, true })
+    {
+        std::vector<int> objects;
+
+        Tree<int> tree((char*)"tree");
+        tree.root_ = tree.newNode();
+        tree.setData(tree.root_, -1);
+
+        if (index) tree.buildIndex();
+
+        if (SplitStress(tree, tree.root_, objects)) return 1;
+
+        tree.buildIndex();
+        if (FindAll(tree, objects)) return 1;
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int main ()
+{
+    if (PlainStress()) return 1;
+
+    printf("split ok\n");
+
+    if (JournalStress()) return 1;
+
+    printf("split with index and journal ok\n");
+
+    return 0;
+}
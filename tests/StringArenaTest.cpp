@@ -0,0 +1,188 @@
+/*------------------------------------------------------------------------------
+    * File:        StringArenaTest.cpp                                         *
+    * Description: Tests of trees keeping their strings in the mapping of the  *
+                   base: the tree is saved to the same base it was loaded     *
+                   from, text and binary, by one and several threads.         *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+#include "../TreeLib/Tree.h"
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+char const * const REF_NAME  = ".bin/StringArenaTest.ref";
+char const * const BASE_NAME = ".bin/StringArenaTest.dat";
+char const * const OUT_NAME  = ".bin/StringArenaTest.out";
+
+const size_t TEST_NODES = 30001;
+const size_t LONG_LINE  = 3 * 4096;
+
+//------------------------------------------------------------------------------
+/*! @brief   Read the whole file.
+ *
+ *  @param   filename    File name
+ *
+ *  @return  contents of the file
+ */
+
+static std::string ReadFile (const char* filename)
+{
+    std::string text;
+
+    FILE* fp = fopen(filename, "rb");
+    if (fp == nullptr) return text;
+
+    char buf[4096] = {};
+    for (size_t size = 0; (size = fread(buf, 1, sizeof(buf), fp)) > 0;) text.append(buf, size);
+
+    fclose(fp);
+
+    return text;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Build a tree of numbered strings, every node gives half of its
+ *           descendants to each child, the right child of the root has a line longer than a page.
+ *
+ *  @param   tree        Tree with the root only
+ *  @param   n           Number of nodes, odd
+ */
+
+static void BuildTree (Tree<char*>& tree, size_t n)
+{
+    struct Frame
+    {
+        Node<char*>* node;
+        size_t       n;
+    };
+
+    char name[64] = "";
+
+    std::string long_name(LONG_LINE, 'x');
+
+    tree.setData(tree.root_, (char*)"root");
+
+    std::vector<Frame> frames = { { tree.root_, n } };
+    size_t data = 1;
+
+    while (not frames.empty())
+    {
+        Frame frame = frames.back();
+        frames.pop_back();
+
+        if (frame.n == 1) continue;
+
+        size_t left = (frame.n - 1) / 2;
+        if (left % 2 == 0) --left;
+
+        sprintf(name, "node %zu", data++);
+        Node<char*>* node = tree.addLeft(frame.node, name);
+        frames.push_back({ node, left });
+
+        sprintf(name, "node %zu", data++);
+        node = tree.addRight(frame.node, (frame.node == tree.root_) ? (char*)long_name.c_str() : name);
+        frames.push_back({ node, frame.n - 1 - left });
+    }
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   The tree has to be written the same as the reference.
+ *
+ *  @param   tree        Tree
+ *  @param   ref         Reference text base
+ *  @param   what        Name of the case
+ *
+ *  @return  0 if ok, else 1
+ */
+
+static int Compare (Tree<char*>& tree, const std::string& ref, const char* what)
+{
+    tree.Write(OUT_NAME);
+
+    if (ReadFile(OUT_NAME) != ref)
+    {
+        printf("%s: the tree differs from the reference\n", what);
+        return 1;
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Load the base, save the tree over it, the loaded tree and the
+ *           saved base have to stay the same as the reference.
+ *
+ *  @param   ref         Reference text base
+ *  @param   bin         Save the binary base
+ *  @param   threads     Number of threads to load the base (0 for one thread
+ *                       by the usual constructor)
+ *  @param   what        Name of the case
+ *
+ *  @return  0 if ok, else 1
+ */
+
+static int SaveOver (const std::string& ref, bool bin, size_t threads, const char* what)
+{
+    Tree<char*> tree = (threads == 0) ? Tree<char*>((char*)"tree", (char*)BASE_NAME) :
+                                        Tree<char*>((char*)"tree", (char*)BASE_NAME, threads);
+
+    if (Compare(tree, ref, what)) return 1;
+
+    if (bin) tree.WriteBin(BASE_NAME);
+    else     tree.Write(BASE_NAME);
+
+    if (Compare(tree, ref, what)) return 1;
+
+    Tree<char*> again((char*)"again", (char*)BASE_NAME);
+
+    return Compare(again, ref, what);
+}
+
+//------------------------------------------------------------------------------
+
+int main ()
+{
+    {
+        Tree<char*> tree((char*)"tree");
+        tree.root_ = tree.newNode();
+
+        BuildTree(tree, TEST_NODES);
+        tree.Write(REF_NAME);
+    }
+
+    std::string ref = ReadFile(REF_NAME);
+
+    int err = 0;
+
+    for (size_t threads : { 0, 1, 4 })
+    {
+        Tree<char*> ref_tree((char*)"ref", (char*)REF_NAME);
+
+        ref_tree.Write(BASE_NAME);
+        err |= SaveOver(ref, false, threads, "text over text");
+
+        ref_tree.Write(BASE_NAME);
+        err |= SaveOver(ref, true, threads, "bin over text");
+
+        ref_tree.WriteBin(BASE_NAME);
+        err |= SaveOver(ref, true, threads, "bin over bin");
+
+        ref_tree.WriteBin(BASE_NAME);
+        err |= SaveOver(ref, false, threads, "text over bin");
+    }
+
+    remove(REF_NAME);
+    remove(BASE_NAME);
+    remove(OUT_NAME);
+
+    if (err) return 1;
+
+    printf("save over the loaded base ok\n");
+
+    return 0;
+}
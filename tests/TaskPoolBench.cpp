@@ -0,0 +1,115 @@
+/*------------------------------------------------------------------------------
+    * File:        TaskPoolBench.cpp                                           *
+    * Description: Scaling of the parallel tree check with the number of       *
+                   threads on balanced and unbalanced trees.                   *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+#include "../TreeLib/Tree.h"
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+const int BENCH_RUNS = 3;
+
+//------------------------------------------------------------------------------
+/*! @brief   Build a subtree where every node gives the share of its
+ *           descendants to the left child and the rest to the right one.
+ *
+ *  @param   tree        Tree
+ *  @param   root        Root of the subtree
+ *  @param   n           Number of nodes in the subtree
+ *  @param   skew        Share of the left child
+ */
+
+static void BuildSkewed (Tree<int>& tree, Node<int>* root, size_t n, double skew)
+{
+    struct Frame
+    {
+        Node<int>* node;
+        size_t     n;
+    };
+
+    std::vector<Frame> frames = { { root, n } };
+    int data = 1;
+
+    while (not frames.empty())
+    {
+        Frame frame = frames.back();
+        frames.pop_back();
+
+        size_t rest  = frame.n - 1;
+        size_t left  = (size_t)(rest * skew);
+        size_t right = rest - left;
+
+        if (left  > 0) frames.push_back({ tree.addLeft (frame.node, data++), left  });
+        if (right > 0) frames.push_back({ tree.addRight(frame.node, data++), right });
+    }
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Best time of the check over BENCH_RUNS runs.
+ *
+ *  @param   tree        Tree
+ *  @param   threads     Number of threads
+ *
+ *  @return  time in milliseconds
+ */
+
+static double TimeCheck (Tree<int>& tree, size_t threads)
+{
+    double best = 1e300;
+
+    for (int run = 0; run < BENCH_RUNS; ++run)
+    {
+        Clock::time_point start = Clock::now();
+
+        int err = tree.CheckParallel(threads);
+
+        double time = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        if (time < best) best = time;
+
+        if (err)
+        {
+            printf("check failed with error %d\n", err);
+            exit(err);
+        }
+    }
+
+    return best;
+}
+
+//------------------------------------------------------------------------------
+
+int main (int argc, char* argv[])
+{
+    size_t n = (argc > 1) ? (size_t)atol(argv[1]) : 1000000;
+
+    printf("%zu nodes, %u hardware threads\n", n, std::thread::hardware_concurrency());
+
+    for (double skew : { 0.5, 0.9, 0.99 })
+    {
+        Tree<int> tree((char*)"tree");
+        tree.root_ = tree.newNode();
+        tree.root_->setData(0);
+
+        BuildSkewed(tree, tree.root_, n, skew);
+
+        double one = TimeCheck(tree, 1);
+        printf("left share %.2f: 1 thread   %8.2f ms\n", skew, one);
+
+        for (size_t threads : { 2, 4, 8 })
+        {
+            double time = TimeCheck(tree, threads);
+            printf("                 %zu threads  %8.2f ms  x%.2f\n", threads, time, one / time);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,228 @@
+/*------------------------------------------------------------------------------
+    * File:        TaskPoolTest.cpp                                            *
+    * Description: Stress test of the work-stealing deque, the task pool and   *
+                   the parallel tree check. Build it with -fsanitize=thread    *
+                   (make tsan) to look for data races.                         *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+#include "../TreeLib/Tree.h"
+#include <stdio.h>
+#include <random>
+#include <vector>
+
+//------------------------------------------------------------------------------
+/*! @brief   The owner pushes and pops values while thieves steal them, every
+ *           value has to be taken exactly once.
+ *
+ *  @param   thieves     Number of stealing threads
+ *  @param   n           Number of values
+ *  @param   seed        Seed of the owner's push and pop pattern
+ *
+ *  @return  0 if ok, else 1
+ */
+
+static int DequeStress (int thieves, size_t n, int seed)
+{
+    WorkDeque<size_t> deque(2);
+
+    std::vector<std::atomic<int>> seen(n);
+    for (auto& count : seen) count.store(0);
+
+    std::atomic<bool> done(false);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < thieves; ++i)
+        threads.emplace_back([&deque, &seen, &done]
+        {
+            size_t value = 0;
+
+            while (not done.load())
+                if (deque.Steal(value)) seen[value].fetch_add(1);
+
+            while (deque.Steal(value)) seen[value].fetch_add(1);
+        });
+
+    std::mt19937 rng(seed);
+
+    size_t next  = 0;
+    size_t value = 0;
+
+    while (next < n)
+    {
+        for (size_t i = rng() % 64; (i > 0) && (next < n); --i) deque.Push(next++);
+
+        for (size_t i = rng() % 48; i > 0; --i)
+            if (deque.Pop(value)) seen[value].fetch_add(1);
+    }
+
+    while (deque.Pop(value)) seen[value].fetch_add(1);
+
+    done.store(true);
+    for (auto& thread : threads) thread.join();
+
+    for (size_t i = 0; i < n; ++i)
+        if (seen[i].load() != 1)
+        {
+            printf("deque: value %zu taken %d times\n", i, seen[i].load());
+            return 1;
+        }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Count the leaves of an unbalanced recursion spawned through the
+ *           pool, the pool is reused for several runs.
+ *
+ *  @param   threads     Number of threads
+ *  @param   runs        Number of runs
+ *
+ *  @return  0 if ok, else 1
+ */
+
+static int PoolStress (size_t threads, int runs)
+{
+    TaskPool<uint64_t> pool(threads);
+
+    for (int run = 0; run < runs; ++run)
+    {
+        std::atomic<uint64_t> leaves(0);
+        uint64_t depth = 8 + run % 10;
+
+        pool.Run(depth, [&pool, &leaves](uint64_t task, size_t thread)
+        {
+            if (task == 0)
+            {
+                leaves.fetch_add(1);
+                return;
+            }
+
+            pool.Spawn(thread, task - 1);
+            pool.Spawn(thread, task - 1);
+
+            if (task % 3 == 0) pool.Spawn(thread, 0);
+        });
+
+        uint64_t expect = 1;
+        for (uint64_t d = 1; d <= depth; ++d) expect = 2 * expect + (d % 3 == 0);
+
+        if (leaves.load() != expect)
+        {
+            printf("pool: %llu leaves, expected %llu\n", (unsigned long long)leaves.load(), (unsigned long long)expect);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Build a subtree where every node gives the share of its
+ *           descendants to the left child and the rest to the right one.
+ *
+ *  @param   tree        Tree
+ *  @param   root        Root of the subtree
+ *  @param   n           Number of nodes in the subtree
+ *  @param   skew        Share of the left child
+ */
+
+static void BuildSkewed (Tree<int>& tree, Node<int>* root, size_t n, double skew)
+{
+    struct Frame
+    {
+        Node<int>* node;
+        size_t     n;
+    };
+
+    std::vector<Frame> frames = { { root, n } };
+    int data = 1;
+
+    while (not frames.empty())
+    {
+        Frame frame = frames.back();
+        frames.pop_back();
+
+        size_t rest  = frame.n - 1;
+        size_t left  = (size_t)(rest * skew);
+        size_t right = rest - left;
+
+        if (left  > 0) frames.push_back({ tree.addLeft (frame.node, data++), left  });
+        if (right > 0) frames.push_back({ tree.addRight(frame.node, data++), right });
+    }
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Check unbalanced trees in parallel, then break the depth of a
+ *           deep node, the check has to find it every time.
+ *
+ *  @param   n           Number of nodes
+ *
+ *  @return  0 if ok, else 1
+ */
+
+static int CheckStress (size_t n)
+{
+    for (double skew : { 0.5, 0.9, 0.99 })
+    {
+        Tree<int> tree((char*)"tree");
+        tree.root_ = tree.newNode();
+        tree.root_->setData(0);
+
+        BuildSkewed(tree, tree.root_, n, skew);
+
+        for (size_t i = 0; i < 10; ++i)
+        {
+            int err = tree.CheckParallel(2 + i % 4);
+            if (err)
+            {
+                printf("check: error %d on a valid tree, skew %.2f\n", err, skew);
+                return 1;
+            }
+        }
+
+        Node<int>* node = tree.root_;
+        for (size_t i = 0; (i < 30) && (node->left_ != nullptr); ++i) node = node->left_;
+
+        node->depth_ += 1;
+
+        for (size_t i = 0; i < 5; ++i)
+            if (tree.CheckParallel(4) != TREE_WRONG_DEPTH)
+            {
+                printf("check: broken depth is missed, skew %.2f\n", skew);
+                return 1;
+            }
+
+        node->depth_ -= 1;
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int main ()
+{
+    for (int seed = 0; seed < 6; ++seed)
+        if (DequeStress(1 + seed % 3, 200000, seed)) return 1;
+
+    printf("deque ok\n");
+
+    if (PoolStress(1, 20) || PoolStress(2, 50) || PoolStress(4, 50) || PoolStress(8, 20)) return 1;
+
+    {
+        TaskPool<int> pool(4);
+    }
+
+    printf("pool ok\n");
+
+    if (CheckStress(200000)) return 1;
+
+    printf("check ok\n");
+
+    return 0;
+}
@@ -0,0 +1,264 @@
+/*------------------------------------------------------------------------------
+    * File:        TreeBinTest.cpp                                             *
+    * Description: Tests of the binary base: a tree written to it is loaded   *
+                   back the same, and a base with any byte flipped is not      *
+                   loaded.                                                     *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+#include "../TreeLib/Tree.h"
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+char const * const BASE_NAME = ".bin/TreeBinTest.dat";
+char const * const BIN_NAME  = ".bin/TreeBinTest.bin";
+char const * const OUT_NAME  = ".bin/TreeBinTest.out";
+
+const size_t TEST_LEAVES = 1000;
+const size_t FLIP_LEAVES = 16;
+
+//------------------------------------------------------------------------------
+/*! @brief   Read the whole file.
+ *
+ *  @param   filename    File name
+ *
+ *  @return  contents of the file
+ */
+
+static std::string ReadFile (const char* filename)
+{
+    std::string text;
+
+    FILE* fp = fopen(filename, "rb");
+    if (fp == nullptr) return text;
+
+    char buf[4096] = {};
+    for (size_t size = 0; (size = fread(buf, 1, sizeof(buf), fp)) > 0;) text.append(buf, size);
+
+    fclose(fp);
+
+    return text;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Write the whole file.
+ *
+ *  @param   filename    File name
+ *  @param   text        Contents of the file
+ */
+
+static void WriteFile (const char* filename, const std::string& text)
+{
+    FILE* fp = fopen(filename, "wb");
+    if (fp == nullptr) return;
+
+    fwrite(text.data(), 1, text.size(), fp);
+    fclose(fp);
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Make the data of a node.
+ *
+ *  @param   i           Number of the node
+ *  @param   buf         Buffer for strings
+ *
+ *  @return  data
+ */
+
+template <typename TYPE>
+static TYPE MakeData (size_t i, char* buf)
+{
+    if constexpr (std::is_same<TYPE, char*>::value)
+    {
+        sprintf(buf, "node %zu", i);
+        return buf;
+    }
+    else return (TYPE)i;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Build a tree of the number of leaves numbered from 0, splitting
+ *           the leaves to both sides so the tree is not balanced.
+ *
+ *  @param   tree        Tree with the root only
+ *  @param   count       Number of leaves
+ */
+
+template <typename TYPE>
+static void BuildTree (Tree<TYPE>& tree, size_t count)
+{
+    char buf[64] = "";
+
+    tree.setData(tree.root_, MakeData<TYPE>(0, buf));
+
+    std::vector<Node<TYPE>*> nodes = { tree.root_ };
+
+    for (size_t i = 1; i < count; ++i)
+    {
+        size_t k = (i * 7919) % nodes.size();
+
+        Node<TYPE>* leaf  = nodes[k];
+        Node<TYPE>* added = tree.splitLeaf(leaf, MakeData<TYPE>(count + i, buf), MakeData<TYPE>(i, buf + 32), i % 2);
+
+        nodes[k] = (added == leaf->right_) ? leaf->left_ : leaf->right_;
+        nodes.push_back(added);
+    }
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   A tree written to the binary base has to be loaded back the same
+ *           and written to the same binary base again, a text base has to be
+ *           converted to the binary base and back without changes.
+ *
+ *  @return  0 if ok, else 1
+ */
+
+template <typename TYPE>
+static int RoundTrip ()
+{
+    Tree<TYPE> tree((char*)"tree");
+    tree.root_ = tree.newNode();
+    BuildTree(tree, TEST_LEAVES);
+
+    tree.Write(BASE_NAME);
+    std::string text = ReadFile(BASE_NAME);
+
+    tree.WriteBin(BIN_NAME);
+    std::string bin = ReadFile(BIN_NAME);
+
+    {
+        Tree<TYPE> loaded((char*)"loaded", (char*)BIN_NAME);
+
+        if (loaded.Check())
+        {
+            printf("round trip: check of the loaded tree failed with error %d\n", loaded.getErrCode());
+            return 1;
+        }
+
+        loaded.Write(OUT_NAME);
+        if (ReadFile(OUT_NAME) != text)
+        {
+            printf("round trip: the tree loaded from the binary base differs\n");
+            return 1;
+        }
+
+        loaded.WriteBin(OUT_NAME);
+        if (ReadFile(OUT_NAME) != bin)
+        {
+            printf("round trip: the loaded tree is written to another binary base\n");
+            return 1;
+        }
+    }
+
+    BaseToBin<TYPE>(BASE_NAME, OUT_NAME);
+    if (ReadFile(OUT_NAME) != bin)
+    {
+        printf("round trip: the text base is converted to another binary base\n");
+        return 1;
+    }
+
+    BinToBase<TYPE>(BIN_NAME, OUT_NAME);
+    if (ReadFile(OUT_NAME) != text)
+    {
+        printf("round trip: the binary base is converted to another text base\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Load the base in a child process, a wrong base makes the tree
+ *           exit with an error code.
+ *
+ *  @return  exit code of the child, -1 if it was killed
+ */
+
+template <typename TYPE>
+static int LoadChild ()
+{
+    pid_t pid = fork();
+
+    if (pid == 0)
+    {
+        fclose(stdout);
+        fclose(stderr);
+
+        Tree<TYPE> tree((char*)"loaded", (char*)BIN_NAME);
+        _exit(0);
+    }
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+
+    return (WIFEXITED(status)) ? WEXITSTATUS(status) : -1;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   A binary base with a flipped bit in any of its bytes has to be
+ *           refused with an error, not loaded as another tree.
+ *
+ *  @return  0 if ok, else 1
+ */
+
+template <typename TYPE>
+static int FlippedByte ()
+{
+    Tree<TYPE> tree((char*)"tree");
+    tree.root_ = tree.newNode();
+    BuildTree(tree, FLIP_LEAVES);
+
+    tree.WriteBin(BIN_NAME);
+    std::string bin = ReadFile(BIN_NAME);
+
+    if (LoadChild<TYPE>() != 0)
+    {
+        printf("flipped byte: the whole binary base is not loaded\n");
+        return 1;
+    }
+
+    for (size_t pos = 0; pos < bin.size(); ++pos)
+    for (unsigned char mask : { 0x01, 0x80 })
+    {
+        std::string damaged = bin;
+        damaged[pos] ^= mask;
+
+        WriteFile(BIN_NAME, damaged);
+
+        int code = LoadChild<TYPE>();
+        if (code <= 0)
+        {
+            printf("flipped byte: a base with byte %zu of %zu flipped by 0x%02x is %s\n",
+                   pos, bin.size(), mask, (code == 0) ? "loaded" : "crashing the load");
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int main ()
+{
+    int err = RoundTrip<int>() || RoundTrip<double>() || RoundTrip<char*>() ||
+              FlippedByte<int>() || FlippedByte<char*>();
+
+    remove(BASE_NAME);
+    remove(BIN_NAME);
+    remove(OUT_NAME);
+    remove(TREE_LOGNAME);
+
+    if (err) return 1;
+
+    printf("binary base ok\n");
+
+    return 0;
+}
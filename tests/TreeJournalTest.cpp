@@ -0,0 +1,416 @@
+/*------------------------------------------------------------------------------
+    * File:        TreeJournalTest.cpp                                         *
+    * Description: Tests of the journal of changes: replay of the journal, a   *
+                   journal with a torn or damaged tail, a journal of an older  *
+                   base and compaction of the journal into the base.           *
+    * Created:     18 apr 2021                                                 *
+    * Author:      Artem Puzankov                                              *
+    * Email:       puzankov.ao@phystech.edu                                    *
+    * GitHub:      https://github.com/hellopuza                                *
+    * Copyright © 2021 Artem Puzankov. All rights reserved.                    *
+    *///------------------------------------------------------------------------
+
+#include "../TreeLib/Tree.h"
+#include <stdio.h>
+#include <random>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+
+char const * const BASE_NAME = ".bin/TreeJournalTest.dat";
+char const * const OUT_NAME  = ".bin/TreeJournalTest.out";
+
+const size_t TEST_CHANGES = 300;
+
+//------------------------------------------------------------------------------
+/*! @brief   Read the whole file.
+ *
+ *  @param   filename    File name
+ *
+ *  @return  contents of the file
+ */
+
+static std::string ReadFile (const char* filename)
+{
+    std::string text;
+
+    FILE* fp = fopen(filename, "rb");
+    if (fp == nullptr) return text;
+
+    char buf[4096] = {};
+    for (size_t size = 0; (size = fread(buf, 1, sizeof(buf), fp)) > 0;) text.append(buf, size);
+
+    fclose(fp);
+
+    return text;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Write the whole file.
+ *
+ *  @param   filename    File name
+ *  @param   text        Contents of the file
+ */
+
+static void WriteFile (const char* filename, const std::string& text)
+{
+    FILE* fp = fopen(filename, "wb");
+    if (fp == nullptr) return;
+
+    fwrite(text.data(), 1, text.size(), fp);
+    fclose(fp);
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Get text of the tree as it is written to a base.
+ *
+ *  @param   tree        Tree
+ *
+ *  @return  text base
+ */
+
+static std::string Print (Tree<char*>& tree)
+{
+    tree.Write(OUT_NAME);
+
+    return ReadFile(OUT_NAME);
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Get text of the tree loaded from the base with its journal.
+ *
+ *  @return  text base
+ */
+
+static std::string Load ()
+{
+    Tree<char*> tree((char*)"loaded", (char*)BASE_NAME);
+
+    return Print(tree);
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Make random changes of all kinds on the leaves of the tree, every
+ *           node keeps two children or none, as the base needs.
+ *
+ *  @param   tree        Tree
+ *  @param   rng         Random numbers
+ *  @param   count       Number of changes
+ */
+
+static void Change (Tree<char*>& tree, std::mt19937& rng, size_t count)
+{
+    static size_t made = 0;
+
+    char buf[64]      = "";
+    char other[64]    = "";
+    char question[64] = "";
+
+    for (size_t i = 0; i < count; ++i, ++made)
+    {
+        std::vector<Node<char*>*> leaves;
+
+        NodeWalk<char*> walk(tree.root_);
+        for (Node<char*>* node = walk.Next(); node != nullptr; node = walk.Next())
+            if ((node->left_ == nullptr) && (node->right_ == nullptr)) leaves.push_back(node);
+
+        Node<char*>* leaf = leaves[rng() % leaves.size()];
+
+        sprintf(buf,      "leaf %zu",       made);
+        sprintf(other,    "other leaf %zu", made);
+        sprintf(question, "question %zu",   made);
+
+        switch (rng() % 4)
+        {
+        case 0:
+        {
+            Node<char*>* node = (leaf->prev_ != tree.root_) ? leaf->prev_ : leaf;
+            if (node == tree.root_) break;
+
+            Node<char*>* parent = node->prev_;
+            bool         right  = (parent->right_ == node);
+
+            tree.deleteNode(node);
+
+            if (right) tree.addRight(parent, buf);
+            else       tree.addLeft (parent, buf);
+            break;
+        }
+
+        case 1:
+            tree.setData(leaf, buf);
+            break;
+
+        case 2:
+            tree.setData(leaf, question);
+            tree.addRight(leaf, buf);
+            tree.addLeft (leaf, other);
+            break;
+
+        default:
+            tree.splitLeaf(leaf, question, buf, rng() % 2);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Get size of the file.
+ *
+ *  @param   filename    File name
+ *
+ *  @return  size of the file
+ */
+
+static size_t FileSize (const char* filename)
+{
+    struct stat info = {};
+    stat(filename, &info);
+
+    return (size_t)info.st_size;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Make a base with a journal of changes, the last change is a split
+ *           synced apart from the others.
+ *
+ *  @param   rng         Random numbers
+ *  @param   journal     Journal file name
+ *  @param   before      Text of the tree before the last change
+ *  @param   after       Text of the tree after all changes
+ *  @param   last        Offset of the last record in the journal
+ */
+
+static void MakeJournal (std::mt19937& rng, const char* journal, std::string& before, std::string& after, size_t& last)
+{
+    {
+        Tree<char*> tree((char*)"tree");
+        tree.root_ = tree.newNode();
+        tree.setData(tree.root_, (char*)"first");
+        tree.splitLeaf(tree.root_, (char*)"question", (char*)"second");
+        tree.Write(BASE_NAME);
+    }
+
+    remove(journal);
+
+    Tree<char*> tree((char*)"tree", (char*)BASE_NAME);
+    tree.openJournal(BASE_NAME);
+
+    Change(tree, rng, TEST_CHANGES);
+    tree.syncJournal();
+
+    before = Print(tree);
+    last   = FileSize(journal);
+
+    NodeWalk<char*> walk(tree.root_);
+
+    Node<char*>* leaf = walk.Next();
+    while ((leaf->left_ != nullptr) || (leaf->right_ != nullptr)) leaf = walk.Next();
+
+    tree.splitLeaf(leaf, (char*)"last question", (char*)"last leaf");
+    tree.syncJournal();
+
+    after = Print(tree);
+
+    tree.closeJournal();
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   The journal has to be replayed to the same tree.
+ *
+ *  @return  0 if ok, else 1
+ */
+
+static int Replay (const char* journal)
+{
+    std::mt19937 rng(1);
+
+    std::string before;
+    std::string after;
+    size_t      last = 0;
+
+    MakeJournal(rng, journal, before, after, last);
+
+    if (Load() != after)
+    {
+        printf("replay: the journal replays to another tree\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   A journal cut inside the last record or with a damaged byte in it
+ *           has to be replayed up to the record, and a journal opened again
+ *           has to continue after the valid records.
+ *
+ *  @return  0 if ok, else 1
+ */
+
+static int TornTail (const char* journal)
+{
+    std::mt19937 rng(2);
+
+    std::string before;
+    std::string after;
+    size_t      last = 0;
+
+    MakeJournal(rng, journal, before, after, last);
+
+    std::string full = ReadFile(journal);
+
+    for (size_t size = last; size < full.size(); ++size)
+    {
+        WriteFile(journal, full.substr(0, size));
+
+        if (Load() != before)
+        {
+            printf("torn tail: a journal cut to %zu of %zu bytes replays wrong\n", size, full.size());
+            return 1;
+        }
+    }
+
+    for (size_t pos = last; pos < full.size(); ++pos)
+    {
+        std::string damaged = full;
+        damaged[pos] ^= 0x5A;
+
+        WriteFile(journal, damaged);
+
+        if (Load() != before)
+        {
+            printf("torn tail: a journal damaged at byte %zu of %zu replays wrong\n", pos, full.size());
+            return 1;
+        }
+    }
+
+    WriteFile(journal, full.substr(0, (last + full.size()) / 2));
+
+    std::string expect;
+    {
+        Tree<char*> tree((char*)"tree", (char*)BASE_NAME);
+        tree.openJournal(BASE_NAME);
+
+        Change(tree, rng, 10);
+        expect = Print(tree);
+
+        tree.closeJournal();
+    }
+
+    if (Load() != expect)
+    {
+        printf("torn tail: the changes after the torn tail are lost\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   A journal left from an older base has to be ignored.
+ *
+ *  @return  0 if ok, else 1
+ */
+
+static int Stale (const char* journal)
+{
+    std::mt19937 rng(3);
+
+    std::string before;
+    std::string after;
+    size_t      last = 0;
+
+    MakeJournal(rng, journal, before, after, last);
+
+    std::string stale = ReadFile(journal);
+
+    std::string expect;
+    {
+        Tree<char*> tree((char*)"tree", (char*)BASE_NAME);
+        Change(tree, rng, 10);
+
+        tree.Write(BASE_NAME);
+        expect = Print(tree);
+    }
+
+    WriteFile(journal, stale);
+
+    if (Load() != expect)
+    {
+        printf("stale: the journal of an older base is replayed\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+/*! @brief   Compaction has to fold the journal into the base and leave an
+ *           empty journal that continues the new base.
+ *
+ *  @return  0 if ok, else 1
+ */
+
+static int Compaction (const char* journal)
+{
+    std::mt19937 rng(4);
+
+    remove(journal);
+
+    Tree<char*> tree((char*)"tree", (char*)BASE_NAME);
+    tree.openJournal(BASE_NAME);
+
+    Change(tree, rng, TEST_CHANGES);
+    tree.compactJournal();
+
+    std::string expect = Print(tree);
+
+    if (FileSize(journal) != sizeof(TreeJournalHeader))
+    {
+        printf("compaction: the journal has %zu bytes after compaction\n", FileSize(journal));
+        return 1;
+    }
+
+    if ((Load() != expect) || (ReadFile(BASE_NAME) != expect))
+    {
+        printf("compaction: the base differs from the tree\n");
+        return 1;
+    }
+
+    Change(tree, rng, TEST_CHANGES);
+    tree.syncJournal();
+
+    expect = Print(tree);
+
+    if (Load() != expect)
+    {
+        printf("compaction: the journal after compaction replays wrong\n");
+        return 1;
+    }
+
+    tree.closeJournal();
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+int main ()
+{
+    char* journal = TreeJournal::makeName(BASE_NAME, JOURNAL_SUFFIX);
+
+    int err = Replay(journal) || TornTail(journal) || Stale(journal) || Compaction(journal);
+
+    remove(journal);
+    free(journal);
+
+    remove(BASE_NAME);
+    remove(OUT_NAME);
+
+    if (err) return 1;
+
+    printf("journal ok\n");
+
+    return 0;
+}